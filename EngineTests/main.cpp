@@ -0,0 +1,876 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../ForgeEngine/DrawList.h"
+#include "../ForgeEngine/FakeGPUTimestampSource.h"
+#include "../ForgeEngine/FakeTextureBackend.h"
+#include "../ForgeEngine/GPUTimestampRing.h"
+#include "../ForgeEngine/JobSystem.h"
+#include "../ForgeEngine/OcclusionCulling.h"
+#include "../ForgeEngine/ObjectConstants.h"
+#include "../ForgeEngine/RecordingRenderStateSink.h"
+#include "../ForgeEngine/StreamingStatistics.h"
+#include "../ForgeEngine/TextureCache.h"
+#include "../ForgeEngine/VertexPacking.h"
+
+static int s_checksAmount = 0;
+static int s_failuresAmount = 0;
+
+static bool Check(const bool& condition, const char* const& expression, const char* const& file, const int& line)
+{
+    ++s_checksAmount;
+
+    if (!condition)
+    {
+        ++s_failuresAmount;
+        fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+    }
+
+    return condition;
+}
+
+#define CHECK(condition) Check((condition), #condition, __FILE__, __LINE__)
+
+//Device objects are never dereferenced, so small integers stand in for them
+static RenderResourceHandle GetHandle(const uintptr_t& id)
+{
+    return (RenderResourceHandle)id;
+}
+
+static const char* GetCommandName(const RenderCommandType& type)
+{
+    switch (type)
+    {
+    case RenderCommandType::VertexShader: return "VertexShader";
+    case RenderCommandType::PixelShader: return "PixelShader";
+    case RenderCommandType::InputLayout: return "InputLayout";
+    case RenderCommandType::Texture: return "Texture";
+    case RenderCommandType::MaterialBuffer: return "MaterialBuffer";
+    case RenderCommandType::VertexBuffer: return "VertexBuffer";
+    case RenderCommandType::IndexBuffer: return "IndexBuffer";
+    case RenderCommandType::Instances: return "Instances";
+    case RenderCommandType::DrawIndexed: return "DrawIndexed";
+    case RenderCommandType::DrawIndexedInstanced: return "DrawIndexedInstanced";
+    }
+
+    return "Unknown";
+}
+
+static void PrintCommands(const std::vector<RecordedRenderCommand>& commands)
+{
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        fprintf(stderr, "    %zu: %s %zu %u %u\n", i, GetCommandName(commands[i].Type), (size_t)(uintptr_t)commands[i].Handle,
+            commands[i].Value, commands[i].InstancesAmount);
+    }
+}
+
+//Compares the whole sequence and prints both of them on a mismatch
+static void CheckRecorded(const RecordingRenderStateSink& sink, const std::vector<RecordedRenderCommand>& expected, const char* const& name)
+{
+    const std::vector<RecordedRenderCommand>& recorded = sink.GetCommands();
+    bool equal = recorded.size() == expected.size();
+
+    for (size_t i = 0; equal && i < recorded.size(); ++i)
+    {
+        equal = recorded[i].Type == expected[i].Type && recorded[i].Handle == expected[i].Handle
+            && recorded[i].Value == expected[i].Value && recorded[i].InstancesAmount == expected[i].InstancesAmount;
+    }
+
+    if (!Check(equal, name, __FILE__, __LINE__))
+    {
+        fprintf(stderr, "  Expected:\n");
+        PrintCommands(expected);
+        fprintf(stderr, "  Recorded:\n");
+        PrintCommands(recorded);
+    }
+}
+
+static DrawCommand CreateDrawCommand(const uintptr_t& vertexShader, const uintptr_t& pixelShader, const uintptr_t& layout, const uintptr_t& texture,
+    const uintptr_t& material, const uintptr_t& geometry, const uint32_t& objectIndex)
+{
+    //Geometry n has vertex buffer 100 + n and index buffer 200 + n
+    DrawCommand command;
+    command.VertexShader = GetHandle(vertexShader);
+    command.PixelShader = GetHandle(pixelShader);
+    command.InputLayout = GetHandle(layout);
+    command.Texture = GetHandle(texture);
+    command.MaterialBuffer = GetHandle(material);
+    command.VertexBuffer = GetHandle(100 + geometry);
+    command.Stride = 20;
+    command.IndexBuffer = GetHandle(200 + geometry);
+    command.IndexSize = 2;
+    command.IndicesAmount = 36;
+    command.ObjectIndex = objectIndex;
+
+    return command;
+}
+
+struct ExpectedCommands
+{
+    std::vector<RecordedRenderCommand> Commands;
+
+    void Add(const RenderCommandType& type, const uintptr_t& handle, const uint32_t& value = 0, const uint32_t& instancesAmount = 0)
+    {
+        Commands.push_back({ type, GetHandle(handle), value, instancesAmount });
+    }
+
+    void AddDraw(const uint32_t& firstInstance, const uint32_t& instancesAmount, const uint32_t& indicesAmount = 36)
+    {
+        Add(RenderCommandType::Instances, 0, firstInstance, instancesAmount);
+
+        if (instancesAmount > 1)
+            Add(RenderCommandType::DrawIndexedInstanced, 0, indicesAmount, instancesAmount);
+        else
+            Add(RenderCommandType::DrawIndexed, 0, indicesAmount, 1);
+    }
+};
+
+//Every command differs from the first one by a single key part, so the sorted order shows which part is the most significant
+static void TestDrawListSorting()
+{
+    DrawList drawList;
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 0));
+    drawList.Add(CreateDrawCommand(2, 1, 1, 1, 1, 1, 1));
+    drawList.Add(CreateDrawCommand(1, 2, 1, 1, 1, 1, 2));
+    drawList.Add(CreateDrawCommand(1, 1, 2, 1, 1, 1, 3));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 2, 1, 1, 4));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 2, 1, 5));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 2, 6));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 7));
+
+    drawList.Sort();
+
+    //Vertex shader, pixel shader, layout, texture, material and geometry from the most significant, equal keys keep their order
+    const uint32_t expectedObjects[] = { 0, 7, 6, 5, 4, 3, 2, 1 };
+    CHECK(drawList.GetSize() == 8);
+
+    for (size_t i = 0; i < drawList.GetSize() && i < 8; ++i)
+        CHECK(drawList.GetCommand(i).ObjectIndex == expectedObjects[i]);
+
+    //IDs are kept after clearing, so the same commands added in another order sort the same way
+    drawList.Clear();
+
+    for (int object = 7; object >= 0; --object)
+        drawList.Add(CreateDrawCommand(object == 1 ? 2 : 1, object == 2 ? 2 : 1, object == 3 ? 2 : 1, object == 4 ? 2 : 1, object == 5 ? 2 : 1, object == 6 ? 2 : 1, object));
+
+    drawList.Sort();
+    CHECK(drawList.GetSize() == 8);
+
+    //Objects 0 and 7 have equal keys and were added in reverse this time
+    const uint32_t expectedReversed[] = { 7, 0, 6, 5, 4, 3, 2, 1 };
+
+    for (size_t i = 0; i < drawList.GetSize() && i < 8; ++i)
+        CHECK(drawList.GetCommand(i).ObjectIndex == expectedReversed[i]);
+}
+
+static void TestDrawListRedundantState()
+{
+    DrawList drawList;
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 0));
+    drawList.Add(CreateDrawCommand(2, 1, 1, 1, 1, 1, 1));
+    drawList.Add(CreateDrawCommand(1, 2, 1, 1, 1, 1, 2));
+    drawList.Add(CreateDrawCommand(1, 1, 2, 1, 1, 1, 3));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 2, 1, 1, 4));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 2, 1, 5));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 2, 6));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 7));
+
+    drawList.Sort();
+    drawList.BuildBatches(1);
+
+    RecordingRenderStateSink sink;
+    drawList.Submit(&sink);
+
+    ExpectedCommands expected;
+
+    //The first draw binds everything, the next ones only what differs from the previous draw
+    expected.Add(RenderCommandType::VertexShader, 1);
+    expected.Add(RenderCommandType::PixelShader, 1);
+    expected.Add(RenderCommandType::InputLayout, 1);
+    expected.Add(RenderCommandType::Texture, 1);
+    expected.Add(RenderCommandType::MaterialBuffer, 1);
+    expected.Add(RenderCommandType::VertexBuffer, 101, 20);
+    expected.Add(RenderCommandType::IndexBuffer, 201, 2);
+    expected.AddDraw(0, 1);
+
+    //Object 7, the same state
+    expected.AddDraw(1, 1);
+
+    //Object 6
+    expected.Add(RenderCommandType::VertexBuffer, 102, 20);
+    expected.Add(RenderCommandType::IndexBuffer, 202, 2);
+    expected.AddDraw(2, 1);
+
+    //Object 5
+    expected.Add(RenderCommandType::MaterialBuffer, 2);
+    expected.Add(RenderCommandType::VertexBuffer, 101, 20);
+    expected.Add(RenderCommandType::IndexBuffer, 201, 2);
+    expected.AddDraw(3, 1);
+
+    //Object 4
+    expected.Add(RenderCommandType::Texture, 2);
+    expected.Add(RenderCommandType::MaterialBuffer, 1);
+    expected.AddDraw(4, 1);
+
+    //Object 3
+    expected.Add(RenderCommandType::InputLayout, 2);
+    expected.Add(RenderCommandType::Texture, 1);
+    expected.AddDraw(5, 1);
+
+    //Object 2
+    expected.Add(RenderCommandType::PixelShader, 2);
+    expected.Add(RenderCommandType::InputLayout, 1);
+    expected.AddDraw(6, 1);
+
+    //Object 1
+    expected.Add(RenderCommandType::VertexShader, 2);
+    expected.Add(RenderCommandType::PixelShader, 1);
+    expected.AddDraw(7, 1);
+
+    CheckRecorded(sink, expected.Commands, "redundant bindings are skipped");
+
+    //7 bindings are compared for every draw
+    const DrawListCounters& counters = drawList.GetCounters();
+    CHECK(counters.Draws == 8);
+    CHECK(counters.InstancedDraws == 0);
+    CHECK(counters.Instances == 8);
+    CHECK(counters.StateChanges == 20);
+    CHECK(counters.SkippedStateChanges == 36);
+    CHECK(counters.InstanceBindings == 8);
+
+    //Draws without a texture keep the bound one
+    drawList.Clear();
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 0));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 0, 1, 2, 1));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 3, 2));
+
+    drawList.Sort();
+    drawList.BuildBatches(1);
+    sink.Clear();
+    drawList.Submit(&sink);
+
+    CHECK(sink.GetCommandsAmount(RenderCommandType::Texture) == 1);
+    CHECK(sink.GetCommandsAmount(RenderCommandType::DrawIndexed) == 3);
+}
+
+static void TestDrawListInstancing()
+{
+    //Objects 0 to 4 differ only by the object, 5 uses another material and 6 another LOD of the same geometry
+    DrawList drawList;
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 0));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 2, 1, 5));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 1));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 2));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 3));
+    drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, 4));
+
+    DrawCommand lod = CreateDrawCommand(1, 1, 1, 1, 1, 1, 6);
+    lod.IndexBuffer = GetHandle(301);
+    lod.IndicesAmount = 12;
+    drawList.Add(lod);
+
+    drawList.Sort();
+    drawList.BuildBatches(OBJECT_CONSTANTS_MAX_INSTANCES);
+
+    RecordingRenderStateSink sink;
+    drawList.Submit(&sink);
+
+    ExpectedCommands expected;
+    expected.Add(RenderCommandType::VertexShader, 1);
+    expected.Add(RenderCommandType::PixelShader, 1);
+    expected.Add(RenderCommandType::InputLayout, 1);
+    expected.Add(RenderCommandType::Texture, 1);
+    expected.Add(RenderCommandType::MaterialBuffer, 1);
+    expected.Add(RenderCommandType::VertexBuffer, 101, 20);
+    expected.Add(RenderCommandType::IndexBuffer, 201, 2);
+    expected.AddDraw(0, 5);
+    expected.Add(RenderCommandType::IndexBuffer, 301, 2);
+    expected.AddDraw(5, 1, 12);
+    expected.Add(RenderCommandType::MaterialBuffer, 2);
+    expected.Add(RenderCommandType::IndexBuffer, 201, 2);
+    expected.AddDraw(6, 1);
+
+    CheckRecorded(sink, expected.Commands, "commands differing only by the object are instanced");
+
+    //Slots are filled in the sorted order, which keeps the order of adding for equal keys
+    const uint32_t expectedObjects[] = { 0, 1, 2, 3, 4, 6, 5 };
+    CHECK(drawList.GetInstancesObjects().size() == 7);
+
+    for (size_t i = 0; i < drawList.GetInstancesObjects().size() && i < 7; ++i)
+        CHECK(drawList.GetInstancesObjects()[i] == expectedObjects[i]);
+
+    const DrawListCounters& counters = drawList.GetCounters();
+    CHECK(counters.Draws == 3);
+    CHECK(counters.InstancedDraws == 1);
+    CHECK(counters.Instances == 7);
+    CHECK(counters.InstanceBindings == 3);
+
+    //Batches are split at the limit, the last one is left with a single instance
+    drawList.Clear();
+
+    for (uint32_t object = 0; object < 5; ++object)
+        drawList.Add(CreateDrawCommand(1, 1, 1, 1, 1, 1, object));
+
+    drawList.Sort();
+    drawList.BuildBatches(2);
+    sink.Clear();
+    drawList.Submit(&sink);
+
+    expected.Commands.clear();
+    expected.Add(RenderCommandType::VertexShader, 1);
+    expected.Add(RenderCommandType::PixelShader, 1);
+    expected.Add(RenderCommandType::InputLayout, 1);
+    expected.Add(RenderCommandType::Texture, 1);
+    expected.Add(RenderCommandType::MaterialBuffer, 1);
+    expected.Add(RenderCommandType::VertexBuffer, 101, 20);
+    expected.Add(RenderCommandType::IndexBuffer, 201, 2);
+    expected.AddDraw(0, 2);
+    expected.AddDraw(2, 2);
+    expected.AddDraw(4, 1);
+
+    CheckRecorded(sink, expected.Commands, "batches are split at maxInstances");
+    CHECK(drawList.GetCounters().InstancedDraws == 2);
+
+    //A single instance per draw is the path without D3D11.1, it never draws instanced
+    drawList.BuildBatches(1);
+    sink.Clear();
+    drawList.Submit(&sink);
+
+    expected.Commands.erase(expected.Commands.end() - 6, expected.Commands.end());
+
+    for (uint32_t object = 0; object < 5; ++object)
+        expected.AddDraw(object, 1);
+
+    CheckRecorded(sink, expected.Commands, "maxInstances of 1 gives plain draws");
+    CHECK(sink.GetCommandsAmount(RenderCommandType::DrawIndexedInstanced) == 0);
+    CHECK(drawList.GetCounters().Draws == 5);
+    CHECK(drawList.GetCounters().InstancedDraws == 0);
+}
+
+//Every frame has a single scope, so its timestamps are the two after the previous frame's ones
+static void RecordGPUFrame(GPUTimestampRing& ring, const int& frameIndex)
+{
+    ring.BeginFrame(frameIndex, frameIndex * 1000);
+    ring.Record(PROFILING_SCOPE("Frame"), ProfilingEventType::Begin);
+    ring.Record(PROFILING_SCOPE("Frame"), ProfilingEventType::End);
+    ring.EndFrame();
+}
+
+static void TestGPUTimestampRing()
+{
+    //Results are read back two frames after they ended
+    FakeGPUTimestampSource source(2, 1000000, 10);
+    GPUTimestampRing ring(&source);
+
+    RecordGPUFrame(ring, 0);
+    CHECK(ring.PopResolvedFrame() == nullptr);
+
+    source.AdvanceFrame();
+    RecordGPUFrame(ring, 1);
+    CHECK(ring.PopResolvedFrame() == nullptr);
+
+    source.AdvanceFrame();
+    GPUProfilingFrame* frame = ring.PopResolvedFrame();
+
+    if (CHECK(frame != nullptr))
+    {
+        CHECK(frame->FrameIndex == 0);
+        CHECK(frame->CPUStartTimestamp == 0);
+        CHECK(!frame->IsDisjoint);
+        CHECK(frame->Frequency == 1000000);
+        CHECK(frame->Events.size() == 2);
+
+        if (frame->Events.size() == 2)
+        {
+            CHECK(frame->Events[0].Type == ProfilingEventType::Begin);
+            CHECK(frame->Events[0].Timestamp == 10);
+            CHECK(frame->Events[1].Type == ProfilingEventType::End);
+            CHECK(frame->Events[1].Timestamp == 20);
+        }
+    }
+
+    //Frame 1 ended a frame later
+    CHECK(ring.PopResolvedFrame() == nullptr);
+    source.AdvanceFrame();
+    frame = ring.PopResolvedFrame();
+    CHECK(frame != nullptr && frame->FrameIndex == 1 && frame->Events.size() == 2 && frame->Events[0].Timestamp == 30);
+    CHECK(ring.GetLastRetiredFrameIndex() == 1);
+    CHECK(ring.ConsumeDroppedFrames() == 0);
+
+    //Queries of retired frames are reused, so frames in flight bound how many get created
+    const size_t createdQueries = source.GetCreatedQueriesAmount();
+
+    for (int i = 2; i < 12; ++i)
+    {
+        RecordGPUFrame(ring, i);
+        source.AdvanceFrame();
+
+        while (ring.PopResolvedFrame() != nullptr)
+        {
+        }
+    }
+
+    CHECK(createdQueries == 6);
+    CHECK(source.GetCreatedQueriesAmount() <= 9);
+
+    //A stalled GPU makes the ring drop its oldest frames instead of waiting for them
+    while (ring.GetLastRetiredFrameIndex() < 11)
+    {
+        source.AdvanceFrame();
+        ring.PopResolvedFrame();
+    }
+
+    source.SetLatency(1000);
+
+    for (int i = 12; i < 12 + GPU_FRAMES_IN_FLIGHT + 3; ++i)
+    {
+        RecordGPUFrame(ring, i);
+        CHECK(ring.PopResolvedFrame() == nullptr);
+    }
+
+    CHECK(ring.ConsumeDroppedFrames() == 3);
+    CHECK(ring.ConsumeDroppedFrames() == 0);
+    CHECK(ring.GetLastRetiredFrameIndex() == 14);
+
+    //The rest comes back in order once the GPU catches up
+    source.SetLatency(0);
+    int expectedIndex = 15;
+
+    while ((frame = ring.PopResolvedFrame()) != nullptr)
+    {
+        CHECK(frame->FrameIndex == expectedIndex);
+        CHECK(!frame->IsDisjoint);
+        ++expectedIndex;
+    }
+
+    CHECK(expectedIndex == 12 + GPU_FRAMES_IN_FLIGHT + 3);
+
+    //A disjoint frame is still resolved, flagged for the profiler to skip, and doesn't affect the next one
+    source.SetDisjoint(true);
+    RecordGPUFrame(ring, 100);
+    source.SetDisjoint(false);
+    RecordGPUFrame(ring, 101);
+
+    frame = ring.PopResolvedFrame();
+    CHECK(frame != nullptr && frame->FrameIndex == 100 && frame->IsDisjoint);
+    frame = ring.PopResolvedFrame();
+    CHECK(frame != nullptr && frame->FrameIndex == 101 && !frame->IsDisjoint);
+    CHECK(ring.PopResolvedFrame() == nullptr);
+}
+
+#define OCCLUSION_TEST_SIZE 64
+
+//With the identity view projection, the clip space is the screen of OCCLUSION_TEST_SIZE pixels squared
+static float GetClipX(const float& screenX)
+{
+    return screenX * 2.0f / OCCLUSION_TEST_SIZE - 1.0f;
+}
+
+static float GetClipY(const float& screenY)
+{
+    return 1.0f - screenY * 2.0f / OCCLUSION_TEST_SIZE;
+}
+
+static Bounds GetScreenBounds(const float& minX, const float& minY, const float& maxX, const float& maxY, const float& minZ, const float& maxZ)
+{
+    const float clipMinY = GetClipY(maxY);
+    const float clipMaxY = GetClipY(minY);
+
+    Bounds bounds;
+    bounds.Center[0] = (GetClipX(minX) + GetClipX(maxX)) * 0.5f;
+    bounds.Center[1] = (clipMinY + clipMaxY) * 0.5f;
+    bounds.Center[2] = (minZ + maxZ) * 0.5f;
+    bounds.Extents[0] = (GetClipX(maxX) - GetClipX(minX)) * 0.5f;
+    bounds.Extents[1] = (clipMaxY - clipMinY) * 0.5f;
+    bounds.Extents[2] = (maxZ - minZ) * 0.5f;
+    bounds.Radius = sqrtf(bounds.Extents[0] * bounds.Extents[0] + bounds.Extents[1] * bounds.Extents[1] + bounds.Extents[2] * bounds.Extents[2]);
+
+    return bounds;
+}
+
+static void TestOcclusionCoverage()
+{
+    ObjectMatrix identity;
+    memset(&identity, 0, sizeof(identity));
+
+    for (int i = 0; i < 4; ++i)
+        identity.M[i][i] = 1.0f;
+
+    //Quad at the depth of 0.5 from 10 to 40.6 pixels horizontally, split along its diagonal
+    const float positions[] = {
+        GetClipX(10.0f), GetClipY(10.0f), 0.5f,
+        GetClipX(40.6f), GetClipY(10.0f), 0.5f,
+        GetClipX(40.6f), GetClipY(50.0f), 0.5f,
+        GetClipX(10.0f), GetClipY(50.0f), 0.5f };
+    const uint32_t indices[] = { 0, 1, 2, 0, 2, 3 };
+
+    JobSystem jobSystem(1);
+    OcclusionCuller culler(&jobSystem);
+    culler.SetResolution(OCCLUSION_TEST_SIZE, OCCLUSION_TEST_SIZE);
+    culler.Begin(identity);
+    culler.AddOccluder(positions, 4, 3, indices, 6, identity);
+    culler.Rasterize();
+
+    //Pixel 39 has all of its samples left of the edge, pixel 40 has its center left of it but the last two sample columns right of it,
+    //so the box reaching past the edge in pixel 40 stays visible
+    const uint32_t behind = culler.Add(GetScreenBounds(36.2f, 20.0f, 39.9f, 30.0f, 0.6f, 0.7f), identity);
+    const uint32_t beside = culler.Add(GetScreenBounds(40.1f, 20.0f, 40.9f, 22.0f, 0.6f, 0.7f), identity);
+    //Pixels along the diagonal are covered only by both triangles together
+    const uint32_t diagonal = culler.Add(GetScreenBounds(20.0f, 20.0f, 26.0f, 30.0f, 0.6f, 0.7f), identity);
+    const uint32_t inFront = culler.Add(GetScreenBounds(36.2f, 20.0f, 39.9f, 30.0f, 0.3f, 0.4f), identity);
+    culler.Test();
+
+    CHECK(culler.IsOccluded(behind));
+    CHECK(!culler.IsOccluded(beside));
+    CHECK(culler.IsOccluded(diagonal));
+    CHECK(!culler.IsOccluded(inFront));
+    CHECK(culler.GetOccludedAmount() == 2);
+
+    CHECK(culler.GetDepth(39, 25) == 0.5f);
+    CHECK(culler.GetDepth(40, 25) == 1.0f);
+    CHECK(culler.GetDepth(10, 25) == 0.5f);
+    CHECK(culler.GetDepth(9, 25) == 1.0f);
+
+    //Every pixel the diagonal crosses is fully covered by the two halves
+    for (int y = 11; y < 49; ++y)
+    {
+        const int x = (int)(10.0f + 30.6f * (y + 0.5f - 10.0f) / 40.0f);
+
+        if (!CHECK(culler.GetDepth(x, y) == 0.5f))
+            fprintf(stderr, "  Pixel %d, %d along the diagonal isn't covered\n", x, y);
+    }
+}
+
+static bool AreLayoutsEqual(const std::vector<CachedVertexElement>& a, const std::vector<CachedVertexElement>& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t e = 0; e < a.size(); ++e)
+    {
+        if (a[e].Semantic != b[e].Semantic || a[e].SemanticIndex != b[e].SemanticIndex || a[e].Offset != b[e].Offset || a[e].Format != b[e].Format)
+            return false;
+    }
+
+    return true;
+}
+
+//Float vertices laid out like ImportMesh writes them, with values outside of the packed ranges as well
+static void CreateVertices(const std::vector<CachedVertexElement>& layout, const size_t& stride, const size_t& verticesAmount, std::vector<float>& vertices)
+{
+    uint32_t state = 12345;
+    auto random = [&state]()
+    {
+        state = state * 1664525u + 1013904223u;
+        return (float)(state >> 8) / (float)(1u << 24);
+    };
+
+    vertices.assign(verticesAmount * stride, 0.0f);
+
+    for (size_t v = 0; v < verticesAmount; ++v)
+    {
+        for (const CachedVertexElement& element : layout)
+        {
+            float* values = &vertices[v * stride + element.Offset / sizeof(float)];
+
+            switch (element.Semantic)
+            {
+            case VertexSemantic::Position:
+                for (int c = 0; c < 3; ++c)
+                    values[c] = random() * 200.0f - 100.0f;
+                break;
+            case VertexSemantic::Normal:
+            {
+                for (int c = 0; c < 3; ++c)
+                    values[c] = random() * 2.0f - 1.0f;
+
+                const float length = sqrtf(values[0] * values[0] + values[1] * values[1] + values[2] * values[2]);
+
+                for (int c = 0; c < 3; ++c)
+                    values[c] = length > 0.0f ? values[c] / length : (c == 2 ? 1.0f : 0.0f);
+                break;
+            }
+            case VertexSemantic::TexCoord:
+                values[0] = random() * 4.0f - 2.0f;
+                values[1] = random() * 4.0f - 2.0f;
+                break;
+            case VertexSemantic::Color:
+                for (int c = 0; c < 4; ++c)
+                    values[c] = random() * 1.5f - 0.25f;
+                break;
+            }
+        }
+    }
+}
+
+//Every compiled layout against packing element by element, which MeshBenchmarks compares on imported models
+static void TestVertexPacking()
+{
+    const VertexSemantic semantics[] = { VertexSemantic::Position, VertexSemantic::Normal, VertexSemantic::TexCoord, VertexSemantic::Color };
+    const VertexFormat formats[] = { VertexFormat::Float3, VertexFormat::Float3, VertexFormat::Float2, VertexFormat::Float4 };
+    const uint32_t components[] = { 3, 3, 2, 4 };
+    const size_t verticesAmount = 257;
+
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        //None, default and all
+        VertexPacking packing;
+        packing.QuantizePositions = mode == 2;
+        packing.OctahedralNormals = mode != 0;
+        packing.HalfTexCoords = mode != 0;
+        packing.Unorm8Colors = mode != 0;
+
+        for (int elementsAmount = 1; elementsAmount <= 4; ++elementsAmount)
+        {
+            std::vector<CachedVertexElement> layout;
+            uint32_t stride = 0;
+
+            for (int e = 0; e < elementsAmount; ++e)
+            {
+                layout.push_back({ semantics[e], 0, stride * (uint32_t)sizeof(float), formats[e] });
+                stride += components[e];
+            }
+
+            std::vector<float> vertices;
+            CreateVertices(layout, stride, verticesAmount, vertices);
+
+            std::vector<uint8_t> generic;
+            std::vector<uint8_t> compiled;
+            std::vector<CachedVertexElement> genericLayout;
+            std::vector<CachedVertexElement> compiledLayout;
+            float genericScale[3];
+            float genericOffset[3];
+            float compiledScale[3];
+            float compiledOffset[3];
+
+            const uint32_t genericStride = PackVerticesGeneric(vertices.data(), verticesAmount, stride, layout, packing, generic, genericLayout, genericScale, genericOffset);
+            const uint32_t compiledStride = PackVertices(vertices.data(), verticesAmount, stride, layout, packing, compiled, compiledLayout, compiledScale, compiledOffset);
+
+            if (!CHECK(HasCompiledVertexLayout(layout, stride, packing)) || !CHECK(compiledStride == genericStride) || !CHECK(compiled == generic)
+                || !CHECK(AreLayoutsEqual(compiledLayout, genericLayout)) || !CHECK(memcmp(compiledScale, genericScale, sizeof(genericScale)) == 0)
+                || !CHECK(memcmp(compiledOffset, genericOffset, sizeof(genericOffset)) == 0))
+            {
+                fprintf(stderr, "  Packing %d with %d elements\n", mode, elementsAmount);
+                continue;
+            }
+
+            //Decoded like the software rasterizer reads them, within the precision of the packed formats
+            float maxPositionError = 0.0f;
+            float maxNormalError = 0.0f;
+            float maxTexCoordError = 0.0f;
+
+            for (size_t e = 0; e < compiledLayout.size(); ++e)
+            {
+                const CachedVertexElement& element = compiledLayout[e];
+
+                for (size_t v = 0; v < verticesAmount; ++v)
+                {
+                    const float* source = &vertices[v * stride + layout[e].Offset / sizeof(float)];
+                    float decoded[3];
+
+                    if (element.Semantic == VertexSemantic::Position)
+                    {
+                        UnpackPositions(compiled.data() + v * compiledStride, 1, compiledStride, element, compiledScale, compiledOffset, decoded);
+
+                        for (int c = 0; c < 3; ++c)
+                            maxPositionError = std::max(maxPositionError, fabsf(decoded[c] - source[c]));
+                    }
+                    else if (element.Semantic == VertexSemantic::Normal)
+                    {
+                        UnpackNormals(compiled.data() + v * compiledStride, 1, compiledStride, element, decoded);
+
+                        for (int c = 0; c < 3; ++c)
+                            maxNormalError = std::max(maxNormalError, fabsf(decoded[c] - source[c]));
+                    }
+                    else if (element.Semantic == VertexSemantic::TexCoord)
+                    {
+                        UnpackTexCoords(compiled.data() + v * compiledStride, 1, compiledStride, element, decoded);
+
+                        for (int c = 0; c < 2; ++c)
+                            maxTexCoordError = std::max(maxTexCoordError, fabsf(decoded[c] - source[c]));
+                    }
+                }
+            }
+
+            //Unorm16 over 200 units, octahedral Snorm16 and half precision at 2
+            CHECK(maxPositionError <= (mode == 2 ? 200.0f / 65535.0f : 0.0f));
+            CHECK(maxNormalError <= (mode == 0 ? 0.0f : 1e-3f));
+            CHECK(maxTexCoordError <= (mode == 0 ? 0.0f : 1e-3f));
+        }
+    }
+
+    //Layouts without a compiled converter fall back to packing element by element
+    std::vector<CachedVertexElement> layout = { { VertexSemantic::Position, 0, 0, VertexFormat::Float3 }, { VertexSemantic::TexCoord, 0, 12, VertexFormat::Float2 } };
+    CHECK(!HasCompiledVertexLayout(layout, 5, VertexPacking()));
+}
+
+//Values arrive from the middle of the range first, so buckets grow both below and above
+static void TestStreamingStatistics()
+{
+    StreamingStatistics statistics;
+    std::vector<double> values;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        statistics.Reset();
+        values.clear();
+
+        const double firstValues[] = { 1000.0, 1500.0, 3.0, 70000000.0, 1.25, 250.0 };
+        for (const double& value : firstValues)
+        {
+            statistics.Add(value);
+            values.push_back(value);
+        }
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            const double value = 1.0 + (double)((i * 7919) % 100000);
+            statistics.Add(value);
+            values.push_back(value);
+        }
+
+        std::sort(values.begin(), values.end());
+        CHECK(statistics.GetCount() == values.size());
+        CHECK(statistics.GetMin() == values.front());
+        CHECK(statistics.GetMax() == values.back());
+
+        const double percentiles[] = { 0.0, 1.0, 25.0, 50.0, 90.0, 99.0, 100.0 };
+        for (const double& percentile : percentiles)
+        {
+            size_t rank = (size_t)ceil(percentile / 100.0 * (double)values.size());
+            rank = rank == 0 ? 0 : rank - 1;
+
+            const double expected = values[rank];
+            const double error = fabs(statistics.GetPercentile(percentile) - expected);
+            CHECK(error <= std::max(expected, 1.0) / STATISTICS_SUB_BUCKETS);
+        }
+    }
+}
+
+static void WriteFile(const std::string& path, const std::vector<uint8_t>& contents)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)contents.data(), contents.size());
+}
+
+//Fake textures take as much memory as their files, so the budget is in file bytes
+static void TestTextureCache()
+{
+    const std::string a = "EngineTests_a.tex";
+    const std::string copyOfA = "EngineTests_copy_of_a.tex";
+    const std::string c = "EngineTests_c.tex";
+    const std::string d = "EngineTests_d.tex";
+    const std::string empty = "EngineTests_empty.tex";
+
+    WriteFile(a, std::vector<uint8_t>(16, 1));
+    WriteFile(copyOfA, std::vector<uint8_t>(16, 1));
+    WriteFile(c, std::vector<uint8_t>(32, 2));
+    WriteFile(d, std::vector<uint8_t>(48, 3));
+    WriteFile(empty, std::vector<uint8_t>());
+
+    FakeTextureDecoder decoder;
+    FakeTextureDevice device;
+
+    {
+        TextureCache cache(&decoder, &device, 64);
+
+        const TextureHandle textureA = cache.Acquire(a);
+        CHECK(textureA != nullptr);
+
+        //The file isn't opened again, so the directory doesn't have to exist
+        CHECK(cache.Acquire("./missing/../" + a) == textureA);
+        CHECK(cache.GetStatistics().PathHits == 1);
+
+        CHECK(cache.Acquire(copyOfA) == textureA);
+        CHECK(cache.GetStatistics().ContentHits == 1);
+        CHECK(decoder.GetDecodesAmount() == 1);
+
+        cache.Release(textureA);
+        cache.Release(textureA);
+        CHECK(cache.GetStatistics().UnusedBytes == 0);
+        cache.Release(textureA);
+        CHECK(cache.GetStatistics().UnusedBytes == 16);
+        CHECK(device.GetLiveTexturesAmount() == 1);
+
+        //Unused textures come back without decoding
+        CHECK(cache.Acquire(copyOfA) == textureA);
+        CHECK(cache.GetStatistics().UnusedBytes == 0);
+        CHECK(decoder.GetDecodesAmount() == 1);
+
+        const TextureHandle textureC = cache.Acquire(c);
+        const TextureHandle textureD = cache.Acquire(d);
+        CHECK(textureC != nullptr && textureD != nullptr && textureC != textureD);
+
+        //A and D fill the budget, releasing A after D makes D the least recently used
+        cache.Release(textureD);
+        cache.Release(textureA);
+        CHECK(cache.GetStatistics().Evictions == 0);
+
+        cache.Release(textureC);
+        TextureCacheStatistics statistics = cache.GetStatistics();
+        CHECK(statistics.Evictions == 1);
+        CHECK(statistics.TexturesAmount == 2);
+        CHECK(statistics.UnusedBytes == 48);
+        CHECK(device.GetLiveTexturesAmount() == 2);
+
+        CHECK(cache.Acquire(a) == textureA);
+        CHECK(cache.Acquire(c) == textureC);
+        CHECK(decoder.GetDecodesAmount() == 3);
+
+        //D is decoded again, and may reuse a handle of the fake device
+        const TextureHandle newTextureD = cache.Acquire(d);
+        CHECK(newTextureD != nullptr);
+        CHECK(decoder.GetDecodesAmount() == 4);
+
+        //Exactly the budget, so nothing is evicted until asked to
+        cache.Release(newTextureD);
+        cache.Release(textureA);
+        CHECK(cache.GetStatistics().UnusedBytes == 64);
+        CHECK(cache.EvictUnused() == 2);
+        statistics = cache.GetStatistics();
+        CHECK(statistics.TexturesAmount == 1);
+        CHECK(statistics.UnusedBytes == 0);
+        CHECK(statistics.ResidentBytes == 32);
+        CHECK(device.GetLiveTexturesAmount() == 1);
+
+        CHECK(cache.Acquire("EngineTests_missing.tex") == nullptr);
+        CHECK(cache.Acquire(empty) == nullptr);
+        CHECK(device.GetLiveTexturesAmount() == 1);
+
+        //C is still referenced when the cache goes away
+    }
+
+    CHECK(device.GetLiveTexturesAmount() == 0);
+    CHECK(device.GetInvalidReleasesAmount() == 0);
+
+    const std::string paths[] = { a, copyOfA, c, d, empty };
+    for (const std::string& path : paths)
+        remove(path.c_str());
+}
+
+int main()
+{
+    TestDrawListSorting();
+    TestDrawListRedundantState();
+    TestDrawListInstancing();
+    TestGPUTimestampRing();
+    TestOcclusionCoverage();
+    TestVertexPacking();
+    TestStreamingStatistics();
+    TestTextureCache();
+
+    if (s_failuresAmount > 0)
+    {
+        fprintf(stderr, "%d of %d checks failed\n", s_failuresAmount, s_checksAmount);
+        return 1;
+    }
+
+    printf("All %d checks passed\n", s_checksAmount);
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "AllocationTracking.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+thread_local AllocationCounters t_allocationCounters = { 0, 0 };
+
+#ifdef TRACK_ALLOCATIONS
+
+void* operator new(size_t size)
+{
+    ++t_allocationCounters.Allocations;
+    t_allocationCounters.Bytes += size;
+
+    void* ptr = malloc(size > 0 ? size : 1);
+
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    ++t_allocationCounters.Allocations;
+    t_allocationCounters.Bytes += size;
+
+    return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+#ifdef __cpp_aligned_new
+
+static void* AllocateAligned(const size_t& size, const std::align_val_t& alignment) noexcept
+{
+    ++t_allocationCounters.Allocations;
+    t_allocationCounters.Bytes += size;
+
+#ifdef _MSC_VER
+    return _aligned_malloc(size > 0 ? size : 1, (size_t)alignment);
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, std::max((size_t)alignment, sizeof(void*)), size > 0 ? size : 1) == 0 ? ptr : nullptr;
+#endif
+}
+
+//Memory of aligned allocations can't be freed by free on Windows
+static void FreeAligned(void* const& ptr) noexcept
+{
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    void* ptr = AllocateAligned(size, alignment);
+
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    FreeAligned(ptr);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+//Replaces global operator new/delete with versions counting allocations of the calling thread.
+//Over-aligned variants are replaced as well when the compiler has them (C++17 or /Zc:alignedNew)
+//#define TRACK_ALLOCATIONS
+
+struct AllocationCounters
+{
+    uint32_t Allocations;
+    uint64_t Bytes;
+};
+
+extern thread_local AllocationCounters t_allocationCounters;
+
+inline const AllocationCounters& GetThreadAllocationCounters() { return t_allocationCounters; }
@@ -1,17 +1,29 @@
 #include "Common.fxh"
 #include "Light.fxh"
 
-cbuffer cbPerObject : register(b4)
+//Has to match OBJECT_CONSTANTS_MAX_INSTANCES, draws bind only the slots of their instances
+#define MAX_INSTANCES 256
+
+struct ObjectData
 {
     float4x4 W;
     float4x4 WVP;
     float4x4 PrevWVP;
+    float4x4 Pad;
+};
+
+cbuffer cbPerObject : register(b4)
+{
+    ObjectData Objects[MAX_INSTANCES];
 };
 
 cbuffer cbMaterial : register(b5)
 {
     float3 Diffuse;
     float3 Specular;
+    float3 PositionScale;
+    float OctahedralNormals;
+    float3 PositionOffset;
 }
 
 cbuffer cbTAA : register(b6)
@@ -21,6 +33,7 @@ cbuffer cbTAA : register(b6)
 
 Texture2D ObjTexture;
 
+//Packed formats are expanded by the input assembler, octahedral normals come in xy only
 struct VS_INPUT
 {
     float3 Pos : POSITION;
@@ -43,15 +56,29 @@ struct PSOutput
     float2 Velocity : SV_Target1;
 };
 
-VS_OUTPUT VS(VS_INPUT input)
+float3 DecodeOctahedral(float2 encoded)
 {
+    float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = saturate(-normal.z);
+    normal.xy += normal.xy >= 0.0f ? -fold : fold;
+
+    return normalize(normal);
+}
+
+VS_OUTPUT VS(VS_INPUT input, uint instanceID : SV_InstanceID)
+{
+    ObjectData objectData = Objects[instanceID];
+
+    float3 position = input.Pos * PositionScale + PositionOffset;
+    float3 normal = OctahedralNormals > 0.5f ? DecodeOctahedral(input.Normal.xy) : input.Normal;
+
     VS_OUTPUT output;
-    output.Pos = mul(float4(input.Pos, 1.0f), WVP);
-    output.PrevPos = mul(float4(input.Pos, 1.0f), PrevWVP);
+    output.Pos = mul(float4(position, 1.0f), objectData.WVP);
+    output.PrevPos = mul(float4(position, 1.0f), objectData.PrevWVP);
     output.TexCoord = input.TexCoord * 10.0f;
 
-    float3 worldNormal = normalize(mul(input.Normal, W).xyz);
-    float3 worldPos = mul(float4(input.Pos, 1.0f), W).xyz;
+    float3 worldNormal = normalize(mul(normal, objectData.W).xyz);
+    float3 worldPos = mul(float4(position, 1.0f), objectData.W).xyz;
 
     CalcLighting(worldPos, worldNormal, CameraPos, output.Diffuse, output.Specular);
 
@@ -11,6 +11,7 @@ public:
 
     DirectX::XMMATRIX GetViewMatrix();
     inline DirectX::XMMATRIX GetProjectionMatrix() const { return m_projectionMatrixWithOffset; }
+    inline DirectX::XMMATRIX GetProjectionMatrixWithoutOffset() const { return m_projectionMatrix; }
     void Initialize(const float& fov, const float& aspectRatio, const float& nearClip, const float& farClip);
 
     virtual void Update() override;
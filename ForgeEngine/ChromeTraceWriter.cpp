@@ -0,0 +1,113 @@
+#include "ChromeTraceWriter.h"
+#include <cstdio>
+
+ChromeTraceWriter::ChromeTraceWriter()
+{
+    m_buffer.reserve(TRACE_WRITER_BUFFER_SIZE + 1024);
+}
+
+ChromeTraceWriter::~ChromeTraceWriter()
+{
+    Close();
+}
+
+bool ChromeTraceWriter::Open(const std::string& path)
+{
+    Close();
+
+    m_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!m_file.is_open())
+        return false;
+
+    m_firstEvent = true;
+    m_buffer = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    return true;
+}
+
+void ChromeTraceWriter::Close()
+{
+    if (!m_file.is_open())
+        return;
+
+    m_buffer += "\n]}\n";
+    Flush();
+
+    m_file.close();
+}
+
+void ChromeTraceWriter::WriteProcessName(const uint32_t& pid, const std::string& name)
+{
+    WriteMetadata("process_name", pid, 0, name);
+}
+
+void ChromeTraceWriter::WriteThreadName(const uint32_t& pid, const uint32_t& tid, const std::string& name)
+{
+    WriteMetadata("thread_name", pid, tid, name);
+}
+
+void ChromeTraceWriter::WriteBegin(const uint32_t& pid, const uint32_t& tid, const char* name, const double& timestampUs)
+{
+    WriteEvent('B', pid, tid, name, timestampUs);
+}
+
+void ChromeTraceWriter::WriteEnd(const uint32_t& pid, const uint32_t& tid, const char* name, const double& timestampUs)
+{
+    WriteEvent('E', pid, tid, name, timestampUs);
+}
+
+void ChromeTraceWriter::WriteEvent(const char& phase, const uint32_t& pid, const uint32_t& tid, const char* name, const double& timestampUs)
+{
+    if (!m_file.is_open())
+        return;
+
+    char tmp[96];
+
+    m_buffer += m_firstEvent ? "\n{\"name\":\"" : ",\n{\"name\":\"";
+    m_firstEvent = false;
+
+    AppendEscaped(name);
+
+    snprintf(tmp, sizeof(tmp), "\",\"ph\":\"%c\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}", phase, pid, tid, timestampUs);
+    m_buffer += tmp;
+
+    if (m_buffer.size() >= TRACE_WRITER_BUFFER_SIZE)
+        Flush();
+}
+
+void ChromeTraceWriter::WriteMetadata(const char* type, const uint32_t& pid, const uint32_t& tid, const std::string& name)
+{
+    if (!m_file.is_open())
+        return;
+
+    char tmp[96];
+
+    m_buffer += m_firstEvent ? "\n{\"name\":\"" : ",\n{\"name\":\"";
+    m_firstEvent = false;
+
+    snprintf(tmp, sizeof(tmp), "%s\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"", type, pid, tid);
+    m_buffer += tmp;
+
+    AppendEscaped(name.c_str());
+    m_buffer += "\"}}";
+}
+
+void ChromeTraceWriter::AppendEscaped(const char* str)
+{
+    for (; *str; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+            m_buffer += '\\';
+
+        m_buffer += *str;
+    }
+}
+
+void ChromeTraceWriter::Flush()
+{
+    if (!m_buffer.empty())
+        m_file.write(m_buffer.data(), (std::streamsize)m_buffer.size());
+
+    m_buffer.clear();
+}
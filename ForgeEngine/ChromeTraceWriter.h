@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#define TRACE_WRITER_BUFFER_SIZE (256 * 1024)
+
+//Streams Trace Event Format JSON (chrome://tracing, ui.perfetto.dev)
+class ChromeTraceWriter
+{
+public:
+    ChromeTraceWriter();
+    ~ChromeTraceWriter();
+
+    bool Open(const std::string& path);
+    void Close();
+    inline bool IsOpen() const { return m_file.is_open(); }
+
+    void WriteProcessName(const uint32_t& pid, const std::string& name);
+    void WriteThreadName(const uint32_t& pid, const uint32_t& tid, const std::string& name);
+
+    void WriteBegin(const uint32_t& pid, const uint32_t& tid, const char* name, const double& timestampUs);
+    void WriteEnd(const uint32_t& pid, const uint32_t& tid, const char* name, const double& timestampUs);
+
+private:
+    void WriteEvent(const char& phase, const uint32_t& pid, const uint32_t& tid, const char* name, const double& timestampUs);
+    void WriteMetadata(const char* type, const uint32_t& pid, const uint32_t& tid, const std::string& name);
+    void AppendEscaped(const char* str);
+    void Flush();
+
+    std::ofstream m_file;
+    std::string m_buffer;
+    bool m_firstEvent = true;
+};
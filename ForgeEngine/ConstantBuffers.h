@@ -39,12 +39,7 @@ struct cbCameraInfo
     DirectX::XMFLOAT2 pad1;
 };
 
-struct cbPerObject
-{
-    DirectX::XMMATRIX W;
-    DirectX::XMMATRIX WVP;
-    DirectX::XMMATRIX PrevWVP;
-};
+//cbPerObject holds an array of ObjectConstants, see ObjectConstants.h
 
 struct cbMaterial
 {
@@ -52,6 +47,10 @@ struct cbMaterial
     float Pad0;
     DirectX::XMFLOAT3 Specular;
     float Pad1;
+    DirectX::XMFLOAT3 PositionScale;
+    float OctahedralNormals;
+    DirectX::XMFLOAT3 PositionOffset;
+    float Pad2;
 };
 
 struct cbGlobalInfo
@@ -46,7 +46,9 @@ Core::~Core()
     for (Object* const& obj : m_objectsToDelete)
         delete obj;
 
-    m_swapChain->Release();
+    if (m_swapChain != nullptr)
+        m_swapChain->Release();
+
     m_d3Device->Release();
     m_d3DeviceContext->Release();
     m_renderTargetView->Release();
@@ -75,8 +77,10 @@ Core::~Core()
     delete m_rtvsManager;
 }
 
-void Core::Run(const HINSTANCE& hInstance, const int& ShowWnd, const int& width, const int& height, int resW, int resH, std::string resultsPath)
+void Core::Run(const HINSTANCE& hInstance, const int& ShowWnd, const int& width, const int& height, int resW, int resH, std::string resultsPath, const bool& headless)
 {
+    m_headless = headless;
+
     Initialize(hInstance, ShowWnd, width, height);
 
     m_resultsPath = resultsPath;
@@ -87,15 +91,19 @@ void Core::Run(const HINSTANCE& hInstance, const int& ShowWnd, const int& width,
     {
         Profiler::StartFrame();
 
-        Profiler::StartProfiling(FRAME_ANALYZE_NAME);
-        Profiler::StartCPUProfiling("Engine frame");
+        Profiler::StartProfiling(PROFILING_SCOPE(FRAME_ANALYZE_NAME));
+        Profiler::StartCPUProfiling(PROFILING_SCOPE("Engine frame"));
 
         m_temporaryRTV = GetRTVForTemporary();
 
+        Profiler::StartCPUProfiling(PROFILING_SCOPE("Window update"));
         m_window->Update();
+        Profiler::EndCPUProfiling(PROFILING_SCOPE("Window update"));
         Time::UpdateTime(false);
         InputClass::UpdateInput();
+        Profiler::StartCPUProfiling(PROFILING_SCOPE("Shaders update"));
         ShadersManager::Update();
+        Profiler::EndCPUProfiling(PROFILING_SCOPE("Shaders update"));
         BeforeUpdateScene();
         UpdateScene();
         AfterUpdateScene();
@@ -103,32 +111,39 @@ void Core::Run(const HINSTANCE& hInstance, const int& ShowWnd, const int& width,
         DeletePendingObjects();
         AddPendingObjects();
 
+        Profiler::StartCPUProfiling(PROFILING_SCOPE("Culling"));
+        m_renderingSystem->PrepareFrame(m_camera);
+        Profiler::EndCPUProfiling(PROFILING_SCOPE("Culling"));
+
         MainRTVProcessing();
 
         {
-            Profiler::StartProfiling("UI");
+            Profiler::StartProfiling(PROFILING_SCOPE("UI"));
             GetUIRenderingSystem()->OnBeforeDrawing();
-            Profiler::StartProfiling("Profiler");
+            Profiler::StartProfiling(PROFILING_SCOPE("Profiler"));
             Profiler::Draw();
-            Profiler::EndProfiling("Profiler");
+            Profiler::EndProfiling(PROFILING_SCOPE("Profiler"));
 
-            Profiler::StartProfiling("DebugLog");
+            Profiler::StartProfiling(PROFILING_SCOPE("DebugLog"));
             DebugLog::Draw();
-            Profiler::EndProfiling("DebugLog");
+            Profiler::EndProfiling(PROFILING_SCOPE("DebugLog"));
 
-            Profiler::EndProfiling("UI");
+            Profiler::EndProfiling(PROFILING_SCOPE("UI"));
         }
 
         MergeRTVsToMain();
-        Profiler::StartProfiling("Empty");
-        Profiler::EndProfiling("Empty");
+        Profiler::StartProfiling(PROFILING_SCOPE("Empty"));
+        Profiler::EndProfiling(PROFILING_SCOPE("Empty"));
 
-        Profiler::StartProfiling("Swapchain");
-        m_swapChain->Present(0, 0);
-        Profiler::EndProfiling("Swapchain");
+        if (!m_headless)
+        {
+            Profiler::StartProfiling(PROFILING_SCOPE("Swapchain"));
+            m_swapChain->Present(0, 0);
+            Profiler::EndProfiling(PROFILING_SCOPE("Swapchain"));
+        }
 
-        Profiler::EndCPUProfiling("Engine frame");
-        Profiler::EndProfiling(FRAME_ANALYZE_NAME);
+        Profiler::EndCPUProfiling(PROFILING_SCOPE("Engine frame"));
+        Profiler::EndProfiling(PROFILING_SCOPE(FRAME_ANALYZE_NAME));
         Profiler::EndFrame();
 
         m_rtvsManager->ReleaseRTV(m_temporaryRTV);
@@ -143,6 +158,10 @@ void Core::Run(const HINSTANCE& hInstance, const int& ShowWnd, const int& width,
 
 void Core::MakeScreenshot(std::string name)
 {
+    //Null device doesn't produce any pixels
+    if (s_instance->m_headless)
+        return;
+
     DirectX::ScratchImage image;
 
     if (name == "")
@@ -209,6 +228,9 @@ HRESULT Core::InitializeSwapChain()
     flags |= D3D11_CREATE_DEVICE_DEBUG;
 #endif
 
+    if (m_headless)
+        return D3D11CreateDevice(NULL, D3D_DRIVER_TYPE_NULL, NULL, flags, featureLevels, ARRAYSIZE(featureLevels), D3D11_SDK_VERSION, &m_d3Device, NULL, &m_d3DeviceContext);
+
     return D3D11CreateDeviceAndSwapChain(NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, flags, featureLevels, ARRAYSIZE(featureLevels), D3D11_SDK_VERSION, &swapChainDesc, &m_swapChain, &m_d3Device, NULL, &m_d3DeviceContext);
 }
 
@@ -348,7 +370,7 @@ HRESULT Core::InitializeD3D()
 
     InitializeSwapChain();
     ID3D11Texture2D* BackBuffer;
-    HRESULT hr = m_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&BackBuffer);
+    HRESULT hr = GetBackBuffer(&BackBuffer);
 
     if (hr != S_OK)
         return hr;
@@ -361,6 +383,30 @@ HRESULT Core::InitializeD3D()
     return hr;
 }
 
+HRESULT Core::GetBackBuffer(ID3D11Texture2D** backBuffer)
+{
+    if (!m_headless)
+        return m_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)backBuffer);
+
+    //Without a swap chain a plain texture of the same size and format takes its place
+    DXGI_MODE_DESC bufferDesc;
+    FillSwapChainBufferDescWithDefaultValues(bufferDesc);
+
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+
+    desc.Width = bufferDesc.Width;
+    desc.Height = bufferDesc.Height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = bufferDesc.Format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+
+    return m_d3Device->CreateTexture2D(&desc, nullptr, backBuffer);
+}
+
 void Core::FillDepthStencilDescWithDefaultValues(D3D11_TEXTURE2D_DESC& desc)
 {
     ZeroMemory(&desc, sizeof(desc));
@@ -454,8 +500,8 @@ void Core::InitScene()
 
 void Core::BeforeUpdateScene()
 {
-
-
+    //Renderers of models loaded in the background are added for this frame
+    m_renderingSystem->AttachLoadedModels();
 }
 
 void Core::UpdateScene()
@@ -468,13 +514,13 @@ void Core::UpdateScene()
 
 void Core::MainRTVProcessing()
 {
-    Profiler::StartProfiling("Drawing");
+    Profiler::StartProfiling(PROFILING_SCOPE("Drawing"));
     DrawScene();
-    Profiler::EndProfiling("Drawing");
+    Profiler::EndProfiling(PROFILING_SCOPE("Drawing"));
 
-    Profiler::StartProfiling("PostProcessing");
+    Profiler::StartProfiling(PROFILING_SCOPE("PostProcessing"));
     PostProcessing();
-    Profiler::EndProfiling("PostProcessing");
+    Profiler::EndProfiling(PROFILING_SCOPE("PostProcessing"));
 }
 
 void Core::PostProcessing()
@@ -539,12 +585,15 @@ void Core::OnResizeWindow(const int& width, const int& height)
     if (m_renderTargetView != nullptr)
         m_renderTargetView->Release();
 
-    DXGI_SWAP_CHAIN_DESC swapChainDesc;
-    m_swapChain->GetDesc(&swapChainDesc);
-    HRESULT hr = m_swapChain->ResizeBuffers(swapChainDesc.BufferCount, m_window->GetWidth(), m_window->GetHeight(), swapChainDesc.BufferDesc.Format, swapChainDesc.Flags);
+    if (!m_headless)
+    {
+        DXGI_SWAP_CHAIN_DESC swapChainDesc;
+        m_swapChain->GetDesc(&swapChainDesc);
+        m_swapChain->ResizeBuffers(swapChainDesc.BufferCount, m_window->GetWidth(), m_window->GetHeight(), swapChainDesc.BufferDesc.Format, swapChainDesc.Flags);
+    }
 
     ID3D11Texture2D* BackBuffer;
-    hr = m_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&BackBuffer);
+    HRESULT hr = GetBackBuffer(&BackBuffer);
 
     hr = m_d3Device->CreateRenderTargetView(BackBuffer, NULL, &m_renderTargetView);
     BackBuffer->Release();
@@ -25,7 +25,8 @@ public:
     Core();
     virtual ~Core();
 
-    void Run(const HINSTANCE& hInstance, const int& ShowWnd, const int& width, const int& height, int resW, int resH, std::string resultsPath);
+    //Headless runs on the D3D11 null driver, so Windows only - every call is validated and recorded on the CPU, but nothing is rendered or presented
+    void Run(const HINSTANCE& hInstance, const int& ShowWnd, const int& width, const int& height, int resW, int resH, std::string resultsPath, const bool& headless = false);
 
     static inline RenderingSystem* GetRenderingSystem() { return s_instance->m_renderingSystem; }
     static inline UIRenderingSystem* GetUIRenderingSystem() { return s_instance->m_UIRenderingSystem; }
@@ -40,6 +41,7 @@ public:
     static void MakeScreenshot(std::string name = "");
     static void RequestScreenshot(std::string name = "");
     static inline std::string GetResultsPath() { return s_instance->m_resultsPath; }
+    static inline bool IsHeadless() { return s_instance->m_headless; }
 
     template<typename T, typename ... Args>
     static T* InstantiateObject(Args&&... args)
@@ -69,6 +71,7 @@ protected:
     virtual HRESULT InitializeD3D();
     virtual HRESULT InitializeSwapChain();
     virtual HRESULT InitializeDepthStencilBuffer();
+    HRESULT GetBackBuffer(ID3D11Texture2D** backBuffer);
 
     virtual void InitScene();
 
@@ -107,7 +110,8 @@ private:
     std::vector<Object*> m_objectsToAdd;
     std::vector<Object*> m_objectsToDelete;
 
-    IDXGISwapChain* m_swapChain;
+    bool m_headless = false;
+    IDXGISwapChain* m_swapChain = nullptr;
     ID3D11Device* m_d3Device;
     ID3D11DeviceContext* m_d3DeviceContext;
     ID3D11RenderTargetView* m_renderTargetView;
@@ -0,0 +1,60 @@
+#include "D3D11GPUTimestampSource.h"
+#include <d3d11.h>
+
+D3D11GPUTimestampSource::D3D11GPUTimestampSource(ID3D11Device* const& device, ID3D11DeviceContext* const& context)
+{
+    m_device = device;
+    m_context = context;
+}
+
+D3D11GPUTimestampSource::~D3D11GPUTimestampSource()
+{
+    for (ID3D11Query* const& query : m_queries)
+        query->Release();
+}
+
+GPUQueryHandle D3D11GPUTimestampSource::CreateQuery(const GPUQueryType& type)
+{
+    D3D11_QUERY_DESC desc;
+    desc.MiscFlags = 0;
+    desc.Query = type == GPUQueryType::Timestamp ? D3D11_QUERY_TIMESTAMP : D3D11_QUERY_TIMESTAMP_DISJOINT;
+
+    ID3D11Query* query;
+    m_device->CreateQuery(&desc, &query);
+    m_queries.push_back(query);
+
+    return (GPUQueryHandle)(m_queries.size() - 1);
+}
+
+void D3D11GPUTimestampSource::Begin(const GPUQueryHandle& query)
+{
+    m_context->Begin(m_queries[query]);
+}
+
+void D3D11GPUTimestampSource::End(const GPUQueryHandle& query)
+{
+    m_context->End(m_queries[query]);
+}
+
+bool D3D11GPUTimestampSource::TryGetTimestamp(const GPUQueryHandle& query, uint64_t& timestamp)
+{
+    UINT64 result;
+
+    if (m_context->GetData(m_queries[query], &result, sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        return false;
+
+    timestamp = result;
+    return true;
+}
+
+bool D3D11GPUTimestampSource::TryGetDisjoint(const GPUQueryHandle& query, uint64_t& frequency, bool& disjoint)
+{
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT result;
+
+    if (m_context->GetData(m_queries[query], &result, sizeof(result), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        return false;
+
+    frequency = result.Frequency;
+    disjoint = result.Disjoint != FALSE;
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include "IGPUTimestampSource.h"
+
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+struct ID3D11Query;
+
+class D3D11GPUTimestampSource : public IGPUTimestampSource
+{
+public:
+    D3D11GPUTimestampSource(ID3D11Device* const& device, ID3D11DeviceContext* const& context);
+    virtual ~D3D11GPUTimestampSource() override;
+
+    virtual GPUQueryHandle CreateQuery(const GPUQueryType& type) override;
+
+    virtual void Begin(const GPUQueryHandle& query) override;
+    virtual void End(const GPUQueryHandle& query) override;
+
+    virtual bool TryGetTimestamp(const GPUQueryHandle& query, uint64_t& timestamp) override;
+    virtual bool TryGetDisjoint(const GPUQueryHandle& query, uint64_t& frequency, bool& disjoint) override;
+
+private:
+    ID3D11Device* m_device;
+    ID3D11DeviceContext* m_context;
+    std::vector<ID3D11Query*> m_queries;
+};
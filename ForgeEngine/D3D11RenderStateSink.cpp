@@ -0,0 +1,141 @@
+#include "D3D11RenderStateSink.h"
+#include <d3d11_1.h>
+#include <cstring>
+#include "ConstantBuffers.h"
+
+D3D11RenderStateSink::D3D11RenderStateSink(ID3D11Device* const& device, ID3D11DeviceContext* const& context)
+{
+    m_device = device;
+    m_context = context;
+
+    if (FAILED(m_context->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&m_context1)))
+        m_context1 = nullptr;
+
+    //Windows 7 with the Platform Update has the D3D11.1 interfaces, but ignores the offsets
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if (m_context1 && (FAILED(m_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) || !options.ConstantBufferOffsetting))
+    {
+        m_context1->Release();
+        m_context1 = nullptr;
+    }
+
+    //Without offsets the whole cbPerObject Base.fx declares is bound, so it has to be that big
+    CreateObjectsBuffer(m_context1 ? OBJECT_CONSTANTS_INITIAL_CAPACITY : OBJECT_CONSTANTS_MAX_INSTANCES);
+}
+
+D3D11RenderStateSink::~D3D11RenderStateSink()
+{
+    m_objectsBuffer->Release();
+
+    if (m_context1)
+        m_context1->Release();
+}
+
+void D3D11RenderStateSink::UploadInstancesConstants(const ObjectConstants* const& instances, const uint32_t& amount)
+{
+    m_instances = instances;
+
+    if (!m_context1 || amount == 0)
+        return;
+
+    if (amount > m_objectsCapacity)
+    {
+        m_objectsBuffer->Release();
+        CreateObjectsBuffer(amount > 2 * m_objectsCapacity ? amount : 2 * m_objectsCapacity);
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(m_context->Map(m_objectsBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        return;
+
+    memcpy(mapped.pData, instances, amount * sizeof(ObjectConstants));
+    m_context->Unmap(m_objectsBuffer, 0);
+}
+
+void D3D11RenderStateSink::SetVertexShader(const RenderResourceHandle& shader)
+{
+    m_context->VSSetShader(static_cast<ID3D11VertexShader*>(shader), 0, 0);
+}
+
+void D3D11RenderStateSink::SetPixelShader(const RenderResourceHandle& shader)
+{
+    m_context->PSSetShader(static_cast<ID3D11PixelShader*>(shader), 0, 0);
+}
+
+void D3D11RenderStateSink::SetInputLayout(const RenderResourceHandle& layout)
+{
+    m_context->IASetInputLayout(static_cast<ID3D11InputLayout*>(layout));
+}
+
+void D3D11RenderStateSink::SetTexture(const RenderResourceHandle& texture)
+{
+    ID3D11ShaderResourceView* srv = static_cast<ID3D11ShaderResourceView*>(texture);
+    m_context->PSSetShaderResources(0, 1, &srv);
+}
+
+void D3D11RenderStateSink::SetMaterialBuffer(const RenderResourceHandle& buffer)
+{
+    ID3D11Buffer* d3dBuffer = static_cast<ID3D11Buffer*>(buffer);
+    m_context->VSSetConstantBuffers(static_cast<UINT>(VertexCBIndex::Material), 1, &d3dBuffer);
+}
+
+void D3D11RenderStateSink::SetVertexBuffer(const RenderResourceHandle& buffer, const uint32_t& stride)
+{
+    ID3D11Buffer* d3dBuffer = static_cast<ID3D11Buffer*>(buffer);
+    UINT d3dStride = stride;
+    UINT offset = 0;
+    m_context->IASetVertexBuffers(0, 1, &d3dBuffer, &d3dStride, &offset);
+}
+
+void D3D11RenderStateSink::SetIndexBuffer(const RenderResourceHandle& buffer, const uint32_t& indexSize)
+{
+    m_context->IASetIndexBuffer(static_cast<ID3D11Buffer*>(buffer), indexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
+}
+
+void D3D11RenderStateSink::SetInstances(const uint32_t& firstInstance, const uint32_t& instancesAmount)
+{
+    if (m_context1)
+    {
+        const UINT firstConstant = firstInstance * OBJECT_CONSTANTS_IN_VECTORS;
+        const UINT constantsAmount = instancesAmount * OBJECT_CONSTANTS_IN_VECTORS;
+        m_context1->VSSetConstantBuffers1(static_cast<UINT>(VertexCBIndex::PerObject), 1, &m_objectsBuffer, &firstConstant, &constantsAmount);
+        return;
+    }
+
+    //The only instance is read from the first slot, the rest of the discarded buffer stays undefined and unread
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(m_context->Map(m_objectsBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        return;
+
+    memcpy(mapped.pData, &m_instances[firstInstance], sizeof(ObjectConstants));
+    m_context->Unmap(m_objectsBuffer, 0);
+    m_context->VSSetConstantBuffers(static_cast<UINT>(VertexCBIndex::PerObject), 1, &m_objectsBuffer);
+}
+
+void D3D11RenderStateSink::DrawIndexed(const uint32_t& indicesAmount)
+{
+    m_context->DrawIndexed(indicesAmount, 0, 0);
+}
+
+void D3D11RenderStateSink::DrawIndexedInstanced(const uint32_t& indicesAmount, const uint32_t& instancesAmount)
+{
+    m_context->DrawIndexedInstanced(indicesAmount, instancesAmount, 0, 0, 0);
+}
+
+void D3D11RenderStateSink::CreateObjectsBuffer(const uint32_t& capacity)
+{
+    D3D11_BUFFER_DESC cbbd;
+    ZeroMemory(&cbbd, sizeof(D3D11_BUFFER_DESC));
+
+    cbbd.Usage = D3D11_USAGE_DYNAMIC;
+    cbbd.ByteWidth = capacity * sizeof(ObjectConstants);
+    cbbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    cbbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    HRESULT hr = m_device->CreateBuffer(&cbbd, nullptr, &m_objectsBuffer);
+
+    if (hr != S_OK)
+        throw std::exception("Error while creating objects constant buffer");
+
+    m_objectsCapacity = capacity;
+}
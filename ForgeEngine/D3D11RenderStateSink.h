@@ -0,0 +1,47 @@
+#pragma once
+#include "IRenderStateSink.h"
+#include "ObjectConstants.h"
+
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+struct ID3D11DeviceContext1;
+struct ID3D11Buffer;
+
+//Instances the D3D11.1 objects buffer starts with, it grows to fit the draw list
+#define OBJECT_CONSTANTS_INITIAL_CAPACITY 256
+
+class D3D11RenderStateSink : public IRenderStateSink
+{
+public:
+    D3D11RenderStateSink(ID3D11Device* const& device, ID3D11DeviceContext* const& context);
+    virtual ~D3D11RenderStateSink() override;
+
+    //One upload for the whole draw list, draws bind their slices by offset.
+    //Without constant buffer offsetting every draw maps its instance into the first slot, so instances have to stay valid until the list gets submitted
+    void UploadInstancesConstants(const ObjectConstants* const& instances, const uint32_t& amount);
+    //Instancing needs bigger slices than a single one, which requires constant buffer offsetting as well
+    inline uint32_t GetMaxInstancesPerDraw() const { return m_context1 ? OBJECT_CONSTANTS_MAX_INSTANCES : 1; }
+
+    virtual void SetVertexShader(const RenderResourceHandle& shader) override;
+    virtual void SetPixelShader(const RenderResourceHandle& shader) override;
+    virtual void SetInputLayout(const RenderResourceHandle& layout) override;
+    virtual void SetTexture(const RenderResourceHandle& texture) override;
+    virtual void SetMaterialBuffer(const RenderResourceHandle& buffer) override;
+    virtual void SetVertexBuffer(const RenderResourceHandle& buffer, const uint32_t& stride) override;
+    virtual void SetIndexBuffer(const RenderResourceHandle& buffer, const uint32_t& indexSize) override;
+    virtual void SetInstances(const uint32_t& firstInstance, const uint32_t& instancesAmount) override;
+
+    virtual void DrawIndexed(const uint32_t& indicesAmount) override;
+    virtual void DrawIndexedInstanced(const uint32_t& indicesAmount, const uint32_t& instancesAmount) override;
+
+private:
+    void CreateObjectsBuffer(const uint32_t& capacity);
+
+    ID3D11Device* m_device;
+    ID3D11DeviceContext* m_context;
+    ID3D11DeviceContext1* m_context1 = nullptr;
+
+    ID3D11Buffer* m_objectsBuffer = nullptr;
+    uint32_t m_objectsCapacity = 0;
+    const ObjectConstants* m_instances = nullptr;
+};
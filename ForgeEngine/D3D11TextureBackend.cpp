@@ -0,0 +1,71 @@
+#include "D3D11TextureBackend.h"
+#include <d3d11.h>
+#include <objbase.h>
+#include <DirectXTex/DirectXTex.h>
+
+using namespace DirectX;
+
+bool WICTextureDecoder::Decode(const uint8_t* const& data, const size_t& size, DecodedTexture& texture)
+{
+    //WIC needs COM on every decoding thread, it stays initialized until the thread ends
+    static thread_local bool comInitialized = false;
+    if (!comInitialized)
+    {
+        CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        comInitialized = true;
+    }
+
+    ScratchImage image;
+    TexMetadata meta;
+
+    if (FAILED(LoadFromWICMemory(data, size, WIC_FLAGS_NONE, &meta, image)))
+        return false;
+
+    const Image* top = image.GetImage(0, 0, 0);
+    if (top == nullptr)
+        return false;
+
+    texture.Width = (uint32_t)top->width;
+    texture.Height = (uint32_t)top->height;
+    texture.Format = (uint32_t)top->format;
+    texture.RowPitch = top->rowPitch;
+    texture.Pixels.assign(top->pixels, top->pixels + top->slicePitch);
+
+    return true;
+}
+
+D3D11TextureDevice::D3D11TextureDevice(ID3D11Device* const& device)
+{
+    m_device = device;
+}
+
+TextureHandle D3D11TextureDevice::CreateTexture(const DecodedTexture& texture)
+{
+    Image image;
+    image.width = texture.Width;
+    image.height = texture.Height;
+    image.format = (DXGI_FORMAT)texture.Format;
+    image.rowPitch = texture.RowPitch;
+    image.slicePitch = texture.Pixels.size();
+    image.pixels = const_cast<uint8_t*>(texture.Pixels.data());
+
+    TexMetadata meta = {};
+    meta.width = texture.Width;
+    meta.height = texture.Height;
+    meta.depth = 1;
+    meta.arraySize = 1;
+    meta.mipLevels = 1;
+    meta.format = image.format;
+    meta.dimension = TEX_DIMENSION_TEXTURE2D;
+
+    ID3D11ShaderResourceView* srv;
+    if (FAILED(CreateShaderResourceView(m_device, &image, 1, meta, &srv)))
+        return nullptr;
+
+    return srv;
+}
+
+void D3D11TextureDevice::ReleaseTexture(const TextureHandle& texture)
+{
+    static_cast<ID3D11ShaderResourceView*>(texture)->Release();
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "ITextureBackend.h"
+
+struct ID3D11Device;
+
+//Image files WIC reads, decoded on the calling thread
+class WICTextureDecoder : public ITextureDecoder
+{
+public:
+    virtual bool Decode(const uint8_t* const& data, const size_t& size, DecodedTexture& texture) override;
+};
+
+//Handles are shader resource views of textures without mips
+class D3D11TextureDevice : public ITextureDevice
+{
+public:
+    D3D11TextureDevice(ID3D11Device* const& device);
+
+    virtual TextureHandle CreateTexture(const DecodedTexture& texture) override;
+    virtual void ReleaseTexture(const TextureHandle& texture) override;
+
+private:
+    ID3D11Device* m_device;
+};
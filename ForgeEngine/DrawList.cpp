@@ -0,0 +1,173 @@
+#include "DrawList.h"
+#include <cstring>
+
+void DrawList::Clear()
+{
+    m_commands.clear();
+    m_items.clear();
+    m_batches.clear();
+    m_instancesObjects.clear();
+}
+
+void DrawList::Add(const DrawCommand& command)
+{
+    SortItem item;
+    item.Key = CalculateKey(command);
+    item.CommandIndex = (uint32_t)m_commands.size();
+
+    m_commands.push_back(command);
+    m_items.push_back(item);
+}
+
+void DrawList::Sort()
+{
+    const int bucketsAmount = 1 << DRAW_LIST_RADIX_BITS;
+    const uint64_t mask = bucketsAmount - 1;
+
+    m_sortScratch.resize(m_items.size());
+
+    //LSD radix sort, passes where all keys share the digit are skipped
+    for (int shift = 0; shift < 64; shift += DRAW_LIST_RADIX_BITS)
+    {
+        size_t offsets[bucketsAmount];
+        memset(offsets, 0, sizeof(offsets));
+
+        for (const SortItem& item : m_items)
+            ++offsets[(item.Key >> shift) & mask];
+
+        if (m_items.empty() || offsets[(m_items[0].Key >> shift) & mask] == m_items.size())
+            continue;
+
+        size_t sum = 0;
+        for (int i = 0; i < bucketsAmount; ++i)
+        {
+            const size_t count = offsets[i];
+            offsets[i] = sum;
+            sum += count;
+        }
+
+        for (const SortItem& item : m_items)
+            m_sortScratch[offsets[(item.Key >> shift) & mask]++] = item;
+
+        m_items.swap(m_sortScratch);
+    }
+}
+
+void DrawList::BuildBatches(const uint32_t& maxInstances)
+{
+    m_batches.clear();
+    m_instancesObjects.clear();
+
+    for (const SortItem& item : m_items)
+    {
+        const DrawCommand& command = m_commands[item.CommandIndex];
+
+        if (m_batches.empty() || m_batches.back().InstancesAmount >= maxInstances || !IsInstanceOf(command, m_commands[m_batches.back().CommandIndex]))
+        {
+            DrawBatch batch;
+            batch.CommandIndex = item.CommandIndex;
+            batch.FirstInstance = (uint32_t)m_instancesObjects.size();
+            batch.InstancesAmount = 0;
+            m_batches.push_back(batch);
+        }
+
+        ++m_batches.back().InstancesAmount;
+        m_instancesObjects.push_back(command.ObjectIndex);
+    }
+}
+
+void DrawList::Submit(IRenderStateSink* const& sink)
+{
+    m_counters = { 0, 0, 0, 0, 0, 0 };
+
+    //Bindings made outside of the list are unknown, so the first draw sets everything
+    const DrawCommand* previous = nullptr;
+    RenderResourceHandle boundTexture = nullptr;
+
+    for (const DrawBatch& batch : m_batches)
+    {
+        const DrawCommand& command = m_commands[batch.CommandIndex];
+
+        if (CountStateChange(!previous || previous->VertexShader != command.VertexShader))
+            sink->SetVertexShader(command.VertexShader);
+
+        if (CountStateChange(!previous || previous->PixelShader != command.PixelShader))
+            sink->SetPixelShader(command.PixelShader);
+
+        if (CountStateChange(!previous || previous->InputLayout != command.InputLayout))
+            sink->SetInputLayout(command.InputLayout);
+
+        if (command.Texture && CountStateChange(boundTexture != command.Texture))
+        {
+            sink->SetTexture(command.Texture);
+            boundTexture = command.Texture;
+        }
+
+        if (CountStateChange(!previous || previous->MaterialBuffer != command.MaterialBuffer))
+            sink->SetMaterialBuffer(command.MaterialBuffer);
+
+        if (CountStateChange(!previous || previous->VertexBuffer != command.VertexBuffer || previous->Stride != command.Stride))
+            sink->SetVertexBuffer(command.VertexBuffer, command.Stride);
+
+        if (CountStateChange(!previous || previous->IndexBuffer != command.IndexBuffer))
+            sink->SetIndexBuffer(command.IndexBuffer, command.IndexSize);
+
+        //Every batch has its own slots
+        sink->SetInstances(batch.FirstInstance, batch.InstancesAmount);
+        ++m_counters.InstanceBindings;
+
+        if (batch.InstancesAmount > 1)
+        {
+            sink->DrawIndexedInstanced(command.IndicesAmount, batch.InstancesAmount);
+            ++m_counters.InstancedDraws;
+        }
+        else
+        {
+            sink->DrawIndexed(command.IndicesAmount);
+        }
+
+        ++m_counters.Draws;
+        m_counters.Instances += batch.InstancesAmount;
+
+        previous = &command;
+    }
+}
+
+uint64_t DrawList::CalculateKey(const DrawCommand& command)
+{
+    uint64_t key = GetID(m_vertexShaderIDs, command.VertexShader, DRAW_KEY_VS_BITS);
+    key = (key << DRAW_KEY_PS_BITS) | GetID(m_pixelShaderIDs, command.PixelShader, DRAW_KEY_PS_BITS);
+    key = (key << DRAW_KEY_LAYOUT_BITS) | GetID(m_layoutIDs, command.InputLayout, DRAW_KEY_LAYOUT_BITS);
+    key = (key << DRAW_KEY_TEXTURE_BITS) | GetID(m_textureIDs, command.Texture, DRAW_KEY_TEXTURE_BITS);
+    key = (key << DRAW_KEY_MATERIAL_BITS) | GetID(m_materialIDs, command.MaterialBuffer, DRAW_KEY_MATERIAL_BITS);
+    key = (key << DRAW_KEY_GEOMETRY_BITS) | GetID(m_geometryIDs, command.VertexBuffer, DRAW_KEY_GEOMETRY_BITS);
+
+    return key;
+}
+
+bool DrawList::IsInstanceOf(const DrawCommand& command, const DrawCommand& other)
+{
+    return command.VertexShader == other.VertexShader && command.PixelShader == other.PixelShader && command.InputLayout == other.InputLayout
+        && command.Texture == other.Texture && command.MaterialBuffer == other.MaterialBuffer && command.VertexBuffer == other.VertexBuffer
+        && command.Stride == other.Stride && command.IndexBuffer == other.IndexBuffer && command.IndicesAmount == other.IndicesAmount;
+}
+
+uint64_t DrawList::GetID(std::unordered_map<RenderResourceHandle, uint32_t>& ids, const RenderResourceHandle& handle, const int& bits)
+{
+    auto it = ids.find(handle);
+
+    if (it == ids.end())
+        it = ids.insert({ handle, (uint32_t)ids.size() }).first;
+
+    return it->second & ((1ull << bits) - 1);
+}
+
+bool DrawList::CountStateChange(const bool& changed)
+{
+    if (changed)
+        ++m_counters.StateChanges;
+    else
+        ++m_counters.SkippedStateChanges;
+
+    return changed;
+}
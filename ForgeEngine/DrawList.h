@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "IRenderStateSink.h"
+
+//Sort key layout from the most significant bits - the most expensive switches are grouped first.
+//IDs which don't fit wrap around, which only makes the order worse, bindings are still compared by handles
+#define DRAW_KEY_VS_BITS 6
+#define DRAW_KEY_PS_BITS 6
+#define DRAW_KEY_LAYOUT_BITS 8
+#define DRAW_KEY_TEXTURE_BITS 12
+#define DRAW_KEY_MATERIAL_BITS 12
+#define DRAW_KEY_GEOMETRY_BITS 20
+
+#define DRAW_LIST_RADIX_BITS 8
+
+struct DrawCommand
+{
+    RenderResourceHandle VertexShader;
+    RenderResourceHandle PixelShader;
+    RenderResourceHandle InputLayout;
+    RenderResourceHandle Texture; //nullptr keeps the bound one
+    RenderResourceHandle MaterialBuffer;
+    RenderResourceHandle VertexBuffer;
+    uint32_t Stride;
+    RenderResourceHandle IndexBuffer;
+    uint32_t IndexSize; //In bytes, the same for every use of a buffer
+    uint32_t IndicesAmount;
+    uint32_t ObjectIndex;
+};
+
+//Commands which differ only by the object are drawn as instances of the first one
+struct DrawBatch
+{
+    uint32_t CommandIndex;
+    uint32_t FirstInstance;
+    uint32_t InstancesAmount;
+};
+
+struct DrawListCounters
+{
+    uint32_t Draws;
+    uint32_t InstancedDraws;
+    uint32_t Instances;
+    //Filtered bindings only, instance slots are bound for every draw and counted apart
+    uint32_t StateChanges;
+    uint32_t SkippedStateChanges;
+    uint32_t InstanceBindings;
+};
+
+//Collects draws of a pass, sorts them by state and submits only the bindings which change
+class DrawList
+{
+public:
+    void Clear();
+    void Add(const DrawCommand& command);
+
+    //Stable - draws with equal keys keep the order they were added in
+    void Sort();
+    //Has to be called after sorting and before submitting, maxInstances of 1 disables instancing
+    void BuildBatches(const uint32_t& maxInstances);
+    void Submit(IRenderStateSink* const& sink);
+
+    inline size_t GetSize() const { return m_items.size(); }
+    inline const DrawCommand& GetCommand(const size_t& index) const { return m_commands[m_items[index].CommandIndex]; }
+    inline const std::vector<DrawBatch>& GetBatches() const { return m_batches; }
+    //Object of every instance slot, in the order the sink expects their constants
+    inline const std::vector<uint32_t>& GetInstancesObjects() const { return m_instancesObjects; }
+    inline const DrawListCounters& GetCounters() const { return m_counters; }
+
+private:
+    struct SortItem
+    {
+        uint64_t Key;
+        uint32_t CommandIndex;
+    };
+
+    uint64_t CalculateKey(const DrawCommand& command);
+    static bool IsInstanceOf(const DrawCommand& command, const DrawCommand& other);
+    static uint64_t GetID(std::unordered_map<RenderResourceHandle, uint32_t>& ids, const RenderResourceHandle& handle, const int& bits);
+    bool CountStateChange(const bool& changed);
+
+    std::vector<DrawCommand> m_commands;
+    std::vector<SortItem> m_items;
+    std::vector<SortItem> m_sortScratch;
+    std::vector<DrawBatch> m_batches;
+    std::vector<uint32_t> m_instancesObjects;
+
+    //IDs are kept between frames, so the order of equal scenes stays the same
+    std::unordered_map<RenderResourceHandle, uint32_t> m_vertexShaderIDs;
+    std::unordered_map<RenderResourceHandle, uint32_t> m_pixelShaderIDs;
+    std::unordered_map<RenderResourceHandle, uint32_t> m_layoutIDs;
+    std::unordered_map<RenderResourceHandle, uint32_t> m_textureIDs;
+    std::unordered_map<RenderResourceHandle, uint32_t> m_materialIDs;
+    std::unordered_map<RenderResourceHandle, uint32_t> m_geometryIDs;
+
+    DrawListCounters m_counters = { 0, 0, 0, 0, 0, 0 };
+};
@@ -0,0 +1,65 @@
+#include "FakeGPUTimestampSource.h"
+
+FakeGPUTimestampSource::FakeGPUTimestampSource(const int& latencyFrames, const uint64_t& frequency, const uint64_t& ticksPerTimestamp)
+{
+    m_latencyFrames = latencyFrames;
+    m_frequency = frequency;
+    m_ticksPerTimestamp = ticksPerTimestamp;
+}
+
+GPUQueryHandle FakeGPUTimestampSource::CreateQuery(const GPUQueryType& type)
+{
+    FakeQuery query;
+    query.Type = type;
+    m_queries.push_back(query);
+
+    return (GPUQueryHandle)(m_queries.size() - 1);
+}
+
+void FakeGPUTimestampSource::Begin(const GPUQueryHandle& query)
+{
+    m_queries[query].Ended = false;
+}
+
+void FakeGPUTimestampSource::End(const GPUQueryHandle& query)
+{
+    FakeQuery& fake = m_queries[query];
+    fake.Ended = true;
+    fake.EndFrame = m_currentFrame;
+    fake.Disjoint = m_disjoint;
+
+    if (fake.Type == GPUQueryType::Timestamp)
+    {
+        m_currentTimestamp += m_ticksPerTimestamp;
+        fake.Timestamp = m_currentTimestamp;
+    }
+}
+
+bool FakeGPUTimestampSource::TryGetTimestamp(const GPUQueryHandle& query, uint64_t& timestamp)
+{
+    if (!IsAvailable(m_queries[query]))
+        return false;
+
+    timestamp = m_queries[query].Timestamp;
+    return true;
+}
+
+bool FakeGPUTimestampSource::TryGetDisjoint(const GPUQueryHandle& query, uint64_t& frequency, bool& disjoint)
+{
+    if (!IsAvailable(m_queries[query]))
+        return false;
+
+    frequency = m_frequency;
+    disjoint = m_queries[query].Disjoint;
+    return true;
+}
+
+void FakeGPUTimestampSource::AdvanceFrame()
+{
+    ++m_currentFrame;
+}
+
+bool FakeGPUTimestampSource::IsAvailable(const FakeQuery& query) const
+{
+    return query.Ended && m_currentFrame - query.EndFrame >= m_latencyFrames;
+}
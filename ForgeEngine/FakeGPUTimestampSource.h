@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include "IGPUTimestampSource.h"
+
+//Results become available LatencyFrames calls of AdvanceFrame after the query ended
+class FakeGPUTimestampSource : public IGPUTimestampSource
+{
+public:
+    FakeGPUTimestampSource(const int& latencyFrames, const uint64_t& frequency, const uint64_t& ticksPerTimestamp);
+
+    virtual GPUQueryHandle CreateQuery(const GPUQueryType& type) override;
+
+    virtual void Begin(const GPUQueryHandle& query) override;
+    virtual void End(const GPUQueryHandle& query) override;
+
+    virtual bool TryGetTimestamp(const GPUQueryHandle& query, uint64_t& timestamp) override;
+    virtual bool TryGetDisjoint(const GPUQueryHandle& query, uint64_t& frequency, bool& disjoint) override;
+
+    void AdvanceFrame();
+    inline void SetLatency(const int& latencyFrames) { m_latencyFrames = latencyFrames; }
+    inline void SetDisjoint(const bool& disjoint) { m_disjoint = disjoint; }
+
+    inline size_t GetCreatedQueriesAmount() const { return m_queries.size(); }
+
+private:
+    struct FakeQuery
+    {
+        GPUQueryType Type;
+        bool Ended = false;
+        int EndFrame = 0;
+        uint64_t Timestamp = 0;
+        bool Disjoint = false;
+    };
+
+    bool IsAvailable(const FakeQuery& query) const;
+
+    std::vector<FakeQuery> m_queries;
+    int m_latencyFrames;
+    int m_currentFrame = 0;
+    uint64_t m_frequency;
+    uint64_t m_ticksPerTimestamp;
+    uint64_t m_currentTimestamp = 0;
+    bool m_disjoint = false;
+};
@@ -0,0 +1,50 @@
+#include "FakeTextureBackend.h"
+#include <cstring>
+
+bool FakeTextureDecoder::Decode(const uint8_t* const& data, const size_t& size, DecodedTexture& texture)
+{
+    if (size == 0)
+        return false;
+
+    texture.Width = (uint32_t)((size + 3) / 4);
+    texture.Height = 1;
+    texture.RowPitch = texture.Width * 4;
+    texture.Pixels.assign(texture.RowPitch, 0);
+    memcpy(texture.Pixels.data(), data, size);
+
+    ++m_decodesAmount;
+    return true;
+}
+
+TextureHandle FakeTextureDevice::CreateTexture(const DecodedTexture& texture)
+{
+    if (texture.Pixels.empty())
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    TextureHandle handle = reinterpret_cast<TextureHandle>(m_nextHandle++);
+    m_liveTextures.insert(handle);
+
+    return handle;
+}
+
+void FakeTextureDevice::ReleaseTexture(const TextureHandle& texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_liveTextures.erase(texture) == 0)
+        ++m_invalidReleasesAmount;
+}
+
+size_t FakeTextureDevice::GetLiveTexturesAmount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_liveTextures.size();
+}
+
+size_t FakeTextureDevice::GetInvalidReleasesAmount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_invalidReleasesAmount;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include "ITextureBackend.h"
+
+//Any contents decode into one row of RGBA pixels holding their bytes, so textures take as much memory as their files
+class FakeTextureDecoder : public ITextureDecoder
+{
+public:
+    FakeTextureDecoder() : m_decodesAmount(0) {}
+
+    virtual bool Decode(const uint8_t* const& data, const size_t& size, DecodedTexture& texture) override;
+
+    inline uint64_t GetDecodesAmount() const { return m_decodesAmount.load(); }
+
+private:
+    std::atomic<uint64_t> m_decodesAmount;
+};
+
+//Handles count up from 1, textures are tracked until they're released
+class FakeTextureDevice : public ITextureDevice
+{
+public:
+    virtual TextureHandle CreateTexture(const DecodedTexture& texture) override;
+    virtual void ReleaseTexture(const TextureHandle& texture) override;
+
+    size_t GetLiveTexturesAmount();
+    //Releases of handles which weren't live
+    size_t GetInvalidReleasesAmount();
+
+private:
+    std::mutex m_mutex;
+    std::unordered_set<TextureHandle> m_liveTextures;
+    uintptr_t m_nextHandle = 1;
+    size_t m_invalidReleasesAmount = 0;
+};
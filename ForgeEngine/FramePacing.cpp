@@ -0,0 +1,143 @@
+#include "FramePacing.h"
+#include <algorithm>
+#include <cstring>
+
+FramePacing::FramePacing()
+{
+    Reset();
+}
+
+bool FramePacing::AddFrame(const int& frameIndex, const int64_t& timestamp, const int64_t& frequency)
+{
+    const int64_t previous = m_lastTimestamp;
+    m_lastTimestamp = timestamp;
+
+    if (previous == 0)
+    {
+        m_firstTimestamp = timestamp;
+        return false;
+    }
+
+    m_lastInterval = (float)(1000.0 * (double)(timestamp - previous) / (double)frequency);
+
+    //Median of the frames before this one, so a hitch doesn't raise its own threshold
+    m_rollingMedian = CalculateRollingMedian();
+
+    m_intervals[m_intervalsAmount % FRAME_PACING_HISTORY] = m_lastInterval;
+    ++m_intervalsAmount;
+
+    //Timestamps can go backwards across cores on some hardware, such intervals land in the first bucket
+    const int bucket = std::max((int)(m_lastInterval / FRAME_PACING_HISTOGRAM_BUCKET_MS), 0);
+    ++m_histogram[std::min(bucket, FRAME_PACING_HISTOGRAM_BUCKETS)];
+    m_statistics.Add(1000.0 * m_lastInterval);
+
+    if (m_intervalsAmount <= FRAME_PACING_MEDIAN_WINDOW || m_lastInterval <= FRAME_PACING_STUTTER_FACTOR * m_rollingMedian)
+        return false;
+
+    ++m_hitchesAmount;
+
+    if (m_hitches.size() >= FRAME_PACING_MAX_HITCHES)
+        return false;
+
+    FrameHitch hitch;
+    hitch.FrameIndex = frameIndex;
+    hitch.TimeMs = 1000.0 * (double)(timestamp - m_firstTimestamp) / (double)frequency;
+    hitch.DurationMs = m_lastInterval;
+    hitch.MedianMs = m_rollingMedian;
+    hitch.ScopeGrowthMs = 0.0f;
+    m_hitches.push_back(hitch);
+
+    return true;
+}
+
+void FramePacing::AttributeLastHitch(const std::string& scope, const float& growthMs)
+{
+    if (m_hitches.empty())
+        return;
+
+    m_hitches.back().Scope = scope;
+    m_hitches.back().ScopeGrowthMs = growthMs;
+}
+
+void FramePacing::Reset()
+{
+    memset(m_intervals, 0, sizeof(m_intervals));
+    memset(m_histogram, 0, sizeof(m_histogram));
+    m_intervalsAmount = 0;
+    m_statistics.Reset();
+
+    m_hitches.clear();
+    m_hitchesAmount = 0;
+
+    m_firstTimestamp = 0;
+    m_lastTimestamp = 0;
+    m_lastInterval = 0.0f;
+    m_rollingMedian = 0.0f;
+}
+
+float FramePacing::CalculateRollingMedian() const
+{
+    const int amount = (int)std::min<uint64_t>(m_intervalsAmount, FRAME_PACING_MEDIAN_WINDOW);
+
+    if (amount == 0)
+        return m_lastInterval;
+
+    float window[FRAME_PACING_MEDIAN_WINDOW];
+
+    for (int i = 0; i < amount; ++i)
+        window[i] = m_intervals[(m_intervalsAmount - 1 - i) % FRAME_PACING_HISTORY];
+
+    std::nth_element(window, window + amount / 2, window + amount);
+
+    return window[amount / 2];
+}
+
+void FramePacing::WriteReport(std::ostream& out) const
+{
+    out << "{\n\"frames\":" << m_statistics.GetCount();
+    out << ",\n\"meanMs\":" << m_statistics.GetMean() / 1000.0;
+    out << ",\n\"p50Ms\":" << m_statistics.GetPercentile(50.0) / 1000.0;
+    out << ",\n\"p99Ms\":" << m_statistics.GetPercentile(99.0) / 1000.0;
+    out << ",\n\"maxMs\":" << m_statistics.GetMax() / 1000.0;
+    out << ",\n\"stutterFactor\":" << FRAME_PACING_STUTTER_FACTOR;
+    out << ",\n\"hitchesAmount\":" << m_hitchesAmount;
+
+    //Last bucket gathers everything above the histogram range
+    out << ",\n\"histogram\":{\"bucketMs\":" << FRAME_PACING_HISTOGRAM_BUCKET_MS << ",\"counts\":[";
+
+    for (int i = 0; i <= FRAME_PACING_HISTOGRAM_BUCKETS; ++i)
+        out << (i > 0 ? "," : "") << m_histogram[i];
+
+    out << "]},\n\"intervalsMs\":[";
+
+    //Last FRAME_PACING_HISTORY intervals, oldest first
+    const uint64_t first = m_intervalsAmount - std::min<uint64_t>(m_intervalsAmount, FRAME_PACING_HISTORY);
+
+    for (uint64_t i = first; i < m_intervalsAmount; ++i)
+        out << (i > first ? "," : "") << m_intervals[i % FRAME_PACING_HISTORY];
+
+    out << "],\n\"hitches\":[";
+
+    for (size_t i = 0; i < m_hitches.size(); ++i)
+    {
+        const FrameHitch& hitch = m_hitches[i];
+
+        out << (i > 0 ? ",\n" : "\n") << "{\"frame\":" << hitch.FrameIndex;
+        out << ",\"timeMs\":" << hitch.TimeMs;
+        out << ",\"durationMs\":" << hitch.DurationMs;
+        out << ",\"medianMs\":" << hitch.MedianMs;
+        out << ",\"scope\":\"";
+
+        for (const char& c : hitch.Scope)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+
+            out << c;
+        }
+
+        out << "\",\"scopeGrowthMs\":" << hitch.ScopeGrowthMs << "}";
+    }
+
+    out << "\n]\n}\n";
+}
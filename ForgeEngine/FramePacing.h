@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "StreamingStatistics.h"
+
+#define FRAME_PACING_HISTORY 4096
+#define FRAME_PACING_MEDIAN_WINDOW 63
+#define FRAME_PACING_STUTTER_FACTOR 2.0f
+#define FRAME_PACING_HISTOGRAM_BUCKET_MS 0.5f
+#define FRAME_PACING_HISTOGRAM_BUCKETS 200
+#define FRAME_PACING_MAX_HITCHES 1024
+
+struct FrameHitch
+{
+    int FrameIndex;
+    double TimeMs; //Since the last reset
+    float DurationMs;
+    float MedianMs;
+    std::string Scope; //Path of the scope which grew the most, empty if none stood out
+    float ScopeGrowthMs;
+};
+
+//Keeps frame to frame intervals and flags frames longer than FRAME_PACING_STUTTER_FACTOR times the rolling median
+class FramePacing
+{
+public:
+    FramePacing();
+
+    //Returns true if the frame is a hitch, it can be attributed right after with AttributeLastHitch
+    bool AddFrame(const int& frameIndex, const int64_t& timestamp, const int64_t& frequency);
+    void AttributeLastHitch(const std::string& scope, const float& growthMs);
+    void Reset();
+
+    inline float GetLastInterval() const { return m_lastInterval; }
+    inline float GetRollingMedian() const { return m_rollingMedian; }
+    //In microseconds
+    inline const StreamingStatistics& GetStatistics() const { return m_statistics; }
+    inline const std::vector<FrameHitch>& GetHitches() const { return m_hitches; }
+    inline uint64_t GetHitchesAmount() const { return m_hitchesAmount; }
+
+    void WriteReport(std::ostream& out) const;
+
+private:
+    float CalculateRollingMedian() const;
+
+    float m_intervals[FRAME_PACING_HISTORY];
+    uint64_t m_intervalsAmount;
+    uint32_t m_histogram[FRAME_PACING_HISTOGRAM_BUCKETS + 1];
+    StreamingStatistics m_statistics; //In microseconds
+
+    std::vector<FrameHitch> m_hitches;
+    uint64_t m_hitchesAmount;
+
+    int64_t m_firstTimestamp;
+    int64_t m_lastTimestamp;
+    float m_lastInterval;
+    float m_rollingMedian;
+};
@@ -0,0 +1,268 @@
+#include "FrustumCulling.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define FRUSTUM_CULLING_SSE
+#endif
+
+Bounds GetEmptyBounds()
+{
+    Bounds result = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, -1.0f };
+    return result;
+}
+
+Bounds CalculateBounds(const float* const& positions, const size_t& amount, const size_t& stride)
+{
+    if (amount == 0)
+        return GetEmptyBounds();
+
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (size_t i = 0; i < amount; ++i)
+    {
+        const float* position = positions + i * stride;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = fminf(min[axis], position[axis]);
+            max[axis] = fmaxf(max[axis], position[axis]);
+        }
+    }
+
+    Bounds result;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        result.Center[axis] = 0.5f * (min[axis] + max[axis]);
+        result.Extents[axis] = 0.5f * (max[axis] - min[axis]);
+    }
+
+    //Sphere around the box center, tighter than the box diagonal for most meshes
+    float radiusSquared = 0.0f;
+
+    for (size_t i = 0; i < amount; ++i)
+    {
+        const float* position = positions + i * stride;
+        const float x = position[0] - result.Center[0];
+        const float y = position[1] - result.Center[1];
+        const float z = position[2] - result.Center[2];
+
+        radiusSquared = fmaxf(radiusSquared, x * x + y * y + z * z);
+    }
+
+    result.Radius = sqrtf(radiusSquared);
+
+    return result;
+}
+
+Bounds MergeBounds(const Bounds& a, const Bounds& b)
+{
+    if (a.Radius < 0.0f)
+        return b;
+
+    if (b.Radius < 0.0f)
+        return a;
+
+    Bounds result;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float min = fminf(a.Center[axis] - a.Extents[axis], b.Center[axis] - b.Extents[axis]);
+        const float max = fmaxf(a.Center[axis] + a.Extents[axis], b.Center[axis] + b.Extents[axis]);
+
+        result.Center[axis] = 0.5f * (min + max);
+        result.Extents[axis] = 0.5f * (max - min);
+    }
+
+    //Both spheres moved to the new center stay inside of it
+    float radius = 0.0f;
+
+    for (const Bounds* bounds : { &a, &b })
+    {
+        const float x = bounds->Center[0] - result.Center[0];
+        const float y = bounds->Center[1] - result.Center[1];
+        const float z = bounds->Center[2] - result.Center[2];
+
+        radius = fmaxf(radius, sqrtf(x * x + y * y + z * z) + bounds->Radius);
+    }
+
+    result.Radius = radius;
+
+    return result;
+}
+
+Bounds TransformBounds(const Bounds& bounds, const ObjectMatrix& matrix)
+{
+    if (bounds.Radius < 0.0f)
+        return bounds;
+
+    Bounds result;
+    float maxScaleSquared = 0.0f;
+
+    for (int column = 0; column < 3; ++column)
+    {
+        result.Center[column] = matrix.M[3][column];
+        result.Extents[column] = 0.0f;
+
+        for (int row = 0; row < 3; ++row)
+        {
+            result.Center[column] += bounds.Center[row] * matrix.M[row][column];
+            result.Extents[column] += bounds.Extents[row] * fabsf(matrix.M[row][column]);
+        }
+    }
+
+    for (int row = 0; row < 3; ++row)
+        maxScaleSquared = fmaxf(maxScaleSquared, matrix.M[row][0] * matrix.M[row][0] + matrix.M[row][1] * matrix.M[row][1] + matrix.M[row][2] * matrix.M[row][2]);
+
+    result.Radius = bounds.Radius * sqrtf(maxScaleSquared);
+
+    return result;
+}
+
+void FrustumCuller::SetFrustum(const ObjectMatrix& viewProjection)
+{
+    //Clip space of D3D: -w <= x <= w, -w <= y <= w, 0 <= z <= w
+    const ObjectMatrix& m = viewProjection;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        m_planes[0][i] = m.M[i][3] + m.M[i][0];
+        m_planes[1][i] = m.M[i][3] - m.M[i][0];
+        m_planes[2][i] = m.M[i][3] + m.M[i][1];
+        m_planes[3][i] = m.M[i][3] - m.M[i][1];
+        m_planes[4][i] = m.M[i][2];
+        m_planes[5][i] = m.M[i][3] - m.M[i][2];
+    }
+
+    for (auto& plane : m_planes)
+    {
+        const float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+
+        if (length > 0.0f)
+        {
+            for (int i = 0; i < 4; ++i)
+                plane[i] /= length;
+        }
+    }
+}
+
+void FrustumCuller::Clear()
+{
+    m_size = 0;
+    m_visibleAmount = 0;
+}
+
+uint32_t FrustumCuller::Add(const Bounds& bounds, const ObjectMatrix& world)
+{
+    const Bounds worldBounds = TransformBounds(bounds, world);
+    const uint32_t index = m_size++;
+
+    if (m_centersX.size() < ((m_size + 3) & ~3u))
+    {
+        const size_t capacity = (m_size + 3) & ~3u;
+
+        m_centersX.resize(capacity);
+        m_centersY.resize(capacity);
+        m_centersZ.resize(capacity);
+        m_extentsX.resize(capacity);
+        m_extentsY.resize(capacity);
+        m_extentsZ.resize(capacity);
+        m_radiuses.resize(capacity);
+        m_visibility.resize(capacity);
+    }
+
+    m_centersX[index] = worldBounds.Center[0];
+    m_centersY[index] = worldBounds.Center[1];
+    m_centersZ[index] = worldBounds.Center[2];
+    m_extentsX[index] = worldBounds.Extents[0];
+    m_extentsY[index] = worldBounds.Extents[1];
+    m_extentsZ[index] = worldBounds.Extents[2];
+    m_radiuses[index] = worldBounds.Radius;
+
+    return index;
+}
+
+void FrustumCuller::Cull()
+{
+    const uint32_t paddedSize = (m_size + 3) & ~3u;
+
+    for (uint32_t i = m_size; i < paddedSize; ++i)
+    {
+        m_centersX[i] = m_centersY[i] = m_centersZ[i] = 0.0f;
+        m_extentsX[i] = m_extentsY[i] = m_extentsZ[i] = 0.0f;
+        m_radiuses[i] = -1.0f;
+    }
+
+    m_visibleAmount = 0;
+
+#ifdef FRUSTUM_CULLING_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 planes[6][4];
+    __m128 absPlanes[6][3];
+
+    for (int p = 0; p < 6; ++p)
+    {
+        for (int i = 0; i < 4; ++i)
+            planes[p][i] = _mm_set1_ps(m_planes[p][i]);
+
+        for (int i = 0; i < 3; ++i)
+            absPlanes[p][i] = _mm_andnot_ps(signMask, planes[p][i]);
+    }
+#endif
+
+    //Outside if the center is further behind any plane than the smaller of the box projection and the sphere radius
+    for (uint32_t i = 0; i < paddedSize; i += 4)
+    {
+#ifdef FRUSTUM_CULLING_SSE
+        const __m128 centerX = _mm_loadu_ps(&m_centersX[i]);
+        const __m128 centerY = _mm_loadu_ps(&m_centersY[i]);
+        const __m128 centerZ = _mm_loadu_ps(&m_centersZ[i]);
+        const __m128 extentX = _mm_loadu_ps(&m_extentsX[i]);
+        const __m128 extentY = _mm_loadu_ps(&m_extentsY[i]);
+        const __m128 extentZ = _mm_loadu_ps(&m_extentsZ[i]);
+        const __m128 radius = _mm_loadu_ps(&m_radiuses[i]);
+
+        __m128 outside = _mm_cmplt_ps(radius, _mm_setzero_ps());
+
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(centerX, planes[p][0]), planes[p][3]);
+            distance = _mm_add_ps(distance, _mm_mul_ps(centerY, planes[p][1]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(centerZ, planes[p][2]));
+
+            __m128 projection = _mm_mul_ps(extentX, absPlanes[p][0]);
+            projection = _mm_add_ps(projection, _mm_mul_ps(extentY, absPlanes[p][1]));
+            projection = _mm_add_ps(projection, _mm_mul_ps(extentZ, absPlanes[p][2]));
+
+            const __m128 reach = _mm_min_ps(projection, radius);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+        }
+
+        const int outsideMask = _mm_movemask_ps(outside);
+
+        for (uint32_t lane = 0; lane < 4; ++lane)
+            m_visibility[i + lane] = (uint8_t)(~outsideMask >> lane & 1);
+#else
+        for (uint32_t j = i; j < i + 4; ++j)
+        {
+            bool outside = m_radiuses[j] < 0.0f;
+
+            for (const auto& plane : m_planes)
+            {
+                const float distance = m_centersX[j] * plane[0] + m_centersY[j] * plane[1] + m_centersZ[j] * plane[2] + plane[3];
+                const float projection = m_extentsX[j] * fabsf(plane[0]) + m_extentsY[j] * fabsf(plane[1]) + m_extentsZ[j] * fabsf(plane[2]);
+
+                outside |= distance + fminf(projection, m_radiuses[j]) < 0.0f;
+            }
+
+            m_visibility[j] = outside ? 0 : 1;
+        }
+#endif
+    }
+
+    for (uint32_t i = 0; i < m_size; ++i)
+        m_visibleAmount += m_visibility[i];
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ObjectConstants.h"
+
+//Box and sphere share the center, negative radius marks bounds without any geometry
+struct Bounds
+{
+    float Center[3];
+    float Extents[3];
+    float Radius;
+};
+
+Bounds GetEmptyBounds();
+//positions are read every stride floats
+Bounds CalculateBounds(const float* const& positions, const size_t& amount, const size_t& stride);
+Bounds MergeBounds(const Bounds& a, const Bounds& b);
+//Row major matrix, row vectors - the same convention as XMMATRIX
+Bounds TransformBounds(const Bounds& bounds, const ObjectMatrix& matrix);
+
+//Tests 4 bounds per iteration against the 6 frustum planes, bounds are kept as structure of arrays
+class FrustumCuller
+{
+public:
+    void SetFrustum(const ObjectMatrix& viewProjection);
+
+    void Clear();
+    //Returns index of the bounds, empty bounds are never visible
+    uint32_t Add(const Bounds& bounds, const ObjectMatrix& world);
+    void Cull();
+
+    inline bool IsVisible(const uint32_t& index) const { return m_visibility[index] != 0; }
+    inline uint32_t GetSize() const { return m_size; }
+    inline uint32_t GetVisibleAmount() const { return m_visibleAmount; }
+
+private:
+    float m_planes[6][4];
+
+    //Padded to a multiple of 4 with bounds which are always culled
+    std::vector<float> m_centersX;
+    std::vector<float> m_centersY;
+    std::vector<float> m_centersZ;
+    std::vector<float> m_extentsX;
+    std::vector<float> m_extentsY;
+    std::vector<float> m_extentsZ;
+    std::vector<float> m_radiuses;
+    std::vector<uint8_t> m_visibility;
+
+    uint32_t m_size = 0;
+    uint32_t m_visibleAmount = 0;
+};
@@ -0,0 +1,106 @@
+#include "GPUTimestampRing.h"
+#include <cassert>
+
+GPUTimestampRing::GPUTimestampRing(IGPUTimestampSource* const& source)
+{
+    m_source = source;
+}
+
+void GPUTimestampRing::BeginFrame(const int& frameIndex, const int64_t& cpuStartTimestamp)
+{
+    assert(m_begunFrames == m_endedFrames);
+
+    if (m_begunFrames - m_oldestPendingFrame >= GPU_FRAMES_IN_FLIGHT)
+    {
+        RetireFrame(m_frames[m_oldestPendingFrame % GPU_FRAMES_IN_FLIGHT]);
+        ++m_oldestPendingFrame;
+        ++m_droppedFrames;
+    }
+
+    GPUProfilingFrame& frame = m_frames[m_begunFrames % GPU_FRAMES_IN_FLIGHT];
+    frame.Events.clear();
+    frame.FrameIndex = frameIndex;
+    frame.CPUStartTimestamp = cpuStartTimestamp;
+    frame.IsDisjoint = false;
+    frame.Frequency = 0;
+    frame.Disjoint = AcquireQuery(GPUQueryType::TimestampDisjoint);
+
+    m_source->Begin(frame.Disjoint);
+
+    ++m_begunFrames;
+}
+
+void GPUTimestampRing::EndFrame()
+{
+    assert(m_begunFrames == m_endedFrames + 1);
+
+    m_source->End(m_frames[m_endedFrames % GPU_FRAMES_IN_FLIGHT].Disjoint);
+    ++m_endedFrames;
+}
+
+void GPUTimestampRing::Record(const ProfilingScope& scope, const ProfilingEventType& type)
+{
+    assert(m_begunFrames == m_endedFrames + 1);
+
+    const GPUQueryHandle query = AcquireQuery(GPUQueryType::Timestamp);
+    m_source->End(query);
+
+    m_frames[m_endedFrames % GPU_FRAMES_IN_FLIGHT].Events.push_back({ scope.ID, type, scope.Name, (int64_t)query, false, { 0, 0 } });
+}
+
+GPUProfilingFrame* GPUTimestampRing::PopResolvedFrame()
+{
+    if (m_oldestPendingFrame == m_endedFrames)
+        return nullptr;
+
+    GPUProfilingFrame& frame = m_frames[m_oldestPendingFrame % GPU_FRAMES_IN_FLIGHT];
+
+    if (!m_source->TryGetDisjoint(frame.Disjoint, frame.Frequency, frame.IsDisjoint))
+        return nullptr;
+
+    m_readTimestamps.resize(frame.Events.size());
+
+    for (size_t i = 0; i < frame.Events.size(); ++i)
+    {
+        if (!m_source->TryGetTimestamp((GPUQueryHandle)frame.Events[i].Timestamp, m_readTimestamps[i]))
+            return nullptr;
+    }
+
+    RetireFrame(frame);
+
+    for (size_t i = 0; i < frame.Events.size(); ++i)
+        frame.Events[i].Timestamp = (int64_t)m_readTimestamps[i];
+
+    ++m_oldestPendingFrame;
+
+    return &frame;
+}
+
+int GPUTimestampRing::ConsumeDroppedFrames()
+{
+    const int dropped = m_droppedFrames;
+    m_droppedFrames = 0;
+    return dropped;
+}
+
+GPUQueryHandle GPUTimestampRing::AcquireQuery(const GPUQueryType& type)
+{
+    std::vector<GPUQueryHandle>& pool = type == GPUQueryType::Timestamp ? m_freeTimestamps : m_freeDisjoints;
+
+    if (pool.empty())
+        return m_source->CreateQuery(type);
+
+    const GPUQueryHandle query = pool.back();
+    pool.pop_back();
+    return query;
+}
+
+void GPUTimestampRing::RetireFrame(GPUProfilingFrame& frame)
+{
+    m_freeDisjoints.push_back(frame.Disjoint);
+
+    for (const ProfilingEvent& event : frame.Events)
+        m_freeTimestamps.push_back((GPUQueryHandle)event.Timestamp);
+
+    m_lastRetiredFrameIndex = frame.FrameIndex;
+}
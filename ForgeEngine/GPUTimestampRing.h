@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include "IGPUTimestampSource.h"
+#include "ProfilingEvents.h"
+
+#define GPU_FRAMES_IN_FLIGHT 8
+
+struct GPUProfilingFrame
+{
+    GPUQueryHandle Disjoint;
+    bool IsDisjoint = false;
+    uint64_t Frequency = 0;
+
+    int FrameIndex = -1;
+    int64_t CPUStartTimestamp = 0;
+
+    //Timestamp holds the query handle until the frame gets resolved
+    std::vector<ProfilingEvent> Events;
+};
+
+//Frames are harvested in submission order once all of their queries are available.
+//When the GPU falls GPU_FRAMES_IN_FLIGHT frames behind, the oldest frame gets dropped instead of stalling the CPU
+class GPUTimestampRing
+{
+public:
+    GPUTimestampRing(IGPUTimestampSource* const& source);
+
+    void BeginFrame(const int& frameIndex, const int64_t& cpuStartTimestamp);
+    void EndFrame();
+
+    void Record(const ProfilingScope& scope, const ProfilingEventType& type);
+
+    //Returned frame stays valid until the next BeginFrame
+    GPUProfilingFrame* PopResolvedFrame();
+
+    int ConsumeDroppedFrames();
+    inline int GetLastRetiredFrameIndex() const { return m_lastRetiredFrameIndex; }
+
+private:
+    GPUQueryHandle AcquireQuery(const GPUQueryType& type);
+    void RetireFrame(GPUProfilingFrame& frame);
+
+    IGPUTimestampSource* m_source;
+
+    GPUProfilingFrame m_frames[GPU_FRAMES_IN_FLIGHT];
+    uint64_t m_begunFrames = 0;
+    uint64_t m_endedFrames = 0;
+    uint64_t m_oldestPendingFrame = 0;
+
+    std::vector<GPUQueryHandle> m_freeTimestamps;
+    std::vector<GPUQueryHandle> m_freeDisjoints;
+    std::vector<uint64_t> m_readTimestamps;
+
+    int m_droppedFrames = 0;
+    int m_lastRetiredFrameIndex = -1;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+typedef uint32_t GPUQueryHandle;
+
+enum class GPUQueryType
+{
+    Timestamp,
+    TimestampDisjoint
+};
+
+//Queries are owned by the source and live until it gets destroyed, reusing them is up to the caller
+class IGPUTimestampSource
+{
+public:
+    virtual ~IGPUTimestampSource() {}
+
+    virtual GPUQueryHandle CreateQuery(const GPUQueryType& type) = 0;
+
+    virtual void Begin(const GPUQueryHandle& query) = 0;
+    virtual void End(const GPUQueryHandle& query) = 0;
+
+    //Never block, return false if the result isn't available yet
+    virtual bool TryGetTimestamp(const GPUQueryHandle& query, uint64_t& timestamp) = 0;
+    virtual bool TryGetDisjoint(const GPUQueryHandle& query, uint64_t& frequency, bool& disjoint) = 0;
+};
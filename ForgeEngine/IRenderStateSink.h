@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+//Opaque pointer to a device object (shader, layout, buffer, view), the sink knows its real type
+typedef void* RenderResourceHandle;
+
+//Receives only bindings which actually change, filtering is done by the caller
+class IRenderStateSink
+{
+public:
+    virtual ~IRenderStateSink() {}
+
+    virtual void SetVertexShader(const RenderResourceHandle& shader) = 0;
+    virtual void SetPixelShader(const RenderResourceHandle& shader) = 0;
+    virtual void SetInputLayout(const RenderResourceHandle& layout) = 0;
+    virtual void SetTexture(const RenderResourceHandle& texture) = 0;
+    virtual void SetMaterialBuffer(const RenderResourceHandle& buffer) = 0;
+    virtual void SetVertexBuffer(const RenderResourceHandle& buffer, const uint32_t& stride) = 0;
+    //Index size in bytes, 2 or 4
+    virtual void SetIndexBuffer(const RenderResourceHandle& buffer, const uint32_t& indexSize) = 0;
+    //Slots of the per instance constants uploaded for the whole list
+    virtual void SetInstances(const uint32_t& firstInstance, const uint32_t& instancesAmount) = 0;
+
+    virtual void DrawIndexed(const uint32_t& indicesAmount) = 0;
+    virtual void DrawIndexedInstanced(const uint32_t& indicesAmount, const uint32_t& instancesAmount) = 0;
+};
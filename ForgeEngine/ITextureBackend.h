@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Device resource of a texture, a shader resource view for D3D11
+typedef void* TextureHandle;
+
+//Single level of a decoded image
+struct DecodedTexture
+{
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    //Of the device, DXGI_FORMAT for D3D11
+    uint32_t Format = 0;
+    size_t RowPitch = 0;
+    std::vector<uint8_t> Pixels;
+};
+
+//Both are called from any thread
+class ITextureDecoder
+{
+public:
+    virtual ~ITextureDecoder() {}
+
+    //Contents of an image file, returns false when they can't be decoded
+    virtual bool Decode(const uint8_t* const& data, const size_t& size, DecodedTexture& texture) = 0;
+};
+
+class ITextureDevice
+{
+public:
+    virtual ~ITextureDevice() {}
+
+    //Returns nullptr when the texture can't be created
+    virtual TextureHandle CreateTexture(const DecodedTexture& texture) = 0;
+    virtual void ReleaseTexture(const TextureHandle& texture) = 0;
+};
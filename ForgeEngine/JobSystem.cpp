@@ -0,0 +1,90 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(const int& threadsAmount) : m_nextJob(0)
+{
+    int amount = threadsAmount > 0 ? threadsAmount : (int)std::thread::hardware_concurrency();
+
+    if (amount < 1)
+        amount = 1;
+
+    for (int i = 1; i < amount; ++i)
+        m_workers.emplace_back(&JobSystem::WorkerLoop, this);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+
+    m_jobsAdded.notify_all();
+
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void JobSystem::Run(const int& jobsAmount, const std::function<void(const int&)>& job)
+{
+    if (jobsAmount <= 0)
+        return;
+
+    if (m_workers.empty() || jobsAmount == 1)
+    {
+        for (int i = 0; i < jobsAmount; ++i)
+            job(i);
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_jobsAmount = jobsAmount;
+        m_nextJob = 0;
+        m_finishedWorkers = 0;
+        ++m_generation;
+    }
+
+    m_jobsAdded.notify_all();
+
+    TakeJobs();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobsFinished.wait(lock, [this]() { return m_finishedWorkers == (int)m_workers.size(); });
+
+    m_job = nullptr;
+}
+
+void JobSystem::WorkerLoop()
+{
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobsAdded.wait(lock, [this, &generation]() { return m_quit || m_generation != generation; });
+
+            if (m_quit)
+                return;
+
+            generation = m_generation;
+        }
+
+        TakeJobs();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_finishedWorkers;
+        }
+
+        m_jobsFinished.notify_one();
+    }
+}
+
+void JobSystem::TakeJobs()
+{
+    for (int i = m_nextJob++; i < m_jobsAmount; i = m_nextJob++)
+        (*m_job)(i);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed pool of worker threads running parallel for loops, the calling thread takes jobs as well
+class JobSystem
+{
+public:
+    //0 uses all hardware threads
+    JobSystem(const int& threadsAmount = 0);
+    ~JobSystem();
+
+    //Calls job for every index in <0, jobsAmount) and returns when all of them are finished
+    void Run(const int& jobsAmount, const std::function<void(const int&)>& job);
+
+    inline int GetThreadsAmount() const { return (int)m_workers.size() + 1; }
+
+private:
+    void WorkerLoop();
+    void TakeJobs();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobsAdded;
+    std::condition_variable m_jobsFinished;
+
+    const std::function<void(const int&)>* m_job = nullptr;
+    int m_jobsAmount = 0;
+    std::atomic<int> m_nextJob;
+
+    //Every worker finishes every generation, so Run never returns while a worker still looks at its job
+    uint64_t m_generation = 0;
+    int m_finishedWorkers = 0;
+    bool m_quit = false;
+};
@@ -4,6 +4,7 @@
 #include <DirectXCommonClasses/InputClass.h>
 #include "PostProcessor.h"
 #include "RenderTargetViewsManager.h"
+#include "Profiler.h"
 
 MSAAPerformer::MSAAPerformer(std::function<void(RTV*)> drawFunc, std::function<void()> initializeDepthStencilBuffFunc) : IAAPerformer(drawFunc)
 {
@@ -84,8 +85,10 @@ std::string MSAAPerformer::GetName()
 
 void MSAAPerformer::Refresh()
 {
+    Profiler::StartCPUProfiling(PROFILING_SCOPE("MSAA refresh"));
     m_temporaryRTV = Core::GetRTVsManager()->AcquireRTV(SizeType::Resolution, m_sampleAmount);
     m_initializeDepthStencilBuffFunc();
+    Profiler::EndCPUProfiling(PROFILING_SCOPE("MSAA refresh"));
 }
 
 void MSAAPerformer::SetVariant(int variantIndex)
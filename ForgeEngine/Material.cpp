@@ -3,6 +3,7 @@
 #include "Core.h"
 #include <exception>
 #include <comdef.h>
+#include <cstring>
 
 Material::Material()
 {
@@ -49,9 +50,20 @@ ID3D11InputLayout* Material::GetInputLayout()
 
 ID3D11Buffer* Material::GetConstantBufferMaterialBuffer()
 {
+    //Parameters are public, so changes are detected by comparing with the uploaded ones
+    const float octahedralNormals = OctahedralNormals ? 1.0f : 0.0f;
+    if (m_cbMaterialUploaded && memcmp(&m_cbMaterial.Diffuse, &Diffuse, sizeof(Diffuse)) == 0 && memcmp(&m_cbMaterial.Specular, &Specular, sizeof(Specular)) == 0
+        && memcmp(&m_cbMaterial.PositionScale, &PositionScale, sizeof(PositionScale)) == 0 && memcmp(&m_cbMaterial.PositionOffset, &PositionOffset, sizeof(PositionOffset)) == 0
+        && m_cbMaterial.OctahedralNormals == octahedralNormals)
+        return m_cbMaterialBuff;
+
     m_cbMaterial.Diffuse = Diffuse;
     m_cbMaterial.Specular = Specular;
+    m_cbMaterial.PositionScale = PositionScale;
+    m_cbMaterial.OctahedralNormals = octahedralNormals;
+    m_cbMaterial.PositionOffset = PositionOffset;
     Core::GetD3DeviceContext()->UpdateSubresource(m_cbMaterialBuff, 0, nullptr, &m_cbMaterial, 0, 0);
+    m_cbMaterialUploaded = true;
 
     return m_cbMaterialBuff;
 }
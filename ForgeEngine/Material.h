@@ -21,6 +21,10 @@ public:
     std::vector<D3D11_INPUT_ELEMENT_DESC> Layout;
     DirectX::XMFLOAT3 Diffuse;
     DirectX::XMFLOAT3 Specular;
+    //Vertex formats of the mesh - dequantization of positions and encoding of normals
+    DirectX::XMFLOAT3 PositionScale = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+    DirectX::XMFLOAT3 PositionOffset = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+    bool OctahedralNormals = false;
 
     const CachedShaders* GetShaders();
     ID3D11InputLayout* GetInputLayout();
@@ -34,5 +38,6 @@ private:
     
     cbMaterial m_cbMaterial;
     ID3D11Buffer* m_cbMaterialBuff;
+    bool m_cbMaterialUploaded = false;
 };
 
@@ -1,9 +1,19 @@
 #pragma once
 #include <d3d11.h>
+#include <cstdint>
+#include <vector>
 #include <DirectXMath.h>
+#include "FrustumCulling.h"
 
 class Material;
 
+//Simplified indices into the vertex buffer of the mesh
+struct MeshLOD
+{
+    UINT IndicesAmount;
+    ID3D11Buffer* IndexBuffer;
+};
+
 struct Mesh
 {
     ID3D11Buffer* VertexBuffer;
@@ -11,7 +21,19 @@ struct Mesh
 
     UINT IndicesAmount;
     ID3D11Buffer* IndexBuffer;
+    //In bytes, LODs use the same
+    UINT IndexSize;
+
+    //LOD 1 and further, LOD 0 are the indices above
+    std::vector<MeshLOD> LODs;
 
     Material* Material;
+
+    //In the model space
+    Bounds Bounds;
+
+    //Kept on the CPU for occlusion culling, triangles only
+    std::vector<float> Positions;
+    std::vector<uint32_t> Indices;
 };
 
@@ -0,0 +1,518 @@
+#include "MeshLODs.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+//Borders and seams weigh this much more than surfaces of the same size
+#define EDGE_CONSTRAINT_WEIGHT 10.0
+//Vertices with more attribute variants than this around them are never collapsed
+#define MAX_WEDGES 8
+
+namespace
+{
+    //Symmetric 4x4 matrix - xx, xy, xz, xw, yy, yz, yw, zz, zw, ww
+    struct Quadric
+    {
+        double A[10];
+    };
+
+    struct Collapse
+    {
+        uint32_t From;
+        uint32_t To;
+        double Cost;
+    };
+
+    void AddPlane(Quadric& quadric, const double (&normal)[3], const double& distance, const double& weight)
+    {
+        const double plane[4] = { normal[0], normal[1], normal[2], distance };
+        int index = 0;
+
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = r; c < 4; ++c)
+                quadric.A[index++] += plane[r] * plane[c] * weight;
+        }
+    }
+
+    double Evaluate(const Quadric& a, const Quadric& b, const float* const& position)
+    {
+        double q[10];
+        for (int i = 0; i < 10; ++i)
+            q[i] = a.A[i] + b.A[i];
+
+        const double x = position[0];
+        const double y = position[1];
+        const double z = position[2];
+
+        const double error = q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+            + q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+            + q[7] * z * z + 2.0 * q[8] * z
+            + q[9];
+
+        return std::max(error, 0.0);
+    }
+
+    void GetNormal(const float* const& a, const float* const& b, const float* const& c, double (&normal)[3])
+    {
+        const double ab[3] = { (double)b[0] - a[0], (double)b[1] - a[1], (double)b[2] - a[2] };
+        const double ac[3] = { (double)c[0] - a[0], (double)c[1] - a[1], (double)c[2] - a[2] };
+
+        normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+        normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+        normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+    }
+
+    double Normalize(double (&vector)[3])
+    {
+        const double length = sqrt(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+
+        if (length > 0.0)
+        {
+            for (int c = 0; c < 3; ++c)
+                vector[c] /= length;
+        }
+
+        return length;
+    }
+
+    inline uint64_t GetEdgeKey(const uint32_t& a, const uint32_t& b)
+    {
+        return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+    }
+}
+
+bool SimplifyMesh(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const uint32_t* const& indices, const size_t& indicesAmount,
+    const size_t& targetIndicesAmount, std::vector<uint32_t>& output)
+{
+    auto getVertex = [&](const uint32_t& vertex) { return vertices + vertex * stride; };
+
+    auto getAttributesDistance = [&](const uint32_t& a, const uint32_t& b)
+    {
+        const float* va = getVertex(a);
+        const float* vb = getVertex(b);
+        double distance = 0.0;
+
+        for (size_t i = 3; i < stride; ++i)
+            distance += ((double)va[i] - vb[i]) * ((double)va[i] - vb[i]);
+
+        return distance;
+    };
+
+    //Sorted by position and then by the rest of attributes, so equal vertices end up next to each other
+    std::vector<uint32_t> order(verticesAmount);
+    for (size_t i = 0; i < verticesAmount; ++i)
+        order[i] = (uint32_t)i;
+
+    std::sort(order.begin(), order.end(), [&](const uint32_t& a, const uint32_t& b)
+    {
+        const float* va = getVertex(a);
+        const float* vb = getVertex(b);
+
+        for (size_t i = 0; i < stride; ++i)
+        {
+            if (va[i] != vb[i])
+                return va[i] < vb[i];
+        }
+
+        return a < b;
+    });
+
+    //Both are represented by the first original vertex. Equal ones are merged into wedges, welded ones share a position and the topology
+    std::vector<uint32_t> wedges(verticesAmount);
+    std::vector<uint32_t> welded(verticesAmount);
+
+    for (size_t i = 0; i < verticesAmount; ++i)
+    {
+        const float* vertex = getVertex(order[i]);
+        const float* previous = i > 0 ? getVertex(order[i - 1]) : nullptr;
+        const bool samePosition = previous != nullptr && previous[0] == vertex[0] && previous[1] == vertex[1] && previous[2] == vertex[2];
+        bool sameVertex = samePosition;
+
+        for (size_t c = 3; c < stride && sameVertex; ++c)
+            sameVertex = previous[c] == vertex[c];
+
+        wedges[order[i]] = sameVertex ? wedges[order[i - 1]] : order[i];
+        welded[order[i]] = samePosition ? welded[order[i - 1]] : order[i];
+    }
+
+    //Corners keep wedges, triangles the welded vertices
+    std::vector<uint32_t> corners;
+    std::vector<uint32_t> triangles;
+    corners.reserve(indicesAmount);
+    triangles.reserve(indicesAmount);
+
+    for (size_t i = 0; i + 2 < indicesAmount; i += 3)
+    {
+        if (indices[i] >= verticesAmount || indices[i + 1] >= verticesAmount || indices[i + 2] >= verticesAmount)
+            continue;
+
+        const uint32_t a = welded[indices[i]];
+        const uint32_t b = welded[indices[i + 1]];
+        const uint32_t c = welded[indices[i + 2]];
+
+        if (a == b || b == c || a == c)
+            continue;
+
+        corners.insert(corners.end(), { wedges[indices[i]], wedges[indices[i + 1]], wedges[indices[i + 2]] });
+        triangles.insert(triangles.end(), { a, b, c });
+    }
+
+    const size_t trianglesAmount = triangles.size() / 3;
+    std::vector<uint8_t> alive(trianglesAmount, 1);
+    size_t aliveAmount = trianglesAmount;
+
+    std::vector<Quadric> quadrics(verticesAmount);
+    memset(quadrics.data(), 0, sizeof(Quadric) * verticesAmount);
+
+    std::vector<double> normals(trianglesAmount * 3);
+
+    for (size_t t = 0; t < trianglesAmount; ++t)
+    {
+        const float* p0 = getVertex(triangles[t * 3]);
+        double normal[3];
+        GetNormal(p0, getVertex(triangles[t * 3 + 1]), getVertex(triangles[t * 3 + 2]), normal);
+
+        //Weighted by the area
+        const double area = Normalize(normal) * 0.5;
+        const double distance = -(normal[0] * p0[0] + normal[1] * p0[1] + normal[2] * p0[2]);
+        memcpy(&normals[t * 3], normal, sizeof(normal));
+
+        for (int c = 0; c < 3; ++c)
+            AddPlane(quadrics[triangles[t * 3 + c]], normal, distance, area);
+    }
+
+    //Edges used by one triangle are borders, by more than two non manifold. Edges where wedges of both triangles differ are seams
+    std::vector<std::pair<uint64_t, uint32_t>> edges;
+    std::vector<uint8_t> locked(verticesAmount, 0);
+    std::vector<uint8_t> border(verticesAmount, 0);
+    edges.reserve(triangles.size());
+
+    for (size_t t = 0; t < trianglesAmount; ++t)
+    {
+        for (int e = 0; e < 3; ++e)
+            edges.push_back({ GetEdgeKey(triangles[t * 3 + e], triangles[t * 3 + (e + 1) % 3]), (uint32_t)(t * 3 + e) });
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    auto constrainEdge = [&](const uint32_t& corner)
+    {
+        const uint32_t t = corner / 3;
+        const uint32_t a = triangles[corner];
+        const uint32_t b = triangles[t * 3 + (corner + 1) % 3];
+        const float* pa = getVertex(a);
+        const float* pb = getVertex(b);
+
+        double direction[3] = { (double)pb[0] - pa[0], (double)pb[1] - pa[1], (double)pb[2] - pa[2] };
+        const double length = Normalize(direction);
+        const double* faceNormal = &normals[t * 3];
+
+        //Perpendicular to the triangle through the edge, so the edge keeps its place
+        double normal[3] = {
+            direction[1] * faceNormal[2] - direction[2] * faceNormal[1],
+            direction[2] * faceNormal[0] - direction[0] * faceNormal[2],
+            direction[0] * faceNormal[1] - direction[1] * faceNormal[0] };
+        Normalize(normal);
+
+        const double distance = -(normal[0] * pa[0] + normal[1] * pa[1] + normal[2] * pa[2]);
+        AddPlane(quadrics[a], normal, distance, length * length * EDGE_CONSTRAINT_WEIGHT);
+        AddPlane(quadrics[b], normal, distance, length * length * EDGE_CONSTRAINT_WEIGHT);
+    };
+
+    for (size_t i = 0; i < edges.size(); )
+    {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j].first == edges[i].first)
+            ++j;
+
+        const uint32_t a = (uint32_t)(edges[i].first >> 32);
+        const uint32_t b = (uint32_t)edges[i].first;
+
+        if (j - i == 1)
+        {
+            border[a] = 1;
+            border[b] = 1;
+            constrainEdge(edges[i].second);
+        }
+        else if (j - i == 2)
+        {
+            const uint32_t first = edges[i].second;
+            const uint32_t second = edges[i + 1].second;
+            const uint32_t firstNext = first / 3 * 3 + (first + 1) % 3;
+            const uint32_t secondNext = second / 3 * 3 + (second + 1) % 3;
+
+            //Both triangles run the edge in opposite directions when they are consistently wound
+            const bool opposite = triangles[first] == triangles[secondNext];
+            const bool sameWedges = opposite
+                ? corners[first] == corners[secondNext] && corners[firstNext] == corners[second]
+                : corners[first] == corners[second] && corners[firstNext] == corners[secondNext];
+
+            if (!sameWedges)
+            {
+                constrainEdge(first);
+                constrainEdge(second);
+            }
+        }
+        else
+        {
+            locked[a] = 1;
+            locked[b] = 1;
+        }
+
+        i = j;
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(verticesAmount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint32_t> filled;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> touched(verticesAmount);
+
+    //Every pass collapses the cheapest edges whose neighbourhoods don't overlap, then costs are gathered again
+    while (aliveAmount * 3 > targetIndicesAmount)
+    {
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+        for (size_t t = 0; t < trianglesAmount; ++t)
+        {
+            if (alive[t])
+            {
+                for (int c = 0; c < 3; ++c)
+                    ++adjacencyOffsets[triangles[t * 3 + c] + 1];
+            }
+        }
+
+        for (size_t i = 0; i < verticesAmount; ++i)
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+        adjacency.resize(adjacencyOffsets[verticesAmount]);
+        filled.assign(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        collapses.clear();
+
+        for (size_t t = 0; t < trianglesAmount; ++t)
+        {
+            if (!alive[t])
+                continue;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                const uint32_t a = triangles[t * 3 + c];
+                const uint32_t b = triangles[t * 3 + (c + 1) % 3];
+
+                adjacency[filled[a]++] = (uint32_t)t;
+
+                if (!locked[a])
+                    collapses.push_back({ a, b, Evaluate(quadrics[a], quadrics[b], getVertex(b)) });
+                if (!locked[b])
+                    collapses.push_back({ b, a, Evaluate(quadrics[a], quadrics[b], getVertex(a)) });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t appliedAmount = 0;
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (aliveAmount * 3 <= targetIndicesAmount)
+                break;
+
+            if (touched[collapse.From] || touched[collapse.To])
+                continue;
+
+            //Triangles dying with the edge map wedges of the collapsed vertex to wedges of the kept one, the rest of triangles can't flip
+            uint32_t wedgesFrom[MAX_WEDGES];
+            uint32_t wedgesTo[MAX_WEDGES];
+            int wedgesAmount = 0;
+            int dyingAmount = 0;
+            bool valid = true;
+
+            for (uint32_t i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1] && valid; ++i)
+            {
+                const uint32_t t = adjacency[i];
+                int fromCorner = 0;
+                int toCorner = -1;
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    if (triangles[t * 3 + c] == collapse.From)
+                        fromCorner = c;
+                    else if (triangles[t * 3 + c] == collapse.To)
+                        toCorner = c;
+                }
+
+                if (toCorner < 0)
+                    continue;
+
+                ++dyingAmount;
+
+                const uint32_t from = corners[t * 3 + fromCorner];
+                const uint32_t to = corners[t * 3 + toCorner];
+                int w = 0;
+
+                while (w < wedgesAmount && wedgesFrom[w] != from)
+                    ++w;
+
+                if (w == wedgesAmount)
+                {
+                    if (wedgesAmount == MAX_WEDGES)
+                        valid = false;
+                    else
+                    {
+                        wedgesFrom[wedgesAmount] = from;
+                        wedgesTo[wedgesAmount++] = to;
+                    }
+                }
+                else
+                    valid = wedgesTo[w] == to;
+            }
+
+            //Borders can only slide along themselves
+            if (!valid || dyingAmount == 0 || (border[collapse.From] && dyingAmount != 1))
+                continue;
+
+            for (uint32_t i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1] && valid; ++i)
+            {
+                const uint32_t t = adjacency[i];
+                const uint32_t* triangle = &triangles[t * 3];
+
+                if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+                    continue;
+
+                const int fromCorner = triangle[0] == collapse.From ? 0 : (triangle[1] == collapse.From ? 1 : 2);
+                const uint32_t from = corners[t * 3 + fromCorner];
+                int w = 0;
+
+                while (w < wedgesAmount && wedgesFrom[w] != from)
+                    ++w;
+
+                //Wedges not on the edge, like flat shaded faces, take the closest attributes the kept vertex has
+                if (w == wedgesAmount && wedgesAmount < MAX_WEDGES)
+                {
+                    uint32_t closest = UINT32_MAX;
+                    double closestDistance = DBL_MAX;
+
+                    for (uint32_t j = adjacencyOffsets[collapse.To]; j < adjacencyOffsets[collapse.To + 1]; ++j)
+                    {
+                        const uint32_t other = adjacency[j];
+                        const int toCorner = triangles[other * 3] == collapse.To ? 0 : (triangles[other * 3 + 1] == collapse.To ? 1 : 2);
+                        const uint32_t candidate = corners[other * 3 + toCorner];
+                        const double distance = getAttributesDistance(from, candidate);
+
+                        if (distance < closestDistance)
+                        {
+                            closest = candidate;
+                            closestDistance = distance;
+                        }
+                    }
+
+                    wedgesFrom[wedgesAmount] = from;
+                    wedgesTo[wedgesAmount++] = closest;
+                }
+
+                const float* before[3] = { getVertex(triangle[0]), getVertex(triangle[1]), getVertex(triangle[2]) };
+                const float* after[3] = { before[0], before[1], before[2] };
+                after[fromCorner] = getVertex(collapse.To);
+
+                double normalBefore[3];
+                double normalAfter[3];
+                GetNormal(before[0], before[1], before[2], normalBefore);
+                GetNormal(after[0], after[1], after[2], normalAfter);
+
+                valid = w < wedgesAmount && wedgesTo[w] != UINT32_MAX && normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] + normalBefore[2] * normalAfter[2] > 0.0;
+            }
+
+            if (!valid)
+                continue;
+
+            for (uint32_t i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1]; ++i)
+            {
+                const uint32_t t = adjacency[i];
+                uint32_t* triangle = &triangles[t * 3];
+
+                for (int c = 0; c < 3; ++c)
+                    touched[triangle[c]] = 1;
+
+                if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+                {
+                    alive[t] = 0;
+                    --aliveAmount;
+                    continue;
+                }
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    if (triangle[c] != collapse.From)
+                        continue;
+
+                    int w = 0;
+                    while (wedgesFrom[w] != corners[t * 3 + c])
+                        ++w;
+
+                    triangle[c] = collapse.To;
+                    corners[t * 3 + c] = wedgesTo[w];
+                }
+            }
+
+            for (int i = 0; i < 10; ++i)
+                quadrics[collapse.To].A[i] += quadrics[collapse.From].A[i];
+
+            ++appliedAmount;
+        }
+
+        if (appliedAmount == 0)
+            break;
+    }
+
+    output.clear();
+    output.reserve(aliveAmount * 3);
+
+    for (size_t t = 0; t < trianglesAmount; ++t)
+    {
+        if (alive[t])
+            output.insert(output.end(), { corners[t * 3], corners[t * 3 + 1], corners[t * 3 + 2] });
+    }
+
+    return output.size() <= targetIndicesAmount;
+}
+
+void GenerateLODs(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const uint32_t* const& indices, const size_t& indicesAmount,
+    std::vector<std::vector<uint32_t>>& lods)
+{
+    lods.clear();
+
+    const uint32_t* source = indices;
+    size_t sourceAmount = indicesAmount;
+
+    for (int lod = 0; lod < MESH_LODS_AMOUNT; ++lod)
+    {
+        const size_t target = (size_t)(sourceAmount / 3 * MESH_LOD_REDUCTION) * 3;
+        std::vector<uint32_t> simplified;
+        SimplifyMesh(vertices, verticesAmount, stride, source, sourceAmount, target, simplified);
+
+        if (simplified.empty() || simplified.size() > sourceAmount * MESH_LOD_MIN_REDUCTION)
+            break;
+
+        lods.push_back(std::move(simplified));
+        source = lods.back().data();
+        sourceAmount = lods.back().size();
+    }
+}
+
+int SelectLOD(const float& screenSize, const int& currentLOD, const int& lodsAmount)
+{
+    auto getSwitchSize = [](const int& lod) { return MESH_LOD_SCREEN_SIZE * powf(0.5f, (float)(lod - 1)); };
+
+    int lod = std::min(std::max(currentLOD, 0), lodsAmount);
+
+    while (lod < lodsAmount && screenSize < getSwitchSize(lod + 1) * (1.0f - MESH_LOD_HYSTERESIS))
+        ++lod;
+
+    while (lod > 0 && screenSize > getSwitchSize(lod) * (1.0f + MESH_LOD_HYSTERESIS))
+        --lod;
+
+    return lod;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Simplified versions generated for every mesh, beside the full detail one
+#define MESH_LODS_AMOUNT 3
+//Every LOD targets this part of the previous one's triangles
+#define MESH_LOD_REDUCTION 0.5f
+//LODs which can't get below this part of the previous one are dropped, with the rest of the chain
+#define MESH_LOD_MIN_REDUCTION 0.9f
+//LOD 1 is used below this part of the screen height, every next LOD at half of the previous size
+#define MESH_LOD_SCREEN_SIZE 0.25f
+//Part of the switching size a renderer has to cross before its LOD changes back
+#define MESH_LOD_HYSTERESIS 0.1f
+
+//Quadric error metric simplification with half edge collapses only, so simplified indices keep using the vertex buffer of the mesh.
+//Vertices are read every stride floats with the position first. Equal vertices are merged and ones sharing a position are welded for the topology.
+//Attribute seams and borders only collapse along themselves, non manifold edges never. Returns false when the target couldn't be reached
+bool SimplifyMesh(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const uint32_t* const& indices, const size_t& indicesAmount,
+    const size_t& targetIndicesAmount, std::vector<uint32_t>& output);
+
+//Every LOD is simplified from the previous one, the chain ends early when simplification stops paying off
+void GenerateLODs(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const uint32_t* const& indices, const size_t& indicesAmount,
+    std::vector<std::vector<uint32_t>>& lods);
+
+//screenSize is the part of the screen height covered by the bounds, LOD 0 is the full detail mesh
+int SelectLOD(const float& screenSize, const int& currentLOD, const int& lodsAmount);
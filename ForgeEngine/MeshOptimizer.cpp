@@ -0,0 +1,269 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//Forsyth's scoring, vertices used last get a fixed score so triangles aren't split between them
+#define CACHE_DECAY_POWER 1.5f
+#define LAST_TRIANGLE_SCORE 0.75f
+#define VALENCE_BOOST_SCALE 2.0f
+#define VALENCE_BOOST_POWER 0.5f
+//Vertices used by more triangles than this score the same
+#define MAX_SCORED_VALENCE 32
+
+namespace
+{
+    inline uint32_t HashVertex(const float* const& vertex, const size_t& stride)
+    {
+        uint32_t hash = 2166136261u;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(vertex);
+
+        for (size_t i = 0; i < stride * sizeof(float); ++i)
+            hash = (hash ^ bytes[i]) * 16777619u;
+
+        return hash;
+    }
+
+    float GetVertexScore(const int& cachePosition, const uint32_t& remainingValence, const float (&cacheScores)[VERTEX_CACHE_OPTIMIZATION_SIZE], const float (&valenceScores)[MAX_SCORED_VALENCE + 1])
+    {
+        //No triangles left to emit
+        if (remainingValence == 0)
+            return -1.0f;
+
+        const float cacheScore = cachePosition >= 0 ? cacheScores[cachePosition] : 0.0f;
+        return cacheScore + valenceScores[std::min(remainingValence, (uint32_t)MAX_SCORED_VALENCE)];
+    }
+}
+
+size_t WeldVertices(std::vector<float>& vertices, const size_t& stride, std::vector<uint32_t>& indices)
+{
+    const size_t verticesAmount = stride > 0 ? vertices.size() / stride : 0;
+
+    size_t tableSize = 1;
+    while (tableSize < verticesAmount * 2)
+        tableSize *= 2;
+
+    //Open addressing, every slot keeps the unique vertex of its hash
+    std::vector<uint32_t> table(tableSize, UINT32_MAX);
+    std::vector<uint32_t> remap(verticesAmount);
+    size_t uniqueAmount = 0;
+
+    for (size_t v = 0; v < verticesAmount; ++v)
+    {
+        const float* vertex = &vertices[v * stride];
+        size_t slot = HashVertex(vertex, stride) & (tableSize - 1);
+
+        while (table[slot] != UINT32_MAX && memcmp(&vertices[table[slot] * stride], vertex, stride * sizeof(float)) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+
+        if (table[slot] == UINT32_MAX)
+        {
+            //Unique vertices are compacted in place, never past the ones still read
+            if (uniqueAmount != v)
+                memmove(&vertices[uniqueAmount * stride], vertex, stride * sizeof(float));
+
+            table[slot] = (uint32_t)uniqueAmount++;
+        }
+
+        remap[v] = table[slot];
+    }
+
+    vertices.resize(uniqueAmount * stride);
+
+    for (uint32_t& index : indices)
+        index = remap[index];
+
+    return uniqueAmount;
+}
+
+void OptimizeVertexCache(const uint32_t* const& indices, const size_t& indicesAmount, const size_t& verticesAmount, uint32_t* const& output)
+{
+    const size_t trianglesAmount = indicesAmount / 3;
+
+    float cacheScores[VERTEX_CACHE_OPTIMIZATION_SIZE];
+    for (int i = 0; i < VERTEX_CACHE_OPTIMIZATION_SIZE; ++i)
+    {
+        cacheScores[i] = i < 3 ? LAST_TRIANGLE_SCORE
+            : powf(1.0f - (float)(i - 3) / (VERTEX_CACHE_OPTIMIZATION_SIZE - 3), CACHE_DECAY_POWER);
+    }
+
+    //Vertices with few triangles left are preferred, so no lone triangles are left behind
+    float valenceScores[MAX_SCORED_VALENCE + 1];
+    valenceScores[0] = 0.0f;
+    for (int i = 1; i <= MAX_SCORED_VALENCE; ++i)
+        valenceScores[i] = VALENCE_BOOST_SCALE * powf((float)i, -VALENCE_BOOST_POWER);
+
+    //Triangles of every vertex, emitted ones are swapped past the remaining valence
+    std::vector<uint32_t> offsets(verticesAmount + 1, 0);
+    for (size_t i = 0; i < trianglesAmount * 3; ++i)
+        ++offsets[indices[i] + 1];
+
+    for (size_t v = 0; v < verticesAmount; ++v)
+        offsets[v + 1] += offsets[v];
+
+    std::vector<uint32_t> adjacency(trianglesAmount * 3);
+    std::vector<uint32_t> remainingValence(verticesAmount, 0);
+
+    for (size_t t = 0; t < trianglesAmount; ++t)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            const uint32_t vertex = indices[t * 3 + c];
+            adjacency[offsets[vertex] + remainingValence[vertex]++] = (uint32_t)t;
+        }
+    }
+
+    std::vector<int> cachePositions(verticesAmount, -1);
+    std::vector<float> vertexScores(verticesAmount);
+    for (size_t v = 0; v < verticesAmount; ++v)
+        vertexScores[v] = GetVertexScore(-1, remainingValence[v], cacheScores, valenceScores);
+
+    std::vector<float> triangleScores(trianglesAmount);
+    std::vector<uint8_t> emitted(trianglesAmount, 0);
+    for (size_t t = 0; t < trianglesAmount; ++t)
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+    //Three more slots for vertices pushed out by the new triangle
+    uint32_t cache[VERTEX_CACHE_OPTIMIZATION_SIZE + 3];
+    int cacheAmount = 0;
+    size_t outputAmount = 0;
+    size_t nextCandidate = 0;
+
+    uint32_t best = UINT32_MAX;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < trianglesAmount; ++t)
+    {
+        if (triangleScores[t] > bestScore)
+        {
+            best = (uint32_t)t;
+            bestScore = triangleScores[t];
+        }
+    }
+
+    while (best != UINT32_MAX)
+    {
+        const uint32_t* triangle = &indices[best * 3];
+        memcpy(&output[outputAmount], triangle, sizeof(uint32_t) * 3);
+        outputAmount += 3;
+        emitted[best] = 1;
+
+        //Vertices of the triangle move to the front, the rest keep their order
+        uint32_t newCache[VERTEX_CACHE_OPTIMIZATION_SIZE + 3];
+        int newCacheAmount = 0;
+
+        for (int c = 0; c < 3; ++c)
+        {
+            newCache[newCacheAmount++] = triangle[c];
+
+            //Removed from the remaining triangles of the vertex
+            const uint32_t vertex = triangle[c];
+            uint32_t* triangles = &adjacency[offsets[vertex]];
+            for (uint32_t i = 0; i < remainingValence[vertex]; ++i)
+            {
+                if (triangles[i] == best)
+                {
+                    std::swap(triangles[i], triangles[remainingValence[vertex] - 1]);
+                    break;
+                }
+            }
+            --remainingValence[vertex];
+        }
+
+        for (int i = 0; i < cacheAmount; ++i)
+        {
+            const uint32_t vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                newCache[newCacheAmount++] = vertex;
+        }
+
+        for (int i = 0; i < newCacheAmount; ++i)
+            cachePositions[newCache[i]] = i < VERTEX_CACHE_OPTIMIZATION_SIZE ? i : -1;
+
+        cacheAmount = std::min(newCacheAmount, VERTEX_CACHE_OPTIMIZATION_SIZE);
+        memcpy(cache, newCache, sizeof(uint32_t) * cacheAmount);
+
+        //Only triangles of vertices which were or are in the cache change their scores
+        best = UINT32_MAX;
+        bestScore = -1.0f;
+
+        for (int i = 0; i < newCacheAmount; ++i)
+        {
+            const uint32_t vertex = newCache[i];
+            const float score = GetVertexScore(cachePositions[vertex], remainingValence[vertex], cacheScores, valenceScores);
+            const float delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+
+            const uint32_t* triangles = &adjacency[offsets[vertex]];
+            for (uint32_t j = 0; j < remainingValence[vertex]; ++j)
+            {
+                const uint32_t t = triangles[j];
+                triangleScores[t] += delta;
+
+                if (triangleScores[t] > bestScore)
+                {
+                    best = t;
+                    bestScore = triangleScores[t];
+                }
+            }
+        }
+
+        //The cache ran dry, the next triangle not emitted yet starts over
+        if (best == UINT32_MAX)
+        {
+            while (nextCandidate < trianglesAmount && emitted[nextCandidate])
+                ++nextCandidate;
+
+            if (nextCandidate < trianglesAmount)
+                best = (uint32_t)nextCandidate;
+        }
+    }
+}
+
+size_t OptimizeVertexFetch(std::vector<float>& vertices, const size_t& stride, std::vector<uint32_t>& indices)
+{
+    const size_t verticesAmount = stride > 0 ? vertices.size() / stride : 0;
+    std::vector<uint32_t> remap(verticesAmount, UINT32_MAX);
+    std::vector<float> reordered;
+    reordered.reserve(vertices.size());
+
+    uint32_t nextVertex = 0;
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = nextVertex++;
+            reordered.insert(reordered.end(), vertices.begin() + index * stride, vertices.begin() + (index + 1) * stride);
+        }
+
+        index = remap[index];
+    }
+
+    vertices.swap(reordered);
+    return nextVertex;
+}
+
+VertexCacheStatistics AnalyzeVertexCache(const uint32_t* const& indices, const size_t& indicesAmount, const size_t& verticesAmount, const int& cacheSize)
+{
+    //FIFO, a vertex is in the cache when it was transformed less than cacheSize transforms ago
+    std::vector<size_t> transformTimes(verticesAmount, 0);
+    std::vector<uint8_t> used(verticesAmount, 0);
+    size_t transformsAmount = 0;
+    size_t usedAmount = 0;
+
+    for (size_t i = 0; i < indicesAmount; ++i)
+    {
+        const uint32_t vertex = indices[i];
+
+        if (transformTimes[vertex] == 0 || transformsAmount - transformTimes[vertex] >= (size_t)cacheSize)
+            transformTimes[vertex] = ++transformsAmount;
+
+        usedAmount += used[vertex] == 0 ? 1 : 0;
+        used[vertex] = 1;
+    }
+
+    VertexCacheStatistics statistics;
+    statistics.ACMR = indicesAmount >= 3 ? (float)transformsAmount / (indicesAmount / 3) : 0.0f;
+    statistics.ATVR = usedAmount > 0 ? (float)transformsAmount / usedAmount : 0.0f;
+
+    return statistics;
+}
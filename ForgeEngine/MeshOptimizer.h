@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Size of the cache vertex cache optimization scores vertices for
+#define VERTEX_CACHE_OPTIMIZATION_SIZE 32
+//FIFO cache statistics are simulated with, a conservative size for current GPUs
+#define VERTEX_CACHE_ANALYSIS_SIZE 16
+
+struct VertexCacheStatistics
+{
+    //Transformed vertices per triangle, 0.5 at best and 3 at worst
+    float ACMR;
+    //Transformed vertices per used vertex, 1 at best
+    float ATVR;
+};
+
+//Merges vertices whose stride floats are all equal, vertices become the unique ones in the order of first use. Returns the amount of unique vertices
+size_t WeldVertices(std::vector<float>& vertices, const size_t& stride, std::vector<uint32_t>& indices);
+
+//Reorders triangles for the post transform cache with Forsyth's linear speed algorithm, output can't be indices
+void OptimizeVertexCache(const uint32_t* const& indices, const size_t& indicesAmount, const size_t& verticesAmount, uint32_t* const& output);
+
+//Reorders vertices in the order indices first use them, so they are fetched sequentially. Unused vertices are dropped, returns the amount of vertices left
+size_t OptimizeVertexFetch(std::vector<float>& vertices, const size_t& stride, std::vector<uint32_t>& indices);
+
+VertexCacheStatistics AnalyzeVertexCache(const uint32_t* const& indices, const size_t& indicesAmount, const size_t& verticesAmount, const int& cacheSize = VERTEX_CACHE_ANALYSIS_SIZE);
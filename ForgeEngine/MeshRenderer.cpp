@@ -15,4 +15,5 @@ MeshRenderer::MeshRenderer(Object* const& owner, const Model* const& model, cons
 
 MeshRenderer::~MeshRenderer()
 {
+    Core::GetRenderingSystem()->RemoveMeshRenderer(this);
 }
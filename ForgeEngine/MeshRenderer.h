@@ -18,8 +18,12 @@ public:
     ~MeshRenderer();
 
     DirectX::XMMATRIX PrevWVP;
+    //Kept between frames for the hysteresis
+    int LOD = 0;
 
 private:
-    const std::vector<const Mesh*>* m_meshes;
+    //Set once the model is loaded
+    const std::vector<const Mesh*>* m_meshes = nullptr;
+    const Bounds* m_bounds = nullptr;
 };
 
@@ -12,5 +12,8 @@ struct Model
     std::vector<const Model*> Children;
 
     std::vector<const Mesh*> Meshes;
+
+    //Of own meshes only, children are rendered and culled as separate objects
+    Bounds Bounds;
 };
 
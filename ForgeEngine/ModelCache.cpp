@@ -0,0 +1,335 @@
+#include "ModelCache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+namespace
+{
+    inline uint64_t Hash(const void* const& data, const size_t& size, uint64_t hash)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+
+        return hash;
+    }
+
+    inline size_t Align(const size_t& size)
+    {
+        return (size + MODEL_CACHE_ALIGNMENT - 1) / MODEL_CACHE_ALIGNMENT * MODEL_CACHE_ALIGNMENT;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* data = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+    if (data == nullptr)
+    {
+        if (mapping != nullptr)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = (size_t)size.QuadPart;
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size <= 0)
+    {
+        close(file);
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    //The mapping keeps the file alive
+    close(file);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = (size_t)status.st_size;
+#endif
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_data == nullptr)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+    m_file = nullptr;
+    m_mapping = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool GetModelCacheKey(const std::string& sourcePath, const uint32_t& importFlags, const uint32_t& packingFlags, uint64_t& key)
+{
+    MappedFile source;
+    if (!source.Open(sourcePath))
+        return false;
+
+    const uint32_t version = MODEL_CACHE_VERSION;
+    key = Hash(&version, sizeof(version), FNV_OFFSET);
+    key = Hash(&importFlags, sizeof(importFlags), key);
+    key = Hash(&packingFlags, sizeof(packingFlags), key);
+    key = Hash(sourcePath.data(), sourcePath.size(), key);
+    key = Hash(source.GetData(), source.GetSize(), key);
+
+    return true;
+}
+
+ModelCacheRange ModelCacheBuilder::AddBytes(const void* const& elements, const size_t& elementSize, const size_t& amount)
+{
+    const size_t offset = Align(m_data.size());
+    m_data.resize(offset + elementSize * amount);
+
+    if (amount > 0)
+        memcpy(&m_data[offset], elements, elementSize * amount);
+
+    return { Align(sizeof(ModelCacheHeader)) + offset, amount };
+}
+
+ModelCacheRange ModelCacheBuilder::AddString(const std::string& text)
+{
+    return Add(text.data(), text.size());
+}
+
+uint32_t ModelCacheBuilder::AddNode()
+{
+    m_nodes.emplace_back();
+    memset(&m_nodes.back(), 0, sizeof(ModelCacheNode));
+
+    return (uint32_t)m_nodes.size() - 1;
+}
+
+void ModelCacheBuilder::SetNode(const uint32_t& index, const ModelCacheNode& node)
+{
+    m_nodes[index] = node;
+}
+
+uint32_t ModelCacheBuilder::AddMesh(const ModelCacheMesh& mesh)
+{
+    m_meshes.push_back(mesh);
+    return (uint32_t)m_meshes.size() - 1;
+}
+
+void ModelCacheBuilder::Serialize(const uint64_t& key, std::vector<uint8_t>& output) const
+{
+    const size_t dataOffset = Align(sizeof(ModelCacheHeader));
+    const size_t nodesOffset = Align(dataOffset + m_data.size());
+    const size_t meshesOffset = Align(nodesOffset + m_nodes.size() * sizeof(ModelCacheNode));
+    const size_t size = meshesOffset + m_meshes.size() * sizeof(ModelCacheMesh);
+
+    output.assign(size, 0);
+
+    ModelCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = MODEL_CACHE_MAGIC;
+    header.Version = MODEL_CACHE_VERSION;
+    header.Key = key;
+    header.Size = size;
+    header.Nodes = { nodesOffset, m_nodes.size() };
+    header.Meshes = { meshesOffset, m_meshes.size() };
+
+    memcpy(output.data(), &header, sizeof(header));
+
+    if (!m_data.empty())
+        memcpy(&output[dataOffset], m_data.data(), m_data.size());
+    if (!m_nodes.empty())
+        memcpy(&output[nodesOffset], m_nodes.data(), m_nodes.size() * sizeof(ModelCacheNode));
+    if (!m_meshes.empty())
+        memcpy(&output[meshesOffset], m_meshes.data(), m_meshes.size() * sizeof(ModelCacheMesh));
+}
+
+bool WriteModelCache(const std::string& path, const std::vector<uint8_t>& data)
+{
+    //Written aside and renamed, so a cache being written is never mapped
+    const std::string temporaryPath = path + ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+
+        if (!file.good())
+        {
+            file.close();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+bool ModelCache::Open(const std::string& path, const uint64_t& key)
+{
+    Close();
+
+    if (!m_file.Open(path))
+        return false;
+
+    m_data = m_file.GetData();
+    m_size = m_file.GetSize();
+
+    return Validate(key);
+}
+
+bool ModelCache::Open(std::vector<uint8_t>&& data, const uint64_t& key)
+{
+    Close();
+
+    m_memory = std::move(data);
+    m_data = m_memory.data();
+    m_size = m_memory.size();
+
+    return Validate(key);
+}
+
+void ModelCache::Close()
+{
+    m_file.Close();
+    m_memory.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+}
+
+bool ModelCache::IsValid(const ModelCacheRange& range, const size_t& elementSize) const
+{
+    if (range.Amount == 0)
+        return true;
+
+    return range.Offset % MODEL_CACHE_ALIGNMENT == 0 && range.Offset <= m_size && range.Amount <= (m_size - range.Offset) / elementSize;
+}
+
+bool ModelCache::AreIndicesValid(const ModelCacheRange& range, const uint32_t& verticesAmount) const
+{
+    const uint32_t* indices = Get<uint32_t>(range);
+
+    for (uint64_t i = 0; i < range.Amount; ++i)
+    {
+        if (indices[i] >= verticesAmount)
+            return false;
+    }
+
+    return true;
+}
+
+bool ModelCache::Validate(const uint64_t& key)
+{
+    m_header = reinterpret_cast<const ModelCacheHeader*>(m_data);
+
+    bool valid = m_size >= sizeof(ModelCacheHeader) && m_header->Magic == MODEL_CACHE_MAGIC && m_header->Version == MODEL_CACHE_VERSION
+        && m_header->Key == key && m_header->Size == m_size && m_header->Nodes.Amount > 0
+        && IsValid(m_header->Nodes, sizeof(ModelCacheNode)) && IsValid(m_header->Meshes, sizeof(ModelCacheMesh));
+
+    for (uint32_t i = 0; valid && i < GetMeshesAmount(); ++i)
+    {
+        const ModelCacheMesh& mesh = GetMesh(i);
+
+        //Every format is a multiple of 4 bytes, as input layouts need
+        valid = mesh.Stride > 0 && mesh.Stride % 4 == 0 && mesh.Vertices.Amount == (uint64_t)mesh.VerticesAmount * mesh.Stride
+            && IsValid(mesh.Vertices, sizeof(uint8_t)) && IsValid(mesh.Layout, sizeof(CachedVertexElement))
+            && IsValid(mesh.Indices, sizeof(uint32_t)) && IsValid(mesh.Triangles, sizeof(uint32_t))
+            && IsValid(mesh.LODs, sizeof(ModelCacheRange)) && IsValid(mesh.Textures, sizeof(ModelCacheRange));
+
+        const ModelCacheRange* lods = Get<ModelCacheRange>(mesh.LODs);
+        for (uint64_t l = 0; valid && l < mesh.LODs.Amount; ++l)
+            valid = IsValid(lods[l], sizeof(uint32_t)) && AreIndicesValid(lods[l], mesh.VerticesAmount);
+
+        const ModelCacheRange* textures = Get<ModelCacheRange>(mesh.Textures);
+        for (uint64_t t = 0; valid && t < mesh.Textures.Amount; ++t)
+            valid = textures[t].Amount == 0 || (textures[t].Offset <= m_size && textures[t].Amount <= m_size - textures[t].Offset);
+
+        const CachedVertexElement* layout = Get<CachedVertexElement>(mesh.Layout);
+        for (uint64_t e = 0; valid && e < mesh.Layout.Amount; ++e)
+            valid = layout[e].Semantic <= VertexSemantic::Color && layout[e].Format <= VertexFormat::Unorm8x4
+                && layout[e].Offset <= mesh.Stride && GetVertexFormatSize(layout[e].Format) <= mesh.Stride - layout[e].Offset;
+
+        valid = valid && AreIndicesValid(mesh.Indices, mesh.VerticesAmount) && AreIndicesValid(mesh.Triangles, mesh.VerticesAmount);
+    }
+
+    for (uint32_t i = 0; valid && i < GetNodesAmount(); ++i)
+    {
+        const ModelCacheNode& node = GetNode(i);
+
+        valid = (node.Name.Amount == 0 || (node.Name.Offset <= m_size && node.Name.Amount <= m_size - node.Name.Offset))
+            && IsValid(node.Meshes, sizeof(uint32_t)) && IsValid(node.Children, sizeof(uint32_t));
+
+        const uint32_t* meshes = Get<uint32_t>(node.Meshes);
+        for (uint64_t m = 0; valid && m < node.Meshes.Amount; ++m)
+            valid = meshes[m] < GetMeshesAmount();
+
+        //Children after their parent can't form cycles
+        const uint32_t* children = Get<uint32_t>(node.Children);
+        for (uint64_t c = 0; valid && c < node.Children.Amount; ++c)
+            valid = children[c] > i && children[c] < GetNodesAmount();
+    }
+
+    if (!valid)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
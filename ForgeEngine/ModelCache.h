@@ -0,0 +1,202 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FrustumCulling.h"
+
+//Bumped whenever the file layout or the processing of imported meshes changes, old caches are imported again
+#define MODEL_CACHE_VERSION 3
+#define MODEL_CACHE_MAGIC 0x434D4746
+//Written next to the source model
+#define MODEL_CACHE_EXTENSION ".fmc"
+//Arrays start at multiples of this, so they are read in place from the mapped file
+#define MODEL_CACHE_ALIGNMENT 16
+
+enum class VertexSemantic : uint32_t
+{
+    Position,
+    Normal,
+    TexCoord,
+    Color
+};
+
+//Unorm16x4 positions are dequantized with the transform of the mesh, Snorm16x2 normals are octahedral
+enum class VertexFormat : uint32_t
+{
+    Float2,
+    Float3,
+    Float4,
+    Half2,
+    Snorm16x2,
+    Unorm16x4,
+    Unorm8x4
+};
+
+//In bytes
+inline uint32_t GetVertexFormatSize(const VertexFormat& format)
+{
+    switch (format)
+    {
+    case VertexFormat::Float2: return 8;
+    case VertexFormat::Float3: return 12;
+    case VertexFormat::Float4: return 16;
+    case VertexFormat::Half2: return 4;
+    case VertexFormat::Snorm16x2: return 4;
+    case VertexFormat::Unorm16x4: return 8;
+    case VertexFormat::Unorm8x4: return 4;
+    }
+
+    return 0;
+}
+
+//Elements are stored in the file, offset is in bytes from the file start and amount in elements
+struct ModelCacheRange
+{
+    uint64_t Offset;
+    uint64_t Amount;
+};
+
+struct CachedVertexElement
+{
+    VertexSemantic Semantic;
+    uint32_t SemanticIndex;
+    uint32_t Offset;
+    VertexFormat Format;
+};
+
+struct ModelCacheMesh
+{
+    //In bytes
+    uint32_t Stride;
+    uint32_t VerticesAmount;
+    //Bytes, in the formats of the layout
+    ModelCacheRange Vertices;
+    //CachedVertexElements
+    ModelCacheRange Layout;
+    //uint32_ts of all faces, and of triangles only for occlusion culling. Both are the same range when the mesh has only triangles
+    ModelCacheRange Indices;
+    ModelCacheRange Triangles;
+    //ModelCacheRanges of uint32_ts, from LOD 1
+    ModelCacheRange LODs;
+    //ModelCacheRanges of chars
+    ModelCacheRange Textures;
+    Bounds MeshBounds;
+    //Model space position is the stored one times scale plus offset, identity for float positions
+    float PositionScale[3];
+    float PositionOffset[3];
+    float Diffuse[3];
+    float Specular[3];
+    uint32_t HasDiffuse;
+    uint32_t HasSpecular;
+};
+
+//Node 0 is the root, children always come after their parent
+struct ModelCacheNode
+{
+    //Row major, ready to be loaded into XMMATRIX
+    float Transform[16];
+    //chars
+    ModelCacheRange Name;
+    //uint32_t indices of meshes and children
+    ModelCacheRange Meshes;
+    ModelCacheRange Children;
+};
+
+struct ModelCacheHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t Key;
+    uint64_t Size;
+    //ModelCacheNodes and ModelCacheMeshes
+    ModelCacheRange Nodes;
+    ModelCacheRange Meshes;
+};
+
+//Read only view of a whole file, the file is closed once it's unmapped
+class MappedFile
+{
+public:
+    ~MappedFile();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    inline const uint8_t* GetData() const { return m_data; }
+    inline size_t GetSize() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+//Hashes the version, import and vertex packing flags, source path and contents of the source file. Returns false when the source can't be read
+bool GetModelCacheKey(const std::string& sourcePath, const uint32_t& importFlags, const uint32_t& packingFlags, uint64_t& key);
+
+//Collects records and arrays of a cache in memory
+class ModelCacheBuilder
+{
+public:
+    //Copies the array into the data, aligned
+    template<typename T>
+    ModelCacheRange Add(const T* const& elements, const size_t& amount)
+    {
+        return AddBytes(elements, sizeof(T), amount);
+    }
+
+    ModelCacheRange AddString(const std::string& text);
+
+    //Nodes are reserved first, so a parent gets its index before its children
+    uint32_t AddNode();
+    void SetNode(const uint32_t& index, const ModelCacheNode& node);
+    uint32_t AddMesh(const ModelCacheMesh& mesh);
+
+    void Serialize(const uint64_t& key, std::vector<uint8_t>& output) const;
+
+private:
+    ModelCacheRange AddBytes(const void* const& elements, const size_t& elementSize, const size_t& amount);
+
+    //Starts right after the header
+    std::vector<uint8_t> m_data;
+    std::vector<ModelCacheNode> m_nodes;
+    std::vector<ModelCacheMesh> m_meshes;
+};
+
+bool WriteModelCache(const std::string& path, const std::vector<uint8_t>& data);
+
+//Every range and index is validated while opening, so a damaged file is rejected instead of read out of bounds
+class ModelCache
+{
+public:
+    bool Open(const std::string& path, const uint64_t& key);
+    //For caches which couldn't be written, keeps the data
+    bool Open(std::vector<uint8_t>&& data, const uint64_t& key);
+    void Close();
+
+    inline uint32_t GetNodesAmount() const { return (uint32_t)m_header->Nodes.Amount; }
+    inline uint32_t GetMeshesAmount() const { return (uint32_t)m_header->Meshes.Amount; }
+    inline const ModelCacheNode& GetNode(const uint32_t& index) const { return Get<ModelCacheNode>(m_header->Nodes)[index]; }
+    inline const ModelCacheMesh& GetMesh(const uint32_t& index) const { return Get<ModelCacheMesh>(m_header->Meshes)[index]; }
+
+    template<typename T>
+    inline const T* Get(const ModelCacheRange& range) const { return reinterpret_cast<const T*>(m_data + range.Offset); }
+
+    inline std::string GetString(const ModelCacheRange& range) const { return std::string(Get<char>(range), (size_t)range.Amount); }
+
+private:
+    bool Validate(const uint64_t& key);
+    bool IsValid(const ModelCacheRange& range, const size_t& elementSize) const;
+    //Indices are read by the GPU, so they are checked as well
+    bool AreIndicesValid(const ModelCacheRange& range, const uint32_t& verticesAmount) const;
+
+    MappedFile m_file;
+    std::vector<uint8_t> m_memory;
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    const ModelCacheHeader* m_header = nullptr;
+};
@@ -0,0 +1,416 @@
+#include "ModelImporter.h"
+#include <algorithm>
+#include <cstring>
+#include <assimp/Importer.hpp>
+#include <assimp/ProgressHandler.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include "JobSystem.h"
+#include "MeshLODs.h"
+#include "MeshOptimizer.h"
+#include "VertexPacking.h"
+
+namespace
+{
+    //Jobs finish out of order, so progress only ever grows
+    void RaiseProgress(std::atomic<float>* const& progress, const float& value)
+    {
+        if (progress == nullptr)
+            return;
+
+        float current = progress->load();
+        while (current < value && !progress->compare_exchange_weak(current, value))
+        {
+        }
+    }
+
+    //Reading and post processing are the first half of the import, the importer deletes the handler
+    class ImportProgressHandler : public Assimp::ProgressHandler
+    {
+    public:
+        ImportProgressHandler(std::atomic<float>* const& progress) : m_progress(progress) {}
+
+        virtual bool Update(float percentage) override
+        {
+            if (percentage >= 0.0f)
+                RaiseProgress(m_progress, std::min(percentage, 1.0f) * 0.5f);
+
+            return true;
+        }
+
+    private:
+        std::atomic<float>* m_progress;
+    };
+
+    //Everything a job produces for one mesh of the scene, copied into the cache afterwards
+    struct ImportedMesh
+    {
+        bool Opaque = true;
+        //Packed, stride in bytes
+        uint32_t Stride = 0;
+        uint32_t VerticesAmount = 0;
+        std::vector<uint8_t> Vertices;
+        std::vector<CachedVertexElement> Layout;
+        std::vector<uint32_t> Indices;
+        std::vector<uint32_t> Triangles;
+        std::vector<std::vector<uint32_t>> LODs;
+        std::vector<std::string> Textures;
+        Bounds MeshBounds;
+        float PositionScale[3] = { 1.0f, 1.0f, 1.0f };
+        float PositionOffset[3] = { 0.0f, 0.0f, 0.0f };
+        float Diffuse[3] = { 0.0f, 0.0f, 0.0f };
+        float Specular[3] = { 0.0f, 0.0f, 0.0f };
+        bool HasDiffuse = false;
+        bool HasSpecular = false;
+        MeshImportStatistics Statistics;
+    };
+
+    //Copies components of every source element into its place in the interleaved vertices
+    void Interleave(const float* const& source, const size_t& sourceStride, const size_t& components, const size_t& amount, float* const& destination, const size_t& destinationStride)
+    {
+        for (size_t i = 0; i < amount; ++i)
+        {
+            for (size_t c = 0; c < components; ++c)
+                destination[i * destinationStride + c] = source[i * sourceStride + c];
+        }
+    }
+
+    //Bounds, welding, vertex cache order and LODs, all on float vertices
+    void OptimizeMesh(const aiMesh* const& meshData, std::vector<float>& vertices, const size_t& floatsStride, ImportedMesh& mesh)
+    {
+        mesh.MeshBounds = CalculateBounds(&meshData->mVertices[0].x, meshData->mNumVertices, 3);
+
+        mesh.Statistics.VerticesAmount = meshData->mNumVertices;
+        mesh.Statistics.TrianglesAmount = (uint32_t)(mesh.Triangles.size() / 3);
+        mesh.Statistics.Before = AnalyzeVertexCache(mesh.Triangles.data(), mesh.Triangles.size(), meshData->mNumVertices);
+
+        size_t optimizedAmount = meshData->mNumVertices;
+
+        //Points and lines are drawn from the same indices, their order is kept
+        if (mesh.Triangles == mesh.Indices)
+        {
+            WeldVertices(vertices, floatsStride, mesh.Indices);
+
+            std::vector<uint32_t> optimized(mesh.Indices.size());
+            OptimizeVertexCache(mesh.Indices.data(), mesh.Indices.size(), vertices.size() / floatsStride, optimized.data());
+            mesh.Indices.swap(optimized);
+
+            optimizedAmount = OptimizeVertexFetch(vertices, floatsStride, mesh.Indices);
+            mesh.Triangles = mesh.Indices;
+        }
+
+        mesh.Statistics.WeldedVerticesAmount = (uint32_t)optimizedAmount;
+        mesh.Statistics.After = AnalyzeVertexCache(mesh.Triangles.data(), mesh.Triangles.size(), optimizedAmount);
+
+        GenerateLODs(vertices.data(), optimizedAmount, floatsStride, mesh.Triangles.data(), mesh.Triangles.size(), mesh.LODs);
+
+        //Simplification keeps the order of the remaining triangles, not their locality
+        for (std::vector<uint32_t>& lod : mesh.LODs)
+        {
+            std::vector<uint32_t> optimized(lod.size());
+            OptimizeVertexCache(lod.data(), lod.size(), optimizedAmount, optimized.data());
+            lod.swap(optimized);
+        }
+    }
+
+    void ImportMesh(const aiScene* const& scene, const aiMesh* const& meshData, const VertexPacking& packing, ImportedMesh& mesh)
+    {
+        const aiMaterial* material = scene->mMaterials[meshData->mMaterialIndex];
+
+        //Opacity - ignoring transparency for now
+        float opacity;
+        if (AI_SUCCESS == material->Get(AI_MATKEY_OPACITY, opacity) && opacity < 1.0f)
+        {
+            mesh.Opaque = false;
+            return;
+        }
+
+        for (int i = 0; i < AI_TEXTURE_TYPE_MAX; ++i)
+        {
+            const unsigned int amount = material->GetTextureCount((aiTextureType)i);
+
+            for (unsigned int a = 0; a < amount; ++a)
+            {
+                aiString path;
+                material->GetTexture((aiTextureType)i, a, &path);
+                mesh.Textures.push_back(std::string(path.C_Str()));
+            }
+        }
+
+        aiColor3D color;
+        if (AI_SUCCESS == material->Get(AI_MATKEY_COLOR_DIFFUSE, color))
+        {
+            mesh.Diffuse[0] = color.r;
+            mesh.Diffuse[1] = color.g;
+            mesh.Diffuse[2] = color.b;
+            mesh.HasDiffuse = true;
+        }
+
+        if (AI_SUCCESS == material->Get(AI_MATKEY_COLOR_SPECULAR, color))
+        {
+            mesh.Specular[0] = color.r;
+            mesh.Specular[1] = color.g;
+            mesh.Specular[2] = color.b;
+            mesh.HasSpecular = true;
+        }
+
+        uint32_t offset = 0;
+
+        if (meshData->HasPositions())
+        {
+            mesh.Layout.push_back({ VertexSemantic::Position, 0, offset, VertexFormat::Float3 });
+            offset += 12;
+        }
+
+        if (meshData->HasNormals())
+        {
+            mesh.Layout.push_back({ VertexSemantic::Normal, 0, offset, VertexFormat::Float3 });
+            offset += 12;
+        }
+
+        uint32_t texIndex = 0;
+        while (meshData->HasTextureCoords(texIndex))
+        {
+            mesh.Layout.push_back({ VertexSemantic::TexCoord, texIndex, offset, VertexFormat::Float2 });
+            offset += 8;
+            ++texIndex;
+        }
+
+        uint32_t clrIndex = 0;
+        while (meshData->HasVertexColors(clrIndex))
+        {
+            mesh.Layout.push_back({ VertexSemantic::Color, clrIndex, offset, VertexFormat::Float4 });
+            offset += 16;
+            ++clrIndex;
+        }
+
+        //Processed as floats, packed last. Attribute by attribute into preallocated vertices, so nothing is probed or grown per vertex
+        const size_t floatsStride = offset / sizeof(float);
+        const size_t verticesAmount = meshData->mNumVertices;
+        std::vector<float> vertices(floatsStride * verticesAmount);
+
+        for (const CachedVertexElement& element : mesh.Layout)
+        {
+            float* destination = vertices.data() + element.Offset / sizeof(float);
+
+            switch (element.Semantic)
+            {
+            case VertexSemantic::Position:
+                Interleave(&meshData->mVertices[0].x, 3, 3, verticesAmount, destination, floatsStride);
+                break;
+            case VertexSemantic::Normal:
+                Interleave(&meshData->mNormals[0].x, 3, 3, verticesAmount, destination, floatsStride);
+                break;
+            case VertexSemantic::TexCoord:
+                Interleave(&meshData->mTextureCoords[element.SemanticIndex][0].x, 3, 2, verticesAmount, destination, floatsStride);
+                break;
+            case VertexSemantic::Color:
+                Interleave(&meshData->mColors[element.SemanticIndex][0].r, 4, 4, verticesAmount, destination, floatsStride);
+                break;
+            }
+        }
+
+        size_t indicesAmount = 0;
+        for (unsigned int f = 0; f < meshData->mNumFaces; ++f)
+            indicesAmount += meshData->mFaces[f].mNumIndices;
+
+        mesh.Indices.reserve(indicesAmount);
+        mesh.Triangles.reserve(meshData->HasPositions() ? indicesAmount : 0);
+
+        for (unsigned int f = 0; f < meshData->mNumFaces; ++f)
+        {
+            const aiFace& face = meshData->mFaces[f];
+            mesh.Indices.insert(mesh.Indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+
+            if (face.mNumIndices == 3 && meshData->HasPositions())
+                mesh.Triangles.insert(mesh.Triangles.end(), face.mIndices, face.mIndices + 3);
+        }
+
+        mesh.Statistics.Name = std::string(meshData->mName.C_Str());
+
+        if (meshData->HasPositions() && meshData->mNumVertices > 0)
+            OptimizeMesh(meshData, vertices, floatsStride, mesh);
+        else
+            mesh.MeshBounds = GetEmptyBounds();
+
+        const std::vector<CachedVertexElement> floatLayout = mesh.Layout;
+        mesh.VerticesAmount = floatsStride > 0 ? (uint32_t)(vertices.size() / floatsStride) : 0;
+        mesh.Stride = PackVertices(vertices.data(), mesh.VerticesAmount, floatsStride, floatLayout, packing, mesh.Vertices, mesh.Layout, mesh.PositionScale, mesh.PositionOffset);
+
+        mesh.Statistics.VertexBytes = (uint32_t)(vertices.size() * sizeof(float));
+        mesh.Statistics.PackedVertexBytes = (uint32_t)mesh.Vertices.size();
+
+        //Counted the way RenderingSystem uploads them, LODs included
+        size_t uploadedIndicesAmount = mesh.Indices.size();
+        for (const std::vector<uint32_t>& lod : mesh.LODs)
+            uploadedIndicesAmount += lod.size();
+
+        mesh.Statistics.IndexBytes = (uint32_t)(uploadedIndicesAmount * sizeof(uint32_t));
+        mesh.Statistics.PackedIndexBytes = (uint32_t)(uploadedIndicesAmount * (mesh.VerticesAmount <= MAX_SHORT_INDEXED_VERTICES ? sizeof(uint16_t) : sizeof(uint32_t)));
+    }
+
+    uint32_t AddMesh(const ImportedMesh& mesh, ModelCacheBuilder& builder)
+    {
+        ModelCacheMesh record;
+        memset(&record, 0, sizeof(record));
+
+        record.Stride = mesh.Stride;
+        record.VerticesAmount = mesh.VerticesAmount;
+        record.Vertices = builder.Add(mesh.Vertices.data(), mesh.Vertices.size());
+        record.Layout = builder.Add(mesh.Layout.data(), mesh.Layout.size());
+        record.Indices = builder.Add(mesh.Indices.data(), mesh.Indices.size());
+        record.Triangles = mesh.Triangles == mesh.Indices ? record.Indices : builder.Add(mesh.Triangles.data(), mesh.Triangles.size());
+
+        std::vector<ModelCacheRange> lods;
+        for (const std::vector<uint32_t>& lod : mesh.LODs)
+            lods.push_back(builder.Add(lod.data(), lod.size()));
+        record.LODs = builder.Add(lods.data(), lods.size());
+
+        std::vector<ModelCacheRange> textures;
+        for (const std::string& texture : mesh.Textures)
+            textures.push_back(builder.AddString(texture));
+        record.Textures = builder.Add(textures.data(), textures.size());
+
+        record.MeshBounds = mesh.MeshBounds;
+        memcpy(record.PositionScale, mesh.PositionScale, sizeof(record.PositionScale));
+        memcpy(record.PositionOffset, mesh.PositionOffset, sizeof(record.PositionOffset));
+        memcpy(record.Diffuse, mesh.Diffuse, sizeof(record.Diffuse));
+        memcpy(record.Specular, mesh.Specular, sizeof(record.Specular));
+        record.HasDiffuse = mesh.HasDiffuse ? 1 : 0;
+        record.HasSpecular = mesh.HasSpecular ? 1 : 0;
+
+        return builder.AddMesh(record);
+    }
+
+    //Nodes AddNode skips have no meshes, so all of them are walked
+    void MarkUsedMeshes(const aiNode* const& node, std::vector<uint8_t>& used)
+    {
+        for (unsigned int i = 0; i < node->mNumMeshes; ++i)
+            used[node->mMeshes[i]] = 1;
+
+        for (unsigned int i = 0; i < node->mNumChildren; ++i)
+            MarkUsedMeshes(node->mChildren[i], used);
+    }
+
+    uint32_t AddNode(const aiNode* const& node, const std::vector<uint32_t>& meshesRecords, ModelCacheBuilder& builder)
+    {
+        const uint32_t index = builder.AddNode();
+
+        ModelCacheNode record;
+        memset(&record, 0, sizeof(record));
+
+        //Transposed, the same as XMMatrixTranspose of the assimp matrix
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+                record.Transform[r * 4 + c] = node->mTransformation[c][r];
+        }
+
+        record.Name = builder.AddString(std::string(node->mName.C_Str()));
+
+        std::vector<uint32_t> meshes;
+        for (unsigned int i = 0; i < node->mNumMeshes; ++i)
+        {
+            if (meshesRecords[node->mMeshes[i]] != UINT32_MAX)
+                meshes.push_back(meshesRecords[node->mMeshes[i]]);
+        }
+        record.Meshes = builder.Add(meshes.data(), meshes.size());
+
+        std::vector<uint32_t> children;
+        for (unsigned int i = 0; i < node->mNumChildren; ++i)
+        {
+            if (node->mChildren[i]->mNumMeshes == 0 && node->mChildren[i]->mChildren == 0)
+                continue;
+
+            children.push_back(AddNode(node->mChildren[i], meshesRecords, builder));
+        }
+        record.Children = builder.Add(children.data(), children.size());
+
+        builder.SetNode(index, record);
+        return index;
+    }
+}
+
+uint32_t GetModelImportFlags()
+{
+    return aiProcess_Triangulate
+        | aiProcess_ConvertToLeftHanded
+        | aiProcess_FixInfacingNormals
+        | aiProcess_FindInvalidData;
+}
+
+bool ImportModel(const std::string& path, const VertexPacking& packing, JobSystem* const& jobSystem, ModelCacheBuilder& builder,
+    std::vector<MeshImportStatistics>* const& statistics, std::atomic<float>* const& progress)
+{
+    Assimp::Importer importer;
+    importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, false);
+
+    if (progress != nullptr)
+        importer.SetProgressHandler(new ImportProgressHandler(progress));
+
+    const aiScene* scene = importer.ReadFile(path, GetModelImportFlags());
+    if (scene == nullptr || scene->mRootNode == nullptr)
+        return false;
+
+    //Meshes no node uses are never converted
+    std::vector<uint8_t> used(scene->mNumMeshes, 0);
+    MarkUsedMeshes(scene->mRootNode, used);
+
+    //Simplification dominates the import, so every mesh gets a separate job and the largest ones are taken first
+    std::vector<uint32_t> order;
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i)
+    {
+        if (used[i])
+            order.push_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [scene](const uint32_t& a, const uint32_t& b) { return scene->mMeshes[a]->mNumFaces > scene->mMeshes[b]->mNumFaces; });
+
+    RaiseProgress(progress, 0.5f);
+
+    std::vector<ImportedMesh> meshes(scene->mNumMeshes);
+    std::atomic<int> importedAmount(0);
+    jobSystem->Run((int)order.size(), [scene, &order, &packing, &meshes, &importedAmount, progress](const int& job)
+    {
+        ImportMesh(scene, scene->mMeshes[order[job]], packing, meshes[order[job]]);
+        RaiseProgress(progress, 0.5f + 0.5f * (importedAmount.fetch_add(1) + 1) / order.size());
+    });
+
+    //Only copying into the cache is left serial. Meshes which can't be drawn get no record, nodes drop them
+    std::vector<uint32_t> meshesRecords(meshes.size(), UINT32_MAX);
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        if (used[i] && meshes[i].Opaque && meshes[i].Stride > 0 && !meshes[i].Vertices.empty())
+        {
+            meshesRecords[i] = AddMesh(meshes[i], builder);
+
+            if (statistics != nullptr)
+                statistics->push_back(meshes[i].Statistics);
+        }
+    }
+
+    AddNode(scene->mRootNode, meshesRecords, builder);
+    return true;
+}
+
+bool LoadModelCache(const std::string& path, const VertexPacking& packing, JobSystem* const& jobSystem, ModelCache& cache, std::atomic<float>* const& progress)
+{
+    uint64_t key;
+    if (!GetModelCacheKey(path, GetModelImportFlags(), packing.GetFlags(), key))
+        return false;
+
+    const std::string cachePath = path + MODEL_CACHE_EXTENSION;
+    if (cache.Open(cachePath, key))
+        return true;
+
+    ModelCacheBuilder builder;
+    if (!ImportModel(path, packing, jobSystem, builder, nullptr, progress))
+        return false;
+
+    std::vector<uint8_t> data;
+    builder.Serialize(key, data);
+
+    //A cache which can't be written only costs the next start its import
+    WriteModelCache(cachePath, data);
+    return cache.Open(std::move(data), key);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshOptimizer.h"
+#include "ModelCache.h"
+#include "VertexPacking.h"
+
+class JobSystem;
+
+//Vertex cache efficiency of the triangles of one mesh, before and after they were optimized
+struct MeshImportStatistics
+{
+    std::string Name;
+    uint32_t VerticesAmount = 0;
+    uint32_t WeldedVerticesAmount = 0;
+    uint32_t TrianglesAmount = 0;
+    VertexCacheStatistics Before = { 0.0f, 0.0f };
+    VertexCacheStatistics After = { 0.0f, 0.0f };
+    //Float vertices and 32 bit indices against the packed ones, LOD indices included
+    uint32_t VertexBytes = 0;
+    uint32_t PackedVertexBytes = 0;
+    uint32_t IndexBytes = 0;
+    uint32_t PackedIndexBytes = 0;
+};
+
+//Post processing flags of assimp, part of the cache key
+uint32_t GetModelImportFlags();
+
+//Reads the model with assimp and processes every mesh - interleaved and welded vertices, cache optimized indices, LODs, bounds, packing - in a separate job.
+//Transparent meshes are skipped, returns false when assimp can't read the file. Progress goes from 0 to 1, the first half is assimp's
+bool ImportModel(const std::string& path, const VertexPacking& packing, JobSystem* const& jobSystem, ModelCacheBuilder& builder,
+    std::vector<MeshImportStatistics>* const& statistics = nullptr, std::atomic<float>* const& progress = nullptr);
+
+//Maps the cache written next to the model, importing the model and writing the cache first when it's missing or stale
+bool LoadModelCache(const std::string& path, const VertexPacking& packing, JobSystem* const& jobSystem, ModelCache& cache,
+    std::atomic<float>* const& progress = nullptr);
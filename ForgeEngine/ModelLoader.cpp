@@ -0,0 +1,88 @@
+#include "ModelLoader.h"
+#include "JobSystem.h"
+#include "ModelImporter.h"
+
+ModelLoader::ModelLoader(const VertexPacking& packing, const int& threadsAmount) : m_packing(packing)
+{
+    m_jobSystem = new JobSystem(threadsAmount);
+    m_thread = std::thread(&ModelLoader::LoadingLoop, this);
+}
+
+ModelLoader::~ModelLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        m_queue.clear();
+    }
+
+    m_loadsAdded.notify_all();
+    m_thread.join();
+
+    delete m_jobSystem;
+}
+
+std::shared_ptr<ModelLoad> ModelLoader::Load(const std::string& path, const LoadFactory& createLoad)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto pending = m_pending.find(path);
+    if (pending != m_pending.end())
+        return pending->second;
+
+    std::shared_ptr<ModelLoad> load = createLoad ? createLoad(path) : std::make_shared<ModelLoad>(path);
+    m_pending.insert({ path, load });
+    m_queue.push_back(load);
+    m_loadsAdded.notify_one();
+
+    return load;
+}
+
+void ModelLoader::TakeFinished(std::vector<std::shared_ptr<ModelLoad>>& finished)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const std::shared_ptr<ModelLoad>& load : m_finished)
+    {
+        m_pending.erase(load->GetPath());
+        finished.push_back(load);
+    }
+
+    m_finished.clear();
+}
+
+size_t ModelLoader::GetPendingAmount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
+
+void ModelLoader::LoadingLoop()
+{
+    while (true)
+    {
+        std::shared_ptr<ModelLoad> load;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_loadsAdded.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+
+            if (m_quit)
+                return;
+
+            load = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        //The load isn't touched by other threads until it's finished, the mutex publishes it
+        load->m_succeeded = LoadModelCache(load->m_path, m_packing, m_jobSystem, load->m_cache, &load->m_progress);
+
+        if (load->m_succeeded)
+            load->Process(m_jobSystem);
+
+        load->m_progress = 1.0f;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished.push_back(load);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ModelCache.h"
+#include "VertexPacking.h"
+
+class JobSystem;
+
+//Model cache loaded on the loading thread, shared by everybody asking for its path while it's in flight.
+//Derived loads add the CPU side work which doesn't need the device
+class ModelLoad
+{
+    friend class ModelLoader;
+
+public:
+    ModelLoad(const std::string& path) : m_path(path), m_progress(0.0f) {}
+    virtual ~ModelLoad() {}
+
+    inline const std::string& GetPath() const { return m_path; }
+    //From 0 to 1, loads from an up to date cache skip the import part
+    inline float GetProgress() const { return m_progress.load(); }
+
+    //Only valid once the loader handed the load back as finished
+    inline bool Succeeded() const { return m_succeeded; }
+    inline const ModelCache& GetCache() const { return m_cache; }
+
+protected:
+    //Called on the loading thread once the cache is open
+    virtual void Process(JobSystem* const&) {}
+
+private:
+    std::string m_path;
+    std::atomic<float> m_progress;
+    bool m_succeeded = false;
+    ModelCache m_cache;
+};
+
+//Loads models one after another on a background thread, every import runs its meshes on a separate job system.
+//Nothing is called back, the owner takes finished loads on its own thread
+class ModelLoader
+{
+public:
+    typedef std::function<std::shared_ptr<ModelLoad>(const std::string&)> LoadFactory;
+
+    //0 uses all hardware threads for the imports
+    ModelLoader(const VertexPacking& packing, const int& threadsAmount = 0);
+    //Waits for the running load, queued ones are dropped
+    ~ModelLoader();
+
+    //Returns the load of the path in flight, or queues the one createLoad makes - a plain ModelLoad without it
+    std::shared_ptr<ModelLoad> Load(const std::string& path, const LoadFactory& createLoad = nullptr);
+
+    //Appends loads finished since the last call in the order they finished. Loading their path again starts over
+    void TakeFinished(std::vector<std::shared_ptr<ModelLoad>>& finished);
+
+    //Queued, running and finished loads which weren't taken yet
+    size_t GetPendingAmount();
+
+private:
+    void LoadingLoop();
+
+    VertexPacking m_packing;
+    JobSystem* m_jobSystem;
+    std::thread m_thread;
+
+    std::mutex m_mutex;
+    std::condition_variable m_loadsAdded;
+    std::deque<std::shared_ptr<ModelLoad>> m_queue;
+    std::vector<std::shared_ptr<ModelLoad>> m_finished;
+    //Every load not taken yet by its path, for sharing them
+    std::unordered_map<std::string, std::shared_ptr<ModelLoad>> m_pending;
+    bool m_quit = false;
+};
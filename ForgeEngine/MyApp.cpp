@@ -104,6 +104,26 @@ void MyApp::UpdateScene()
         Profiler::Reset();
         DebugLog::Log("Reset profiler", 1.0f);
     }
+
+    if (InputClass::GetKeyDown(DIK_C))
+    {
+        Profiler::RequestTraceCapture("Traces/" + m_currentPerformer->GetName(), 120);
+        DebugLog::Log("Capturing trace", 1.0f);
+    }
+
+    if (InputClass::GetKeyDown(DIK_T))
+    {
+        if (Profiler::IsRecordingTimeSeries())
+        {
+            Profiler::StopTimeSeriesRecording();
+            DebugLog::Log("Stopped recording time series", 1.0f);
+        }
+        else
+        {
+            Profiler::RequestTimeSeriesRecording("TimeSeries/" + m_currentPerformer->GetName());
+            DebugLog::Log("Recording time series", 1.0f);
+        }
+    }
 }
 
 void MyApp::PostProcessing()
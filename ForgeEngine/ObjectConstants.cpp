@@ -0,0 +1,78 @@
+#include "ObjectConstants.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+
+void CalculateObjectConstants(const ObjectMatrix* const& worlds, ObjectMatrix* const& prevWVPs, const size_t& amount, const ObjectMatrix& viewProjection, ObjectConstants* const& output)
+{
+    const __m128 vp0 = _mm_load_ps(viewProjection.M[0]);
+    const __m128 vp1 = _mm_load_ps(viewProjection.M[1]);
+    const __m128 vp2 = _mm_load_ps(viewProjection.M[2]);
+    const __m128 vp3 = _mm_load_ps(viewProjection.M[3]);
+
+    for (size_t i = 0; i < amount; ++i)
+    {
+        __m128 w0 = _mm_load_ps(worlds[i].M[0]);
+        __m128 w1 = _mm_load_ps(worlds[i].M[1]);
+        __m128 w2 = _mm_load_ps(worlds[i].M[2]);
+        __m128 w3 = _mm_load_ps(worlds[i].M[3]);
+
+        __m128 wvp[4];
+        const __m128 rows[4] = { w0, w1, w2, w3 };
+
+        for (int r = 0; r < 4; ++r)
+        {
+            __m128 result = _mm_mul_ps(_mm_shuffle_ps(rows[r], rows[r], _MM_SHUFFLE(0, 0, 0, 0)), vp0);
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(rows[r], rows[r], _MM_SHUFFLE(1, 1, 1, 1)), vp1));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(rows[r], rows[r], _MM_SHUFFLE(2, 2, 2, 2)), vp2));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(rows[r], rows[r], _MM_SHUFFLE(3, 3, 3, 3)), vp3));
+            wvp[r] = result;
+        }
+
+        _MM_TRANSPOSE4_PS(w0, w1, w2, w3);
+        _MM_TRANSPOSE4_PS(wvp[0], wvp[1], wvp[2], wvp[3]);
+
+        ObjectConstants& constants = output[i];
+
+        _mm_store_ps(constants.W.M[0], w0);
+        _mm_store_ps(constants.W.M[1], w1);
+        _mm_store_ps(constants.W.M[2], w2);
+        _mm_store_ps(constants.W.M[3], w3);
+
+        for (int r = 0; r < 4; ++r)
+        {
+            _mm_store_ps(constants.PrevWVP.M[r], _mm_load_ps(prevWVPs[i].M[r]));
+            _mm_store_ps(constants.WVP.M[r], wvp[r]);
+            _mm_store_ps(prevWVPs[i].M[r], wvp[r]);
+        }
+    }
+}
+
+#else
+
+void CalculateObjectConstants(const ObjectMatrix* const& worlds, ObjectMatrix* const& prevWVPs, const size_t& amount, const ObjectMatrix& viewProjection, ObjectConstants* const& output)
+{
+    for (size_t i = 0; i < amount; ++i)
+    {
+        ObjectConstants& constants = output[i];
+        constants.PrevWVP = prevWVPs[i];
+
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                float sum = 0.0f;
+
+                for (int k = 0; k < 4; ++k)
+                    sum += worlds[i].M[r][k] * viewProjection.M[k][c];
+
+                constants.WVP.M[c][r] = sum;
+                constants.W.M[c][r] = worlds[i].M[r][c];
+            }
+        }
+
+        prevWVPs[i] = constants.WVP;
+    }
+}
+
+#endif
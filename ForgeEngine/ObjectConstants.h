@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+
+//Offsets of VSSetConstantBuffers1 are in 16 constants (256 bytes) steps
+#define OBJECT_CONSTANTS_SIZE 256
+#define OBJECT_CONSTANTS_IN_VECTORS (OBJECT_CONSTANTS_SIZE / 16)
+//A single binding can't exceed 4096 vectors, has to match MAX_INSTANCES in Base.fx
+#define OBJECT_CONSTANTS_MAX_INSTANCES (4096 / OBJECT_CONSTANTS_IN_VECTORS)
+
+//Row major, the same memory layout as XMMATRIX and XMFLOAT4X4
+struct alignas(16) ObjectMatrix
+{
+    float M[4][4];
+};
+
+//Element of cbPerObject in Base.fx, padded to the slice size
+struct alignas(16) ObjectConstants
+{
+    ObjectMatrix W;
+    ObjectMatrix WVP;
+    ObjectMatrix PrevWVP;
+    float Pad[16];
+};
+
+static_assert(sizeof(ObjectConstants) == OBJECT_CONSTANTS_SIZE, "Object constants have to fill a whole slice");
+
+//Outputs are transposed for HLSL. prevWVPs are read as the previous frame's transposed WVP and replaced with the current one
+void CalculateObjectConstants(const ObjectMatrix* const& worlds, ObjectMatrix* const& prevWVPs, const size_t& amount, const ObjectMatrix& viewProjection, ObjectConstants* const& output);
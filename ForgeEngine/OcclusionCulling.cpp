@@ -0,0 +1,740 @@
+#include "OcclusionCulling.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include "JobSystem.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define OCCLUSION_CULLING_SSE
+#endif
+
+#define CLIP_PLANES 5
+#define CLIP_MAX_VERTICES (3 + CLIP_PLANES)
+//Coverage samples per pixel in each dimension, one per full resolution pixel
+#define SAMPLES_PER_SIDE 4
+#define FULL_COVERAGE 0xFFFF
+
+static_assert(OCCLUSION_DOWNSCALE == SAMPLES_PER_SIDE, "Coverage masks have a sample per full resolution pixel");
+
+namespace
+{
+    //Offsets of samples from the pixel center
+    const float SampleOffsets[SAMPLES_PER_SIDE] = { -0.375f, -0.125f, 0.125f, 0.375f };
+
+    ObjectMatrix Multiply(const ObjectMatrix& a, const ObjectMatrix& b)
+    {
+        ObjectMatrix result;
+
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+                result.M[r][c] = a.M[r][0] * b.M[0][c] + a.M[r][1] * b.M[1][c] + a.M[r][2] * b.M[2][c] + a.M[r][3] * b.M[3][c];
+        }
+
+        return result;
+    }
+
+    inline void Transform(const float* const& position, const ObjectMatrix& matrix, float* const& output)
+    {
+        for (int c = 0; c < 4; ++c)
+            output[c] = position[0] * matrix.M[0][c] + position[1] * matrix.M[1][c] + position[2] * matrix.M[2][c] + matrix.M[3][c];
+    }
+
+    //Near plane and the guard band, inside when positive
+    inline float GetClipDistance(const float* const& position, const int& plane)
+    {
+        switch (plane)
+        {
+        case 0: return position[2];
+        case 1: return position[0] + OCCLUSION_GUARD_BAND * position[3];
+        case 2: return OCCLUSION_GUARD_BAND * position[3] - position[0];
+        case 3: return position[1] + OCCLUSION_GUARD_BAND * position[3];
+        default: return OCCLUSION_GUARD_BAND * position[3] - position[1];
+        }
+    }
+}
+
+OcclusionCuller::OcclusionCuller(JobSystem* const& jobSystem) : m_jobSystem(jobSystem)
+{
+    memset(&m_viewProjection, 0, sizeof(m_viewProjection));
+}
+
+void OcclusionCuller::SetResolution(const int& width, const int& height)
+{
+    const int newWidth = std::max(width, 1);
+    const int newHeight = std::max(height, 1);
+
+    if (newWidth == m_width && newHeight == m_height)
+        return;
+
+    m_width = newWidth;
+    m_height = newHeight;
+    m_stride = (m_width + 3) & ~3;
+    m_bandsAmount = (m_height + OCCLUSION_BAND_HEIGHT - 1) / OCCLUSION_BAND_HEIGHT;
+
+    m_levels.clear();
+    m_levelsWidths.clear();
+    m_levelsHeights.clear();
+    m_levelsStrides.clear();
+
+    int levelWidth = m_width;
+    int levelHeight = m_height;
+
+    while (true)
+    {
+        const int stride = m_levels.empty() ? m_stride : levelWidth;
+
+        m_levels.emplace_back((size_t)stride * levelHeight, 1.0f);
+        m_levelsWidths.push_back(levelWidth);
+        m_levelsHeights.push_back(levelHeight);
+        m_levelsStrides.push_back(stride);
+
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+
+    m_coverage.assign((size_t)m_stride * m_height, 0);
+    m_pendingDepths.assign((size_t)m_stride * m_height, 1.0f);
+}
+
+void OcclusionCuller::Begin(const ObjectMatrix& viewProjection)
+{
+    m_viewProjection = viewProjection;
+
+    //Length of the world to clip y scale, so a unit sphere at w = 1 covers this part of the screen height
+    const float* column = &viewProjection.M[0][1];
+    m_screenScale = sqrtf(column[0] * column[0] + column[4] * column[4] + column[8] * column[8]);
+
+    for (std::vector<float>& level : m_levels)
+        std::fill(level.begin(), level.end(), 1.0f);
+
+    //Pending depths are overwritten by the first sample covered
+    std::fill(m_coverage.begin(), m_coverage.end(), (uint16_t)0);
+
+    m_occluders.clear();
+    m_occluderTrianglesAmount = 0;
+    m_bounds.clear();
+    m_occlusion.clear();
+    m_occludedAmount = 0;
+}
+
+float OcclusionCuller::GetScreenSize(const Bounds& bounds, const ObjectMatrix& world) const
+{
+    const Bounds worldBounds = TransformBounds(bounds, world);
+
+    if (worldBounds.Radius < 0.0f)
+        return 0.0f;
+
+    float clip[4];
+    Transform(worldBounds.Center, m_viewProjection, clip);
+
+    if (clip[3] <= worldBounds.Radius)
+        return 1.0f;
+
+    return std::min(worldBounds.Radius * m_screenScale / clip[3], 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(const float* const& positions, const size_t& verticesAmount, const size_t& stride, const uint32_t* const& indices, const size_t& indicesAmount, const ObjectMatrix& world)
+{
+    Occluder occluder;
+    occluder.Positions = positions;
+    occluder.VerticesAmount = verticesAmount;
+    occluder.Stride = stride;
+    occluder.Indices = indices;
+    occluder.IndicesAmount = indicesAmount - indicesAmount % 3;
+    occluder.WorldViewProjection = Multiply(world, m_viewProjection);
+
+    m_occluders.push_back(occluder);
+    m_occluderTrianglesAmount += occluder.IndicesAmount / 3;
+}
+
+void OcclusionCuller::Rasterize()
+{
+    if (m_levels.empty())
+        return;
+
+    TransformVertices();
+    SetupTriangles();
+
+    m_jobSystem->Run(m_bandsAmount, [this](const int& band) { RasterizeBand(band); });
+
+    BuildHierarchy();
+}
+
+uint32_t OcclusionCuller::Add(const Bounds& bounds, const ObjectMatrix& world)
+{
+    m_bounds.push_back(TransformBounds(bounds, world));
+    return (uint32_t)m_bounds.size() - 1;
+}
+
+void OcclusionCuller::Test()
+{
+    m_occlusion.assign(m_bounds.size(), 0);
+
+    if (m_levels.empty() || m_occluders.empty())
+        return;
+
+    const int jobsAmount = (int)((m_bounds.size() + OCCLUSION_OBJECTS_PER_JOB - 1) / OCCLUSION_OBJECTS_PER_JOB);
+
+    m_jobSystem->Run(jobsAmount, [this](const int& job)
+    {
+        const size_t first = (size_t)job * OCCLUSION_OBJECTS_PER_JOB;
+        const size_t last = std::min(first + OCCLUSION_OBJECTS_PER_JOB, m_bounds.size());
+
+        for (size_t i = first; i < last; ++i)
+            m_occlusion[i] = TestBounds(m_bounds[i]) ? 1 : 0;
+    });
+
+    m_occludedAmount = 0;
+
+    for (const uint8_t& occluded : m_occlusion)
+        m_occludedAmount += occluded;
+}
+
+void OcclusionCuller::TransformVertices()
+{
+    m_verticesOffsets.resize(m_occluders.size() + 1);
+    m_verticesOffsets[0] = 0;
+
+    for (size_t i = 0; i < m_occluders.size(); ++i)
+        m_verticesOffsets[i + 1] = m_verticesOffsets[i] + m_occluders[i].VerticesAmount;
+
+    const size_t verticesAmount = m_verticesOffsets.back();
+    m_clipVertices.resize(verticesAmount * 4);
+    m_screenVertices.resize(verticesAmount * 3);
+    m_clipCodes.resize(verticesAmount);
+
+    const int jobsAmount = (int)((verticesAmount + OCCLUSION_VERTICES_PER_JOB - 1) / OCCLUSION_VERTICES_PER_JOB);
+
+    m_jobSystem->Run(jobsAmount, [this, verticesAmount](const int& job)
+    {
+        const size_t first = (size_t)job * OCCLUSION_VERTICES_PER_JOB;
+        const size_t last = std::min(first + OCCLUSION_VERTICES_PER_JOB, verticesAmount);
+        size_t occluderIndex = (size_t)(std::upper_bound(m_verticesOffsets.begin(), m_verticesOffsets.end(), first) - m_verticesOffsets.begin()) - 1;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            while (i >= m_verticesOffsets[occluderIndex + 1])
+                ++occluderIndex;
+
+            const Occluder& occluder = m_occluders[occluderIndex];
+            float* clip = &m_clipVertices[i * 4];
+            Transform(occluder.Positions + (i - m_verticesOffsets[occluderIndex]) * occluder.Stride, occluder.WorldViewProjection, clip);
+
+            int code = 0;
+            for (int plane = 0; plane < CLIP_PLANES; ++plane)
+                code |= GetClipDistance(clip, plane) < 0.0f ? 1 << plane : 0;
+
+            m_clipCodes[i] = (uint8_t)code;
+
+            //Vertices of triangles which are clipped are projected after clipping
+            if (code == 0)
+                ProjectVertex(clip, &m_screenVertices[i * 3]);
+        }
+    });
+}
+
+void OcclusionCuller::SetupTriangles()
+{
+    m_trianglesOffsets.resize(m_occluders.size() + 1);
+    m_trianglesOffsets[0] = 0;
+
+    for (size_t i = 0; i < m_occluders.size(); ++i)
+        m_trianglesOffsets[i + 1] = m_trianglesOffsets[i] + m_occluders[i].IndicesAmount / 3;
+
+    const size_t trianglesAmount = m_trianglesOffsets.back();
+    const int jobsAmount = (int)((trianglesAmount + OCCLUSION_TRIANGLES_PER_JOB - 1) / OCCLUSION_TRIANGLES_PER_JOB);
+
+    if (m_triangles.size() < (size_t)jobsAmount)
+    {
+        m_triangles.resize(jobsAmount);
+        m_bins.resize(jobsAmount);
+    }
+
+    //Bins of jobs from previous frames are emptied as well, bands walk all of them
+    for (size_t job = 0; job < m_bins.size(); ++job)
+    {
+        m_triangles[job].clear();
+        m_bins[job].resize(m_bandsAmount);
+
+        for (std::vector<uint32_t>& bin : m_bins[job])
+            bin.clear();
+    }
+
+    m_jobSystem->Run(jobsAmount, [this, trianglesAmount](const int& job)
+    {
+        const size_t first = (size_t)job * OCCLUSION_TRIANGLES_PER_JOB;
+        const size_t last = std::min(first + OCCLUSION_TRIANGLES_PER_JOB, trianglesAmount);
+        size_t occluderIndex = (size_t)(std::upper_bound(m_trianglesOffsets.begin(), m_trianglesOffsets.end(), first) - m_trianglesOffsets.begin()) - 1;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            while (i >= m_trianglesOffsets[occluderIndex + 1])
+                ++occluderIndex;
+
+            const Occluder& occluder = m_occluders[occluderIndex];
+            const uint32_t* indices = occluder.Indices + (i - m_trianglesOffsets[occluderIndex]) * 3;
+            const size_t firstVertex = m_verticesOffsets[occluderIndex];
+
+            if (indices[0] >= occluder.VerticesAmount || indices[1] >= occluder.VerticesAmount || indices[2] >= occluder.VerticesAmount)
+                continue;
+
+            const size_t vertices[3] = { firstVertex + indices[0], firstVertex + indices[1], firstVertex + indices[2] };
+            const int codes[3] = { m_clipCodes[vertices[0]], m_clipCodes[vertices[1]], m_clipCodes[vertices[2]] };
+
+            if ((codes[0] & codes[1] & codes[2]) != 0)
+                continue;
+
+            if ((codes[0] | codes[1] | codes[2]) == 0)
+            {
+                const float* const screen[3] = { &m_screenVertices[vertices[0] * 3], &m_screenVertices[vertices[1] * 3], &m_screenVertices[vertices[2] * 3] };
+                AddTriangle(screen, job);
+            }
+            else
+            {
+                const float* const clip[3] = { &m_clipVertices[vertices[0] * 4], &m_clipVertices[vertices[1] * 4], &m_clipVertices[vertices[2] * 4] };
+                ClipTriangle(clip, codes[0] | codes[1] | codes[2], job);
+            }
+        }
+    });
+}
+
+void OcclusionCuller::ClipTriangle(const float* const (&vertices)[3], const int& outside, const int& job)
+{
+    float polygons[2][CLIP_MAX_VERTICES][4];
+    int amounts[2] = { 3, 0 };
+    int current = 0;
+
+    for (int i = 0; i < 3; ++i)
+        memcpy(polygons[0][i], vertices[i], sizeof(float) * 4);
+
+    for (int plane = 0; plane < CLIP_PLANES; ++plane)
+    {
+        if ((outside & (1 << plane)) == 0)
+            continue;
+
+        const float (*input)[4] = polygons[current];
+        float (*output)[4] = polygons[1 - current];
+        int& outputAmount = amounts[1 - current];
+        outputAmount = 0;
+
+        for (int i = 0; i < amounts[current]; ++i)
+        {
+            const float* a = input[i];
+            const float* b = input[(i + 1) % amounts[current]];
+            const float distanceA = GetClipDistance(a, plane);
+            const float distanceB = GetClipDistance(b, plane);
+
+            if (distanceA >= 0.0f)
+                memcpy(output[outputAmount++], a, sizeof(float) * 4);
+
+            if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+            {
+                const float t = distanceA / (distanceA - distanceB);
+                float* result = output[outputAmount++];
+
+                for (int c = 0; c < 4; ++c)
+                    result[c] = a[c] + (b[c] - a[c]) * t;
+            }
+        }
+
+        current = 1 - current;
+
+        if (amounts[current] < 3)
+            return;
+    }
+
+    float screen[CLIP_MAX_VERTICES][3];
+
+    for (int i = 0; i < amounts[current]; ++i)
+    {
+        //Can happen only for vertices exactly at the camera
+        if (polygons[current][i][3] <= 0.0f)
+            return;
+
+        ProjectVertex(polygons[current][i], screen[i]);
+    }
+
+    for (int i = 2; i < amounts[current]; ++i)
+    {
+        const float* const triangle[3] = { screen[0], screen[i - 1], screen[i] };
+        AddTriangle(triangle, job);
+    }
+}
+
+void OcclusionCuller::ProjectVertex(const float* const& clip, float* const& screen) const
+{
+    const float invW = 1.0f / clip[3];
+    screen[0] = (clip[0] * invW * 0.5f + 0.5f) * m_width;
+    screen[1] = (0.5f - clip[1] * invW * 0.5f) * m_height;
+    screen[2] = clip[2] * invW;
+}
+
+void OcclusionCuller::AddTriangle(const float* const (&vertices)[3], const int& job)
+{
+    //Pixels with samples inside of the bounding box, most of small triangles end here
+    const float samplesScale = (float)SAMPLES_PER_SIDE;
+    const int minSampleX = (int)ceilf(std::min(vertices[0][0], std::min(vertices[1][0], vertices[2][0])) * samplesScale - 0.5f);
+    const int minSampleY = (int)ceilf(std::min(vertices[0][1], std::min(vertices[1][1], vertices[2][1])) * samplesScale - 0.5f);
+    const int maxSampleX = (int)floorf(std::max(vertices[0][0], std::max(vertices[1][0], vertices[2][0])) * samplesScale - 0.5f);
+    const int maxSampleY = (int)floorf(std::max(vertices[0][1], std::max(vertices[1][1], vertices[2][1])) * samplesScale - 0.5f);
+
+    if (minSampleX > maxSampleX || minSampleY > maxSampleY || maxSampleX < 0 || maxSampleY < 0)
+        return;
+
+    OccluderTriangle triangle;
+    triangle.MinX = std::max(minSampleX, 0) / SAMPLES_PER_SIDE;
+    triangle.MinY = std::max(minSampleY, 0) / SAMPLES_PER_SIDE;
+    triangle.MaxX = std::min(maxSampleX / SAMPLES_PER_SIDE, m_width - 1);
+    triangle.MaxY = std::min(maxSampleY / SAMPLES_PER_SIDE, m_height - 1);
+
+    if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+        return;
+
+    double x[3];
+    double y[3];
+    double z[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        x[i] = vertices[i][0];
+        y[i] = vertices[i][1];
+        z[i] = vertices[i][2];
+    }
+
+    double area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+
+    if (area == 0.0)
+        return;
+
+    //Occluders are drawn without culling as well, counter clockwise triangles are flipped
+    if (area < 0.0)
+    {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+
+    //Evaluated at pixel centers with integer coordinates
+    for (int e = 0; e < 3; ++e)
+    {
+        const int next = (e + 1) % 3;
+        const double a = -(y[next] - y[e]);
+        const double b = x[next] - x[e];
+
+        triangle.A[e] = (float)a;
+        triangle.B[e] = (float)b;
+        triangle.C[e] = (float)(-a * x[e] - b * y[e] + 0.5 * (a + b));
+        triangle.SampleRange[e] = (float)(SampleOffsets[SAMPLES_PER_SIDE - 1] * (fabs(a) + fabs(b)));
+    }
+
+    const double zx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    const double zy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+
+    triangle.ZX = (float)zx;
+    triangle.ZY = (float)zy;
+    triangle.Z0 = (float)(z[0] + zx * (0.5 - x[0]) + zy * (0.5 - y[0]) + 0.5 * (fabs(zx) + fabs(zy)));
+    triangle.ZMax = (float)std::min(std::max(z[0], std::max(z[1], z[2])), 1.0);
+
+    std::vector<OccluderTriangle>& triangles = m_triangles[job];
+    const uint32_t index = (uint32_t)triangles.size();
+    triangles.push_back(triangle);
+
+    for (int band = triangle.MinY / OCCLUSION_BAND_HEIGHT; band <= triangle.MaxY / OCCLUSION_BAND_HEIGHT; ++band)
+        m_bins[job][band].push_back(index);
+}
+
+void OcclusionCuller::RasterizeBand(const int& band)
+{
+    const int firstY = band * OCCLUSION_BAND_HEIGHT;
+    const int lastY = std::min(firstY + OCCLUSION_BAND_HEIGHT, m_height) - 1;
+
+    for (size_t job = 0; job < m_bins.size(); ++job)
+    {
+        for (const uint32_t& index : m_bins[job][band])
+            RasterizeTriangle(m_triangles[job][index], firstY, lastY);
+    }
+}
+
+#ifdef OCCLUSION_CULLING_SSE
+
+void OcclusionCuller::RasterizeTriangle(const OccluderTriangle& triangle, const int& firstY, const int& lastY)
+{
+    const int startY = std::max(triangle.MinY, firstY);
+    const int endY = std::min(triangle.MaxY, lastY);
+    const int startX = triangle.MinX & ~3;
+
+    const __m128 zMax = _mm_set1_ps(triangle.ZMax);
+    const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 a0 = _mm_set1_ps(triangle.A[0]);
+    const __m128 a1 = _mm_set1_ps(triangle.A[1]);
+    const __m128 a2 = _mm_set1_ps(triangle.A[2]);
+    const __m128 range0 = _mm_set1_ps(triangle.SampleRange[0]);
+    const __m128 range1 = _mm_set1_ps(triangle.SampleRange[1]);
+    const __m128 range2 = _mm_set1_ps(triangle.SampleRange[2]);
+    const __m128 negativeRange0 = _mm_set1_ps(-triangle.SampleRange[0]);
+    const __m128 negativeRange1 = _mm_set1_ps(-triangle.SampleRange[1]);
+    const __m128 negativeRange2 = _mm_set1_ps(-triangle.SampleRange[2]);
+    const __m128 zx = _mm_set1_ps(triangle.ZX);
+    const __m128 maxX = _mm_set1_ps((float)triangle.MaxX);
+
+    for (int y = startY; y <= endY; ++y)
+    {
+        const __m128 row0 = _mm_set1_ps(triangle.B[0] * y + triangle.C[0]);
+        const __m128 row1 = _mm_set1_ps(triangle.B[1] * y + triangle.C[1]);
+        const __m128 row2 = _mm_set1_ps(triangle.B[2] * y + triangle.C[2]);
+        const __m128 rowZ = _mm_set1_ps(triangle.ZY * y + triangle.Z0);
+        float* depth = &m_levels[0][(size_t)y * m_stride];
+
+        for (int x = startX; x <= triangle.MaxX; x += 4)
+        {
+            const __m128 xs = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+            const __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, xs), row0);
+            const __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, xs), row1);
+            const __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, xs), row2);
+
+            //Some sample can be inside of every edge
+            __m128 touched = _mm_and_ps(_mm_cmpge_ps(e0, negativeRange0), _mm_cmple_ps(xs, maxX));
+            touched = _mm_and_ps(touched, _mm_cmpge_ps(e1, negativeRange1));
+            touched = _mm_and_ps(touched, _mm_cmpge_ps(e2, negativeRange2));
+
+            const int touchedMask = _mm_movemask_ps(touched);
+
+            if (touchedMask == 0)
+                continue;
+
+            //All of the samples are inside of every edge
+            __m128 covered = _mm_and_ps(touched, _mm_cmpge_ps(e0, range0));
+            covered = _mm_and_ps(covered, _mm_cmpge_ps(e1, range1));
+            covered = _mm_and_ps(covered, _mm_cmpge_ps(e2, range2));
+
+            const int coveredMask = _mm_movemask_ps(covered);
+
+            if (coveredMask != 0)
+            {
+                const __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(zx, xs), rowZ), zMax);
+                const __m128 stored = _mm_loadu_ps(depth + x);
+
+                _mm_storeu_ps(depth + x, _mm_or_ps(_mm_and_ps(covered, _mm_min_ps(stored, z)), _mm_andnot_ps(covered, stored)));
+            }
+
+            //Only pixels along the edges get here
+            int partial = touchedMask & ~coveredMask;
+
+            if (partial == 0)
+                continue;
+
+            float edges[3][4];
+            _mm_storeu_ps(edges[0], e0);
+            _mm_storeu_ps(edges[1], e1);
+            _mm_storeu_ps(edges[2], e2);
+
+            for (int lane = 0; partial != 0; ++lane, partial >>= 1)
+            {
+                if (partial & 1)
+                {
+                    const float pixelEdges[3] = { edges[0][lane], edges[1][lane], edges[2][lane] };
+                    AddCoverage(triangle, x + lane, y, pixelEdges);
+                }
+            }
+        }
+    }
+}
+
+#else
+
+void OcclusionCuller::RasterizeTriangle(const OccluderTriangle& triangle, const int& firstY, const int& lastY)
+{
+    const int startY = std::max(triangle.MinY, firstY);
+    const int endY = std::min(triangle.MaxY, lastY);
+
+    for (int y = startY; y <= endY; ++y)
+    {
+        float* depth = &m_levels[0][(size_t)y * m_stride];
+
+        for (int x = triangle.MinX; x <= triangle.MaxX; ++x)
+        {
+            float edges[3];
+            bool touched = true;
+            bool covered = true;
+
+            for (int e = 0; e < 3; ++e)
+            {
+                edges[e] = triangle.A[e] * x + triangle.B[e] * y + triangle.C[e];
+                touched = touched && edges[e] >= -triangle.SampleRange[e];
+                covered = covered && edges[e] >= triangle.SampleRange[e];
+            }
+
+            if (covered)
+                depth[x] = std::min(depth[x], std::min(triangle.ZX * x + triangle.ZY * y + triangle.Z0, triangle.ZMax));
+            else if (touched)
+                AddCoverage(triangle, x, y, edges);
+        }
+    }
+}
+
+#endif
+
+void OcclusionCuller::AddCoverage(const OccluderTriangle& triangle, const int& x, const int& y, const float (&edges)[3])
+{
+    const size_t index = (size_t)y * m_stride + x;
+    const float z = std::min(triangle.ZX * x + triangle.ZY * y + triangle.Z0, triangle.ZMax);
+
+    //The pixel is already in front of the triangle, whatever it completes can't move it
+    if (m_levels[0][index] <= z)
+        return;
+
+    uint32_t mask = 0;
+
+#ifdef OCCLUSION_CULLING_SSE
+    const __m128 offsets = _mm_loadu_ps(SampleOffsets);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 rows[3];
+    __m128 steps[3];
+
+    for (int e = 0; e < 3; ++e)
+    {
+        rows[e] = _mm_add_ps(_mm_set1_ps(edges[e] + triangle.B[e] * SampleOffsets[0]), _mm_mul_ps(_mm_set1_ps(triangle.A[e]), offsets));
+        steps[e] = _mm_set1_ps(triangle.B[e] * (SampleOffsets[1] - SampleOffsets[0]));
+    }
+
+    for (int sampleY = 0; sampleY < SAMPLES_PER_SIDE; ++sampleY)
+    {
+        __m128 inside = _mm_cmpge_ps(rows[0], zero);
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(rows[1], zero));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(rows[2], zero));
+        mask |= (uint32_t)_mm_movemask_ps(inside) << (sampleY * SAMPLES_PER_SIDE);
+
+        for (int e = 0; e < 3; ++e)
+            rows[e] = _mm_add_ps(rows[e], steps[e]);
+    }
+#else
+    for (int sampleY = 0; sampleY < SAMPLES_PER_SIDE; ++sampleY)
+    {
+        for (int sampleX = 0; sampleX < SAMPLES_PER_SIDE; ++sampleX)
+        {
+            bool inside = true;
+
+            for (int e = 0; e < 3; ++e)
+                inside = inside && edges[e] + triangle.A[e] * SampleOffsets[sampleX] + triangle.B[e] * SampleOffsets[sampleY] >= 0.0f;
+
+            if (inside)
+                mask |= 1u << (sampleY * SAMPLES_PER_SIDE + sampleX);
+        }
+    }
+#endif
+
+    if (mask == 0)
+        return;
+
+    uint16_t& coverage = m_coverage[index];
+    float& pendingDepth = m_pendingDepths[index];
+
+    //Every covered sample is in front of the farthest depth of the triangles covering it
+    pendingDepth = coverage == 0 ? z : std::max(pendingDepth, z);
+    coverage = (uint16_t)(coverage | mask);
+
+    if (coverage == FULL_COVERAGE)
+    {
+        float& depth = m_levels[0][index];
+        depth = std::min(depth, pendingDepth);
+        coverage = 0;
+    }
+}
+
+void OcclusionCuller::BuildHierarchy()
+{
+    for (size_t level = 1; level < m_levels.size(); ++level)
+    {
+        const std::vector<float>& source = m_levels[level - 1];
+        const int sourceWidth = m_levelsWidths[level - 1];
+        const int sourceHeight = m_levelsHeights[level - 1];
+        const int sourceStride = m_levelsStrides[level - 1];
+        std::vector<float>& destination = m_levels[level];
+
+        for (int y = 0; y < m_levelsHeights[level]; ++y)
+        {
+            const int y0 = y * 2;
+            const int y1 = std::min(y0 + 1, sourceHeight - 1);
+
+            for (int x = 0; x < m_levelsWidths[level]; ++x)
+            {
+                const int x0 = x * 2;
+                const int x1 = std::min(x0 + 1, sourceWidth - 1);
+
+                destination[(size_t)y * m_levelsStrides[level] + x] = std::max(
+                    std::max(source[(size_t)y0 * sourceStride + x0], source[(size_t)y0 * sourceStride + x1]),
+                    std::max(source[(size_t)y1 * sourceStride + x0], source[(size_t)y1 * sourceStride + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::TestBounds(const Bounds& bounds) const
+{
+    if (bounds.Radius < 0.0f)
+        return false;
+
+    float minX = FLT_MAX;
+    float minY = FLT_MAX;
+    float maxX = -FLT_MAX;
+    float maxY = -FLT_MAX;
+    float minZ = FLT_MAX;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        const float corner[3] = {
+            bounds.Center[0] + ((i & 1) ? bounds.Extents[0] : -bounds.Extents[0]),
+            bounds.Center[1] + ((i & 2) ? bounds.Extents[1] : -bounds.Extents[1]),
+            bounds.Center[2] + ((i & 4) ? bounds.Extents[2] : -bounds.Extents[2]) };
+
+        float clip[4];
+        Transform(corner, m_viewProjection, clip);
+
+        if (clip[3] <= 0.0f || clip[2] < 0.0f)
+            return false;
+
+        const float x = (clip[0] / clip[3] * 0.5f + 0.5f) * m_width;
+        const float y = (0.5f - clip[1] / clip[3] * 0.5f) * m_height;
+
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, clip[2] / clip[3]);
+    }
+
+    //Pixels touched by the rectangle, bounds outside of the screen are left to frustum culling
+    const int x0 = std::max((int)floorf(minX), 0);
+    const int y0 = std::max((int)floorf(minY), 0);
+    const int x1 = std::min((int)floorf(maxX), m_width - 1);
+    const int y1 = std::min((int)floorf(maxY), m_height - 1);
+
+    if (x0 > x1 || y0 > y1 || minZ > 1.0f)
+        return false;
+
+    //The first level where the rectangle spans at most 4x4 texels
+    size_t level = 0;
+    while (level + 1 < m_levels.size() && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3))
+        ++level;
+
+    const std::vector<float>& depth = m_levels[level];
+    const int stride = m_levelsStrides[level];
+
+    for (int y = y0 >> level; y <= (y1 >> level); ++y)
+    {
+        for (int x = x0 >> level; x <= (x1 >> level); ++x)
+        {
+            if (depth[(size_t)y * stride + x] >= minZ)
+                return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FrustumCulling.h"
+#include "ObjectConstants.h"
+
+//Depth buffer is this many times smaller than the resolution in both dimensions
+#define OCCLUSION_DOWNSCALE 4
+#define OCCLUSION_BAND_HEIGHT 16
+#define OCCLUSION_VERTICES_PER_JOB 4096
+#define OCCLUSION_TRIANGLES_PER_JOB 1024
+#define OCCLUSION_OBJECTS_PER_JOB 256
+//Renderers smaller than this part of the screen height are never used as occluders
+#define OCCLUSION_MIN_OCCLUDER_SIZE 0.1f
+#define OCCLUSION_TRIANGLES_BUDGET 100000
+//Triangles are clipped in x and y only outside of this many times the clip space extents
+#define OCCLUSION_GUARD_BAND 4.0f
+
+class JobSystem;
+
+//Masked occlusion style culling on a low resolution depth buffer. Every pixel has 4x4 coverage samples at the centers of the
+//full resolution pixels it spans, and its depth is written only once occluders cover all of them, with the farthest depth
+//they reach inside of the pixel. So the depth is never in front of what the full resolution pixel centers see, although
+//multisampled or supersampled rendering can still see through gaps narrower than a full resolution pixel.
+//Bounds are tested with their nearest depth against a hierarchy keeping the farthest depth of every 2x2 block
+class OcclusionCuller
+{
+public:
+    OcclusionCuller(JobSystem* const& jobSystem);
+
+    void SetResolution(const int& width, const int& height);
+
+    //Clears the depth buffer, occluders and tested bounds
+    void Begin(const ObjectMatrix& viewProjection);
+
+    //Part of the screen height covered by the bounds, 1 when the camera is inside of them
+    float GetScreenSize(const Bounds& bounds, const ObjectMatrix& world) const;
+
+    //positions are read every stride floats, neither positions nor indices are copied and have to outlive Rasterize
+    void AddOccluder(const float* const& positions, const size_t& verticesAmount, const size_t& stride, const uint32_t* const& indices, const size_t& indicesAmount, const ObjectMatrix& world);
+    void Rasterize();
+
+    //Returns index of the bounds, bounds crossing the near plane are never occluded
+    uint32_t Add(const Bounds& bounds, const ObjectMatrix& world);
+    void Test();
+
+    inline bool IsOccluded(const uint32_t& index) const { return m_occlusion[index] != 0; }
+    inline uint32_t GetOccludedAmount() const { return m_occludedAmount; }
+    inline uint32_t GetOccludersAmount() const { return (uint32_t)m_occluders.size(); }
+    inline size_t GetOccluderTrianglesAmount() const { return m_occluderTrianglesAmount; }
+
+    inline int GetWidth() const { return m_width; }
+    inline int GetHeight() const { return m_height; }
+    inline float GetDepth(const int& x, const int& y) const { return m_levels[0][(size_t)y * m_stride + x]; }
+
+private:
+    struct Occluder
+    {
+        //Model space, transformed while setting up triangles
+        const float* Positions;
+        size_t VerticesAmount;
+        size_t Stride;
+        const uint32_t* Indices;
+        size_t IndicesAmount;
+        ObjectMatrix WorldViewProjection;
+    };
+
+    //Edge functions E = A * x + B * y + C at pixel centers, positive inside
+    struct OccluderTriangle
+    {
+        float A[3];
+        float B[3];
+        float C[3];
+        //How much E changes from the pixel center to the farthest sample
+        float SampleRange[3];
+        //Farthest depth inside of the pixel, z = ZX * x + ZY * y + Z0
+        float ZX;
+        float ZY;
+        float Z0;
+        float ZMax;
+        int MinX;
+        int MinY;
+        int MaxX;
+        int MaxY;
+    };
+
+    void TransformVertices();
+    void SetupTriangles();
+    void ClipTriangle(const float* const (&vertices)[3], const int& outside, const int& job);
+    //Pixel x, y and depth
+    void ProjectVertex(const float* const& clip, float* const& screen) const;
+    void AddTriangle(const float* const (&vertices)[3], const int& job);
+    void RasterizeBand(const int& band);
+    void RasterizeTriangle(const OccluderTriangle& triangle, const int& firstY, const int& lastY);
+    //Pixels covered only partially by the triangle, edges are the edge functions at the pixel center
+    void AddCoverage(const OccluderTriangle& triangle, const int& x, const int& y, const float (&edges)[3]);
+    void BuildHierarchy();
+    bool TestBounds(const Bounds& bounds) const;
+
+    JobSystem* m_jobSystem;
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_stride = 0;
+    int m_bandsAmount = 0;
+
+    ObjectMatrix m_viewProjection;
+    float m_screenScale = 1.0f;
+
+    std::vector<Occluder> m_occluders;
+    //Per occluder offsets into clip space vertices and triangles
+    std::vector<size_t> m_verticesOffsets;
+    std::vector<size_t> m_trianglesOffsets;
+    std::vector<float> m_clipVertices;
+    std::vector<float> m_screenVertices;
+    //Bit per clipping plane the vertex is outside of
+    std::vector<uint8_t> m_clipCodes;
+    size_t m_occluderTrianglesAmount = 0;
+
+    //Every setup job owns its triangles and bins of bands
+    std::vector<std::vector<OccluderTriangle>> m_triangles;
+    std::vector<std::vector<std::vector<uint32_t>>> m_bins;
+
+    //Level 0 is the depth buffer with rows padded to a multiple of 4, the next ones halve it
+    std::vector<std::vector<float>> m_levels;
+    std::vector<int> m_levelsWidths;
+    std::vector<int> m_levelsHeights;
+    std::vector<int> m_levelsStrides;
+    //Samples covered so far in pixels which aren't fully covered yet, and the farthest depth of the triangles covering them
+    std::vector<uint16_t> m_coverage;
+    std::vector<float> m_pendingDepths;
+
+    //In the world space
+    std::vector<Bounds> m_bounds;
+    std::vector<uint8_t> m_occlusion;
+    uint32_t m_occludedAmount = 0;
+};
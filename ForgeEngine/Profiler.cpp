@@ -5,36 +5,57 @@
 #include "UIRenderingSystem.h"
 #include <string>
 #include "ProfilingSession.h"
+#include "D3D11GPUTimestampSource.h"
+#include "FakeGPUTimestampSource.h"
 #include <d3d11.h>
 #include <DirectXCommonClasses/Time.h>
 #include <sstream>
 #include "Core.h"
 #include <iostream>
 #include <fstream>
+#include <cassert>
+#include <cfloat>
 
 using namespace DirectX;
 using namespace std;
 
+thread_local ProfilingEventsRing* t_eventsRing = nullptr;
+
 Profiler::Profiler(const Window* const& window)
 {
     m_window = window;
+    m_mainThreadID = std::this_thread::get_id();
     QueryPerformanceFrequency(&m_CPUfrequency);
 
-    D3D11_QUERY_DESC desc;
-    desc.MiscFlags = 0;
-    desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+    //Null device never answers queries, GPU scopes of headless runs are reported as zeros
+    if (Core::IsHeadless())
+        m_gpuTimestampSource = new FakeGPUTimestampSource(0, m_gpuFrequency, 0);
+    else
+        m_gpuTimestampSource = new D3D11GPUTimestampSource(Core::GetD3Device(), Core::GetD3DeviceContext());
+    m_gpuTimestampRing = new GPUTimestampRing(m_gpuTimestampSource);
 
-    for (int i = 0; i < QUERY_LATENCY; ++i)
-        Core::GetD3Device()->CreateQuery(&desc, &m_queryJoints[i]);
+    t_eventsRing = RegisterEventsRing();
 }
 
 Profiler::~Profiler()
 {
+    for (auto& session : m_cpuProfilers)
+        delete session.second;
+
+    for (auto& session : m_gpuProfilers)
+        delete session.second;
+
+    delete m_gpuTimestampRing;
+    delete m_gpuTimestampSource;
+
+    for (ProfilingEventsRing* const& ring : m_eventsRings)
+        delete ring;
 }
 
 void Profiler::Initialize(const Window* const& window)
 {
     s_instance = new Profiler(window);
+    s_instance->CalibrateOverhead();
 }
 
 void Profiler::Release()
@@ -47,60 +68,48 @@ void Profiler::Draw()
     s_instance->OnDraw();
 }
 
-void Profiler::StartCPUProfiling(const std::string& name)
+void Profiler::StartCPUProfiling(const ProfilingScope& scope)
 {
-    static LARGE_INTEGER start, end;
-    QueryPerformanceCounter(&start);
-
-    s_instance->OnStartCPUProfiling(name);
-
-    QueryPerformanceCounter(&end);
-    s_instance->m_profilingTime += (double)(end.QuadPart - start.QuadPart);
+    BeginCPUScope(scope, false);
 }
 
-void Profiler::EndCPUProfiling(const std::string& name)
+void Profiler::EndCPUProfiling(const ProfilingScope& scope)
 {
-    static LARGE_INTEGER start, end;
-    QueryPerformanceCounter(&start);
-
-    s_instance->OnEndCPUProfiling(name);
-
-    QueryPerformanceCounter(&end);
-    s_instance->m_profilingTime += (double)(end.QuadPart - start.QuadPart);
+    EndCPUScope(scope, false);
 }
 
-void Profiler::StartGPUProfiling(const std::string& name)
+void Profiler::StartGPUProfiling(const ProfilingScope& scope)
 {
     static LARGE_INTEGER start, end;
     QueryPerformanceCounter(&start);
 
-    s_instance->OnStartGPUProfiling(name);
+    s_instance->OnStartGPUProfiling(scope);
 
     QueryPerformanceCounter(&end);
     s_instance->m_profilingTime += (double)(end.QuadPart - start.QuadPart);
 }
 
-void Profiler::EndGPUProfiling(const std::string& name)
+void Profiler::EndGPUProfiling(const ProfilingScope& scope)
 {
     static LARGE_INTEGER start, end;
     QueryPerformanceCounter(&start);
 
-    s_instance->OnEndGPUProfiling(name);
+    s_instance->OnEndGPUProfiling(scope);
 
     QueryPerformanceCounter(&end);
     s_instance->m_profilingTime += (double)(end.QuadPart - start.QuadPart);
 }
 
-void Profiler::StartProfiling(const std::string& name)
+void Profiler::StartProfiling(const ProfilingScope& scope)
 {
-    StartGPUProfiling(name);
-    StartCPUProfiling(name);
+    StartGPUProfiling(scope);
+    BeginCPUScope(scope, true);
 }
 
-void Profiler::EndProfiling(const std::string& name)
+void Profiler::EndProfiling(const ProfilingScope& scope)
 {
-    EndCPUProfiling(name);
-    EndGPUProfiling(name);
+    EndCPUScope(scope, true);
+    EndGPUProfiling(scope);
 }
 
 void Profiler::StartFrame()
@@ -122,6 +131,42 @@ void Profiler::EndFrame()
     s_instance->OnEndFrame();
 }
 
+void Profiler::RequestTraceCapture(std::string fileName, const int& framesAmount)
+{
+    s_instance->m_traceFileName = fileName;
+    s_instance->m_traceFramesAmount = framesAmount;
+}
+
+void Profiler::RequestTimeSeriesRecording(std::string fileName)
+{
+    s_instance->m_timeSeriesFileName = fileName;
+}
+
+void Profiler::StopTimeSeriesRecording()
+{
+    if (s_instance->m_timeSeriesRecorder.IsOpen() && s_instance->m_timeSeriesLastFrame < 0)
+        s_instance->m_timeSeriesLastFrame = s_instance->m_framesCounter;
+}
+
+bool Profiler::IsRecordingTimeSeries()
+{
+    return s_instance->m_timeSeriesRecorder.IsOpen() && s_instance->m_timeSeriesLastFrame < 0;
+}
+
+void Profiler::SetCounter(const std::string& name, const double& value)
+{
+    for (auto& counter : s_instance->m_counters)
+    {
+        if (counter.first == name)
+        {
+            counter.second = value;
+            return;
+        }
+    }
+
+    s_instance->m_counters.push_back({ name, value });
+}
+
 void Profiler::Reset()
 {
     s_instance->m_resetRequested = true;
@@ -129,61 +174,107 @@ void Profiler::Reset()
 
 Profiler* Profiler::s_instance;
 
-void Profiler::OnStartCPUProfiling(const std::string& name)
+void Profiler::BeginCPUScope(const ProfilingScope& scope, const bool& withGPU)
 {
-    auto found = m_cpuProfilers.find(name);
+    LARGE_INTEGER start, timestamp;
+    QueryPerformanceCounter(&start);
 
-    ProfilingSession* session;
+    ProfilingEventsRing* const ring = GetEventsRingForCurrentThread();
 
-    if (found == m_cpuProfilers.end())
-    {
-        session = m_cpuProfilers.emplace(name, new CPUProfilingSession(SAMPLES_AMOUNT)).first->second;
-    }
-    else
-        session = found->second;
+    QueryPerformanceCounter(&timestamp);
+    ring->Push({ scope.ID, ProfilingEventType::Begin, scope.Name, timestamp.QuadPart, withGPU, GetThreadAllocationCounters() });
+    ring->AddProfilingTime(timestamp.QuadPart - start.QuadPart);
+}
+
+void Profiler::EndCPUScope(const ProfilingScope& scope, const bool& withGPU)
+{
+    LARGE_INTEGER timestamp, end;
+    QueryPerformanceCounter(&timestamp);
 
-    session->OnStartProfiling(m_currentCPUSession, m_cpuOrderCounter++);
+    ProfilingEventsRing* const ring = GetEventsRingForCurrentThread();
+    ring->Push({ scope.ID, ProfilingEventType::End, scope.Name, timestamp.QuadPart, withGPU, GetThreadAllocationCounters() });
 
-    m_currentCPUSession = session;
+    QueryPerformanceCounter(&end);
+    ring->AddProfilingTime(end.QuadPart - timestamp.QuadPart);
 }
 
-void Profiler::OnEndCPUProfiling(const std::string& name)
+ProfilingEventsRing* Profiler::GetEventsRingForCurrentThread()
 {
-    ProfilingSession* session = m_cpuProfilers[name];
+    if (t_eventsRing == nullptr)
+        t_eventsRing = s_instance->RegisterEventsRing();
+
+    return t_eventsRing;
+}
 
-    assert(m_currentCPUSession == session);
+ProfilingEventsRing* Profiler::RegisterEventsRing()
+{
+    std::lock_guard<std::mutex> lock(m_eventsRingsMutex);
 
-    m_currentCPUSession = m_currentCPUSession->GetParent();
-    session->OnEndProfiling();
+    ProfilingEventsRing* ring = new ProfilingEventsRing((uint32_t)m_eventsRings.size());
+    ring->OpenScopes.reserve(64);
+    m_eventsRings.push_back(ring);
+
+    return ring;
 }
 
-void Profiler::OnStartGPUProfiling(const std::string& name)
+void Profiler::CalibrateOverhead()
 {
-    auto found = m_gpuProfilers[m_framesCounter % QUERY_LATENCY].find(name);
+    //Minimum of a few batches, so the result isn't skewed by preemption
+    const ProfilingScope scope = PROFILING_SCOPE("Overhead calibration");
+    ProfilingEventsRing* const ring = GetEventsRingForCurrentThread();
+
+    m_scopeOverhead = DBL_MAX;
+    m_scopeSelfOverhead = DBL_MAX;
+    m_gpuQueryOverhead = DBL_MAX;
 
-    ProfilingSession* session;
+    const GPUQueryHandle query = m_gpuTimestampSource->CreateQuery(GPUQueryType::Timestamp);
 
-    if (found == m_gpuProfilers[m_framesCounter % QUERY_LATENCY].end())
+    for (int i = 0; i < OVERHEAD_CALIBRATION_BATCHES; ++i)
     {
-        session = m_gpuProfilers[m_framesCounter % QUERY_LATENCY].emplace(name, new GPUProfilingSession(SAMPLES_AMOUNT)).first->second;
-    }
-    else
-        session = found->second;
+        LARGE_INTEGER start, end;
+        QueryPerformanceCounter(&start);
+
+        for (int j = 0; j < OVERHEAD_CALIBRATION_SCOPES; ++j)
+        {
+            BeginCPUScope(scope, false);
+            EndCPUScope(scope, false);
+        }
+
+        QueryPerformanceCounter(&end);
+        m_scopeOverhead = min(m_scopeOverhead, (double)(end.QuadPart - start.QuadPart) / OVERHEAD_CALIBRATION_SCOPES);
 
-    session->OnStartProfiling(m_currentGPUSession, m_gpuOrderCounter++);
+        int64_t selfTicks = 0;
+        ProfilingEvent begin, finish;
 
-    m_currentGPUSession = session;
+        while (ring->Pop(begin) && ring->Pop(finish))
+            selfTicks += finish.Timestamp - begin.Timestamp;
+
+        m_scopeSelfOverhead = min(m_scopeSelfOverhead, (double)selfTicks / OVERHEAD_CALIBRATION_SCOPES);
+
+        QueryPerformanceCounter(&start);
+
+        for (int j = 0; j < OVERHEAD_CALIBRATION_SCOPES; ++j)
+            m_gpuTimestampSource->End(query);
+
+        QueryPerformanceCounter(&end);
+        m_gpuQueryOverhead = min(m_gpuQueryOverhead, (double)(end.QuadPart - start.QuadPart) / OVERHEAD_CALIBRATION_SCOPES);
+    }
+
+    ring->ConsumeProfilingTime();
 }
 
-void Profiler::OnEndGPUProfiling(const std::string& name)
+void Profiler::OnStartGPUProfiling(const ProfilingScope& scope)
 {
-    ProfilingSession* session = m_gpuProfilers[m_framesCounter % QUERY_LATENCY][name];
+    assert(std::this_thread::get_id() == m_mainThreadID);
 
-    assert(m_currentGPUSession == session);
+    m_gpuTimestampRing->Record(scope, ProfilingEventType::Begin);
+}
 
-    m_currentGPUSession = session->GetParent();
-    session->OnEndProfiling();
+void Profiler::OnEndGPUProfiling(const ProfilingScope& scope)
+{
+    assert(std::this_thread::get_id() == m_mainThreadID);
 
+    m_gpuTimestampRing->Record(scope, ProfilingEventType::End);
 }
 
 void Profiler::OnDraw()
@@ -193,13 +284,18 @@ void Profiler::OnDraw()
 
 void Profiler::OnStartFrame()
 {
-    m_currentCPUSession = nullptr;
-    m_cpuOrderCounter = 0;
-    m_gpuOrderCounter = 0;
-
     ++m_framesCounter;
 
-    Core::GetD3DeviceContext()->Begin(m_queryJoints[m_framesCounter % QUERY_LATENCY]);
+    if (!m_traceFileName.empty())
+        StartTraceCapture();
+
+    if (!m_timeSeriesFileName.empty())
+        StartTimeSeriesRecording();
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    m_gpuTimestampRing->BeginFrame(m_framesCounter, now.QuadPart);
 }
 
 void Profiler::OnEndFrame()
@@ -207,60 +303,228 @@ void Profiler::OnEndFrame()
     static LARGE_INTEGER start, end;
     QueryPerformanceCounter(&start);
 
-    Core::GetD3DeviceContext()->End(m_queryJoints[m_framesCounter % QUERY_LATENCY]);
+    m_gpuTimestampRing->EndFrame();
+
+    DrainCPUEvents();
+    UpdateFramePacing(start.QuadPart);
+    HarvestGPUFrames();
+
+    UpdateTraceCapture();
+    UpdateTimeSeriesRecording();
+
+    m_tmpTime += Time::GetDeltaTime();
+    ++m_tmpFramesCounter;
+
+    if (m_tmpTime > 1.0f)
+    {
+        m_currentFPS = (int)(m_tmpFramesCounter / m_tmpTime);
+        m_currentFrameDuration = 1000.0f * m_tmpTime / m_tmpFramesCounter;
+        m_currentFrameDuration = (int)(m_currentFrameDuration * 1000) / 1000.0f;
+        m_tmpTime = 0.0f;
+        m_tmpFramesCounter = 0;
+    }
+
+    if (!m_logsFileName.empty())
+    {
+        SaveLogsToFile(m_logsFileName);
+        m_logsFileName = "";
+    }
+
+    PrepareLogsToPrintOnScreen();
 
     QueryPerformanceCounter(&end);
     m_profilingTime += (double)(end.QuadPart - start.QuadPart);
+}
+
+void Profiler::DrainCPUEvents()
+{
+    std::lock_guard<std::mutex> lock(m_eventsRingsMutex);
+
+    const bool tracing = IsTracingFrame(m_framesCounter);
+
+    for (; tracing && m_tracedThreadsAmount < m_eventsRings.size(); ++m_tracedThreadsAmount)
+    {
+        m_traceWriter.WriteThreadName(TRACE_CPU_PID, (uint32_t)m_tracedThreadsAmount, m_tracedThreadsAmount == 0 ? "Main thread" : "Worker " + std::to_string(m_tracedThreadsAmount));
+    }
+
+    for (ProfilingEventsRing* const& ring : m_eventsRings)
+    {
+        ProfilingEvent event;
+        while (ring->Pop(event))
+        {
+            ProcessEvent(event, ring->OpenScopes, m_cpuProfilers, m_cpuRootProfilers, true);
 
-    Profiler::StartCPUProfiling("Waiting for GPU");
+            if (!tracing)
+                continue;
 
-    Core::GetD3DeviceContext()->Flush();
+            if (event.Type == ProfilingEventType::Begin)
+                m_traceWriter.WriteBegin(TRACE_CPU_PID, ring->GetThreadIndex(), event.Name, GetTraceTime(event.Timestamp));
+            else
+                m_traceWriter.WriteEnd(TRACE_CPU_PID, ring->GetThreadIndex(), event.Name, GetTraceTime(event.Timestamp));
+        }
 
-    while (Core::GetD3DeviceContext()->GetData(m_queryJoints[(m_framesCounter + 1) % QUERY_LATENCY], NULL, 0, 0) == S_FALSE);
+        m_profilingTime += (double)ring->ConsumeProfilingTime();
 
-    Profiler::EndCPUProfiling("Waiting for GPU");
+        if (ring->ConsumeDroppedEvents() > 0)
+            DebugLog::LogError("Profiler events ring overflow on thread " + std::to_string(ring->GetThreadIndex()) + "!");
+    }
 
-    QueryPerformanceCounter(&start);
+    for (auto& session : m_cpuProfilers)
+        session.second->OnEndFrame();
 
-    D3D10_QUERY_DATA_TIMESTAMP_DISJOINT tsDisjoint;
-    Core::GetD3DeviceContext()->GetData(m_queryJoints[(m_framesCounter + 1) % QUERY_LATENCY], &tsDisjoint, sizeof(tsDisjoint), 0);
-    if (tsDisjoint.Disjoint && m_framesCounter > QUERY_LATENCY - 1)
-        DebugLog::LogError("Profiler GPU Query found disjoint!");
-    else
+    RecordTimeSeriesFrame(TimeSeriesTrack::CPU, m_framesCounter, m_cpuProfilers, (UINT64)m_CPUfrequency.QuadPart);
+}
+
+void Profiler::UpdateFramePacing(const int64_t& timestamp)
+{
+    if (!m_framePacing.AddFrame(m_framesCounter, timestamp, m_CPUfrequency.QuadPart))
+        return;
+
+    const ProfilingSession* scope = FindGrownScope();
+
+    if (scope)
+        m_framePacing.AttributeLastHitch(scope->GetPath(), (float)(1000.0 * scope->GetLastFrameGrowth() / m_CPUfrequency.QuadPart));
+}
+
+const ProfilingSession* Profiler::FindGrownScope() const
+{
+    const ProfilingSession* result = nullptr;
+    const std::vector<ProfilingSession*>* candidates = &m_cpuRootProfilers;
+
+    //Descend as long as a single child explains most of its parent's growth
+    while (true)
     {
-        for (auto const& session : m_cpuProfilers)
+        const ProfilingSession* grown = nullptr;
+
+        for (const ProfilingSession* const& session : *candidates)
         {
-            session.second->OnEndFrame();
+            if (session->GetLastFrameGrowth() > 0.0 && (!grown || session->GetLastFrameGrowth() > grown->GetLastFrameGrowth()))
+                grown = session;
         }
 
-        for (auto const& session : m_gpuProfilers[(m_framesCounter + 1) % QUERY_LATENCY])
+        if (!grown || (result && grown->GetLastFrameGrowth() < HITCH_SCOPE_GROWTH_SHARE * result->GetLastFrameGrowth()))
+            return result;
+
+        result = grown;
+        candidates = &grown->GetChildren();
+    }
+}
+
+void Profiler::HarvestGPUFrames()
+{
+    while (GPUProfilingFrame* frame = m_gpuTimestampRing->PopResolvedFrame())
+    {
+        if (frame->IsDisjoint)
         {
-            session.second->OnEndFrame();
+            DebugLog::LogError("Profiler GPU Query found disjoint!");
+            m_traceGPUAligned = false;
+            continue;
         }
+
+        m_gpuFrequency = frame->Frequency;
+        ResolveGPUFrame(*frame);
     }
 
-    m_tmpTime += Time::GetDeltaTime();
-    ++m_tmpFramesCounter;
+    if (m_gpuTimestampRing->ConsumeDroppedFrames() > 0)
+    {
+        DebugLog::LogError("Profiler dropped GPU frames, GPU is more than " + std::to_string(GPU_FRAMES_IN_FLIGHT) + " frames behind!");
+        m_traceGPUAligned = false;
+    }
+}
 
-    if (m_tmpTime > 1.0f)
+void Profiler::ResolveGPUFrame(GPUProfilingFrame& frame)
+{
+    const bool tracing = IsTracingFrame(frame.FrameIndex);
+
+    for (const ProfilingEvent& event : frame.Events)
     {
-        m_currentFPS = (int)(m_tmpFramesCounter / m_tmpTime);
-        m_currentFrameDuration = 1000.0f * m_tmpTime / m_tmpFramesCounter;
-        m_currentFrameDuration = (int)(m_currentFrameDuration * 1000) / 1000.0f;
-        m_tmpTime = 0.0f;
-        m_tmpFramesCounter = 0;
+        ProcessEvent(event, m_gpuOpenScopes, m_gpuProfilers, m_gpuRootProfilers, false);
+
+        if (!tracing)
+            continue;
+
+        //GPU clock isn't synchronized with QPC, so its track is aligned once to the CPU start of the first traced frame
+        const double gpuTime = 1000000.0 * (double)event.Timestamp / frame.Frequency;
+
+        if (!m_traceGPUAligned)
+        {
+            m_traceGPUOffset = GetTraceTime(frame.CPUStartTimestamp) - gpuTime;
+            m_traceGPUAligned = true;
+        }
+
+        if (event.Type == ProfilingEventType::Begin)
+            m_traceWriter.WriteBegin(TRACE_GPU_PID, 0, event.Name, gpuTime + m_traceGPUOffset);
+        else
+            m_traceWriter.WriteEnd(TRACE_GPU_PID, 0, event.Name, gpuTime + m_traceGPUOffset);
     }
 
-    if (!m_logsFileName.empty())
+    frame.Events.clear();
+
+    for (auto& session : m_gpuProfilers)
+        session.second->OnEndFrame();
+
+    RecordTimeSeriesFrame(TimeSeriesTrack::GPU, frame.FrameIndex, m_gpuProfilers, frame.Frequency);
+}
+
+void Profiler::ProcessEvent(const ProfilingEvent& event, std::vector<OpenProfilingScope>& openScopes, std::unordered_map<ProfilingPathID, ProfilingSession*>& sessions, std::vector<ProfilingSession*>& roots, const bool& subtractOverhead)
+{
+    if (event.Type == ProfilingEventType::Begin)
     {
-        SaveLogsToFile(m_logsFileName, tsDisjoint.Frequency);
-        m_logsFileName = "";
+        ProfilingSession* const parent = openScopes.empty() ? nullptr : openScopes.back().Session;
+        const ProfilingPathID pathID = CombineProfilingPath(parent ? parent->GetPathID() : PROFILING_ROOT_PATH, event.ID);
+
+        auto found = sessions.find(pathID);
+
+        ProfilingSession* session;
+
+        if (found == sessions.end())
+        {
+            session = sessions.emplace(pathID, new ProfilingSession(event.Name, parent, pathID, SAMPLES_AMOUNT)).first->second;
+
+            if (!parent)
+                roots.push_back(session);
+        }
+        else
+            session = found->second;
+
+        openScopes.push_back({ event, session, 0.0, { 0, 0 } });
+
+        return;
     }
 
-    PrepareLogsToPrintOnScreen(tsDisjoint.Frequency);
+    //Unbalanced scopes are possible only when the ring overflowed
+    if (openScopes.empty() || openScopes.back().Begin.ID != event.ID)
+        return;
 
-    QueryPerformanceCounter(&end);
-    m_profilingTime += (double)(end.QuadPart - start.QuadPart);
+    const OpenProfilingScope& closed = openScopes.back();
+    const double result = (double)(event.Timestamp - closed.Begin.Timestamp);
+    double correctedResult = result;
+    double overhead = 0.0;
+
+    if (subtractOverhead)
+    {
+        correctedResult = max(0.0, result - m_scopeSelfOverhead - closed.NestedOverhead);
+        overhead = closed.NestedOverhead + m_scopeOverhead + (closed.Begin.WithGPU ? 2.0 * m_gpuQueryOverhead : 0.0);
+    }
+
+    //Unsigned differences stay valid when the counters wrap around
+    AllocationCounters allocations;
+    allocations.Allocations = event.Allocations.Allocations - closed.Begin.Allocations.Allocations;
+    allocations.Bytes = event.Allocations.Bytes - closed.Begin.Allocations.Bytes;
+
+    AllocationCounters selfAllocations;
+    selfAllocations.Allocations = allocations.Allocations - closed.NestedAllocations.Allocations;
+    selfAllocations.Bytes = allocations.Bytes - closed.NestedAllocations.Bytes;
+
+    closed.Session->OnEndProfiling(result, correctedResult, allocations, selfAllocations);
+    openScopes.pop_back();
+
+    if (!openScopes.empty())
+    {
+        openScopes.back().NestedOverhead += overhead;
+        openScopes.back().NestedAllocations.Allocations += allocations.Allocations;
+        openScopes.back().NestedAllocations.Bytes += allocations.Bytes;
+    }
 }
 
 void Profiler::OnReset()
@@ -270,27 +534,108 @@ void Profiler::OnReset()
     m_tmpTime = 0.0f;
     m_tmpFramesCounter = 0;
 
+    m_framePacing.Reset();
+
     for (auto& p : m_cpuProfilers)
     {
         p.second->Reset();
     }
 
-    for (int i = 0; i < QUERY_LATENCY; ++i)
+    for (auto& p : m_gpuProfilers)
     {
-        for (auto& p : m_gpuProfilers[i])
-        {
-            p.second->Reset();
-        }
+        p.second->Reset();
     }
 }
 
-void Profiler::SaveLogsToFile(const std::string& fileName, const UINT64& gpuFreq)
+void Profiler::StartTraceCapture()
 {
-    std::string str = Core::GetResultsPath() + "/" + fileName + ".csv";
+    std::string str = Core::GetResultsPath() + "/" + m_traceFileName + ".json";
+    m_traceFileName = "";
+
+    CreateDirectoriesForFile(str);
+
+    if (!m_traceWriter.Open(str))
+    {
+        DebugLog::LogError("Couldn't open trace file: " + str);
+        return;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    m_traceFirstFrame = m_framesCounter;
+    m_traceStartTicks = now.QuadPart;
+    m_traceGPUAligned = false;
+    m_tracedThreadsAmount = 0;
+
+    m_traceWriter.WriteProcessName(TRACE_CPU_PID, "CPU");
+    m_traceWriter.WriteProcessName(TRACE_GPU_PID, "GPU");
+    m_traceWriter.WriteThreadName(TRACE_GPU_PID, 0, "Immediate context");
+}
+
+void Profiler::UpdateTraceCapture()
+{
+    //GPU results of the last traced frame arrive a few frames after its CPU part
+    if (m_traceWriter.IsOpen() && m_gpuTimestampRing->GetLastRetiredFrameIndex() >= m_traceFirstFrame + m_traceFramesAmount - 1)
+        m_traceWriter.Close();
+}
+
+bool Profiler::IsTracingFrame(const int& frameIndex) const
+{
+    return m_traceWriter.IsOpen() && frameIndex >= m_traceFirstFrame && frameIndex < m_traceFirstFrame + m_traceFramesAmount;
+}
+
+double Profiler::GetTraceTime(const int64_t& cpuTicks) const
+{
+    return 1000000.0 * (double)(cpuTicks - m_traceStartTicks) / m_CPUfrequency.QuadPart;
+}
+
+void Profiler::StartTimeSeriesRecording()
+{
+    std::string str = Core::GetResultsPath() + "/" + m_timeSeriesFileName + ".fts";
+    m_timeSeriesFileName = "";
+
+    CreateDirectoriesForFile(str);
+
+    if (!m_timeSeriesRecorder.Open(str))
+    {
+        DebugLog::LogError("Couldn't open time series file: " + str);
+        return;
+    }
+
+    m_timeSeriesFirstFrame = m_framesCounter;
+    m_timeSeriesLastFrame = -1;
+}
+
+void Profiler::UpdateTimeSeriesRecording()
+{
+    //Waits for the GPU part of the last recorded frame
+    if (m_timeSeriesRecorder.IsOpen() && m_timeSeriesLastFrame >= 0 && m_gpuTimestampRing->GetLastRetiredFrameIndex() >= m_timeSeriesLastFrame)
+    {
+        m_timeSeriesRecorder.Close();
+        m_timeSeriesLastFrame = -1;
+    }
+}
 
+void Profiler::RecordTimeSeriesFrame(const TimeSeriesTrack& track, const int& frameIndex, const std::unordered_map<ProfilingPathID, ProfilingSession*>& sessions, const UINT64& freq)
+{
+    if (!m_timeSeriesRecorder.IsOpen() || frameIndex < m_timeSeriesFirstFrame || (m_timeSeriesLastFrame >= 0 && frameIndex > m_timeSeriesLastFrame))
+        return;
+
+    m_timeSeriesRecorder.BeginFrame(track, frameIndex);
+
+    for (const auto& session : sessions)
+    {
+        if (session.second->GetLastFrameInvocations() > 0)
+            m_timeSeriesRecorder.Record(track, session.first, session.second->GetPath(), (float)(1000.0 * session.second->GetLastFrameResult() / freq));
+    }
+}
+
+void Profiler::CreateDirectoriesForFile(const std::string& path)
+{
     char drive[_MAX_DRIVE];
     char dir[_MAX_DIR];
-    _splitpath_s(str.c_str(), drive, _MAX_DRIVE, &dir[0], _MAX_DIR, nullptr, 0, nullptr, 0);
+    _splitpath_s(path.c_str(), drive, _MAX_DRIVE, &dir[0], _MAX_DIR, nullptr, 0, nullptr, 0);
     std::string dirStr(dir);
     for (size_t i = dirStr.find('/', 1); i - 1 != std::string::npos; i = dirStr.find('/', i) + 1)
     {
@@ -298,13 +643,22 @@ void Profiler::SaveLogsToFile(const std::string& fileName, const UINT64& gpuFreq
         CreateDirectory(LPCSTR(driveDir.c_str()), NULL);
     }
     CreateDirectory(LPCSTR((std::string(drive) + dirStr).c_str()), NULL);
+}
+
+void Profiler::SaveLogsToFile(const std::string& fileName)
+{
+    std::string str = Core::GetResultsPath() + "/" + fileName + ".csv";
+
+    CreateDirectoriesForFile(str);
 
     std::ofstream outFile(str);
 
     outFile << "FPS" << "," << m_currentFPS << "\n";
     outFile << "Frame" << "," << m_currentFrameDuration << "\n";
+    outFile << "Frame p99" << "," << m_framePacing.GetStatistics().GetPercentile(99.0) / 1000.0 << "\n";
+    outFile << "Hitches" << "," << m_framePacing.GetHitchesAmount() << "\n";
 
-    outFile << GetProfilersInCSVFormat(m_cpuProfilers.begin(), m_cpuProfilers.end(), (int)m_cpuProfilers.size(), (UINT64)m_CPUfrequency.QuadPart);
+    outFile << GetProfilersInCSVFormat(m_cpuRootProfilers, (UINT64)m_CPUfrequency.QuadPart);
 
     m_profilingTime = 1000.0f * m_profilingTime / m_CPUfrequency.QuadPart;
     m_profilingTime = (int)(m_profilingTime * 1000) / 1000.0f;
@@ -312,20 +666,44 @@ void Profiler::SaveLogsToFile(const std::string& fileName, const UINT64& gpuFreq
     outFile << "\nProfiling time," << m_profilingTime;
     m_profilingTime = 0.0f;
 
+    outFile << "\nScope overhead (us)," << 1000000.0 * m_scopeOverhead / m_CPUfrequency.QuadPart;
+    outFile << "\nGPU query overhead (us)," << 1000000.0 * m_gpuQueryOverhead / m_CPUfrequency.QuadPart;
+
+    outFile << "\n\nCOUNTERS:";
+
+    for (const auto& counter : m_counters)
+        outFile << "\n" << counter.first << "," << counter.second;
+
     outFile << "\n\nGPU PROFILING:";
 
-    outFile << GetProfilersInCSVFormat(m_gpuProfilers[(m_framesCounter + 1) % QUERY_LATENCY].begin(), m_gpuProfilers[(m_framesCounter + 1) % QUERY_LATENCY].end(), (int)m_gpuProfilers[m_framesCounter % QUERY_LATENCY].size(), gpuFreq);
+    outFile << GetProfilersInCSVFormat(m_gpuRootProfilers, m_gpuFrequency);
+
+    std::ofstream pacingFile(Core::GetResultsPath() + "/" + fileName + "_pacing.json");
+    m_framePacing.WriteReport(pacingFile);
 }
 
-void Profiler::PrepareLogsToPrintOnScreen(const UINT64& gpuFreq)
+void Profiler::PrepareLogsToPrintOnScreen()
 {
     static stringstream ss;
     ss.str(string());
 
     ss << "FPS: " << m_currentFPS << " (" << m_currentFrameDuration << "ms)";
+
+    const StreamingStatistics& pacing = m_framePacing.GetStatistics();
+    ss << "\nFrame pacing: median " << m_framePacing.GetRollingMedian() << "ms";
+    ss << " p99 " << pacing.GetPercentile(99.0) / 1000.0 << "ms";
+    ss << " max " << pacing.GetMax() / 1000.0 << "ms";
+    ss << " hitches " << m_framePacing.GetHitchesAmount();
+
+    if (!m_framePacing.GetHitches().empty())
+    {
+        const FrameHitch& hitch = m_framePacing.GetHitches().back();
+        ss << " (last: frame " << hitch.FrameIndex << " " << hitch.DurationMs << "ms";
+        ss << (hitch.Scope.empty() ? "" : " in " + hitch.Scope) << ")";
+    }
     ss << "\n\nCPU PROFILING:";;
 
-    ss << GetProfilersInHierarchy(m_cpuProfilers.begin(), m_cpuProfilers.end(), (int)m_cpuProfilers.size(), (UINT64)m_CPUfrequency.QuadPart);
+    ss << GetProfilersInHierarchy(m_cpuRootProfilers, (UINT64)m_CPUfrequency.QuadPart);
 
     m_profilingTime = 1000.0f * m_profilingTime / m_CPUfrequency.QuadPart;
     m_profilingTime = (int)(m_profilingTime * 1000) / 1000.0f;
@@ -335,78 +713,127 @@ void Profiler::PrepareLogsToPrintOnScreen(const UINT64& gpuFreq)
 
     ss << "\n\nGPU PROFILING:";
 
-    ss << GetProfilersInHierarchy(m_gpuProfilers[(m_framesCounter + 1) % QUERY_LATENCY].begin(), m_gpuProfilers[(m_framesCounter + 1) % QUERY_LATENCY].end(), (int)m_gpuProfilers[m_framesCounter % QUERY_LATENCY].size(), gpuFreq);
+    ss << GetProfilersInHierarchy(m_gpuRootProfilers, m_gpuFrequency);
+
+    if (!m_counters.empty())
+        ss << "\n\nCOUNTERS:";
+
+    for (const auto& counter : m_counters)
+        ss << "\n" << counter.first << ": " << counter.second;
 
     m_cachedScreenLogs = ss.str();
 }
 
-std::string Profiler::GetProfilersInHierarchy(std::unordered_map<std::string, ProfilingSession*>::iterator begin, std::unordered_map<std::string, ProfilingSession*>::iterator end, const int& length, const UINT64& freq)
+double Profiler::TicksToMs(const double& ticks, const UINT64& freq)
 {
-    std::string* arr = new std::string[length];
+    const double result = ticks / (freq / 1000);
+    return (int)(result * 1000) / 1000.0;
+}
 
+std::string Profiler::GetProfilersInHierarchy(const std::vector<ProfilingSession*>& roots, const UINT64& freq)
+{
     static stringstream ss;
+    ss.str(string());
+
+    std::vector<const ProfilingSession*> stack(roots.rbegin(), roots.rend());
 
-    auto it = begin;
-    while (it != end)
+    while (!stack.empty())
     {
-        ss.str(string());
+        const ProfilingSession* session = stack.back();
+        stack.pop_back();
 
-        static double result;
-        result = it->second->GetAverageResult() / (freq / 1000);
-        result = (int)(result * 1000) / 1000.0;
+        for (auto it = session->GetChildren().rbegin(); it != session->GetChildren().rend(); ++it)
+            stack.push_back(*it);
 
-        const ProfilingSession* prof = it->second;
-        while ((prof = prof->GetParent()) && prof->GetParent())
-        {
+        const StreamingStatistics& stats = session->GetRecentStatistics();
+
+        ss << "\n";
+
+        for (int i = 1; i < session->GetDepth(); ++i)
             ss << "|        ";
-        }
 
-        if (it->second->GetParent())
+        if (session->GetParent())
             ss << "|-----";
 
-        ss << it->first << ": " << result << "ms";
+        ss << session->GetName() << ": " << TicksToMs(stats.GetMean(), freq) << "ms";
+        ss << " (p50 " << TicksToMs(stats.GetPercentile(50.0), freq);
+        ss << " p95 " << TicksToMs(stats.GetPercentile(95.0), freq);
+        ss << " p99 " << TicksToMs(stats.GetPercentile(99.0), freq);
+        ss << " min " << TicksToMs(stats.GetMin(), freq);
+        ss << " max " << TicksToMs(stats.GetMax(), freq);
+        ss << " sd " << TicksToMs(stats.GetStandardDeviation(), freq) << ")";
 
-        arr[it->second->GetOrder()] = ss.str();
-        ++it;
-    }
-
-    ss.str(string());
+        if (session->GetLastFrameInvocations() > 1)
+        {
+            const StreamingStatistics& invocationStats = session->GetInvocationStatistics();
 
-    for (int i = 0; i < length; ++i)
-        ss << "\n" << arr[i];
+            ss << " x" << session->GetLastFrameInvocations();
+            ss << " (avg " << TicksToMs(invocationStats.GetMean(), freq);
+            ss << " max " << TicksToMs(invocationStats.GetMax(), freq) << ")";
+        }
 
-    delete[] arr;
+#ifdef TRACK_ALLOCATIONS
+        if (session->GetLastFrameAllocations().Allocations > 0)
+        {
+            ss << " allocs " << session->GetLastFrameAllocations().Allocations;
+            ss << " (self " << session->GetLastFrameSelfAllocations().Allocations << ")";
+            ss << " " << session->GetLastFrameAllocations().Bytes / 1024.0 << "KB";
+        }
+#endif
+    }
 
     return ss.str();
 }
 
-std::string Profiler::GetProfilersInCSVFormat(std::unordered_map<std::string, ProfilingSession*>::iterator begin, std::unordered_map<std::string, ProfilingSession*>::iterator end, const int& length, const UINT64& freq)
+std::string Profiler::GetProfilersInCSVFormat(const std::vector<ProfilingSession*>& roots, const UINT64& freq)
 {
-    std::string* arr = new std::string[length];
-
     static stringstream ss;
-
-    auto it = begin;
-    while (it != end)
-    {
-        ss.str(string());
-
-        static double result;
-        result = it->second->GetAverageResult() / (freq / 1000);
-        result = (int)(result * 1000) / 1000.0;
-
-        ss << it->first << "," << result;
-
-        arr[it->second->GetOrder()] = ss.str();
-        ++it;
-    }
-
     ss.str(string());
+    ss << "\n" << CSV_STATISTICS_HEADER;
 
-    for (int i = 0; i < length; ++i)
-        ss << "\n" << arr[i];
+    std::vector<const ProfilingSession*> stack(roots.rbegin(), roots.rend());
 
-    delete[] arr;
+    while (!stack.empty())
+    {
+        const ProfilingSession* session = stack.back();
+        stack.pop_back();
+
+        for (auto it = session->GetChildren().rbegin(); it != session->GetChildren().rend(); ++it)
+            stack.push_back(*it);
+
+        const StreamingStatistics& stats = session->GetStatistics();
+
+        ss << "\n" << session->GetPath();
+        ss << "," << TicksToMs(stats.GetMean(), freq);
+        ss << "," << TicksToMs(stats.GetStandardDeviation(), freq);
+        ss << "," << TicksToMs(stats.GetMin(), freq);
+        ss << "," << TicksToMs(stats.GetMax(), freq);
+        ss << "," << TicksToMs(stats.GetPercentile(50.0), freq);
+        ss << "," << TicksToMs(stats.GetPercentile(95.0), freq);
+        ss << "," << TicksToMs(stats.GetPercentile(99.0), freq);
+        ss << "," << stats.GetCount();
+
+        const StreamingStatistics& rawStats = session->GetRawStatistics();
+
+        ss << "," << TicksToMs(rawStats.GetMean(), freq);
+        ss << "," << TicksToMs(rawStats.GetStandardDeviation(), freq);
+        ss << "," << TicksToMs(rawStats.GetMin(), freq);
+        ss << "," << TicksToMs(rawStats.GetMax(), freq);
+        ss << "," << TicksToMs(rawStats.GetPercentile(50.0), freq);
+        ss << "," << TicksToMs(rawStats.GetPercentile(95.0), freq);
+        ss << "," << TicksToMs(rawStats.GetPercentile(99.0), freq);
+
+        const StreamingStatistics& invocationStats = session->GetInvocationStatistics();
+
+        ss << "," << session->GetAverageInvocations();
+        ss << "," << TicksToMs(invocationStats.GetMean(), freq);
+        ss << "," << TicksToMs(invocationStats.GetMax(), freq);
+
+        ss << "," << session->GetAverageAllocations();
+        ss << "," << session->GetAverageAllocatedBytes();
+        ss << "," << session->GetAverageSelfAllocations();
+        ss << "," << session->GetAverageSelfAllocatedBytes();
+    }
 
     return ss.str();
-}
+}
\ No newline at end of file
@@ -2,22 +2,35 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <mutex>
+#include <thread>
 #include <Windows.h>
+#include "ProfilingEvents.h"
+#include "ChromeTraceWriter.h"
+#include "GPUTimestampRing.h"
+#include "TimeSeriesRecorder.h"
+#include "FramePacing.h"
 
 #define SAMPLES_AMOUNT 500
 
-#define QUERY_LATENCY 5
-
 #define PA_TEXT_SIZE 15.0f
+#define CSV_STATISTICS_HEADER "Name,Mean,StdDev,Min,Max,P50,P95,P99,Samples,RawMean,RawStdDev,RawMin,RawMax,RawP50,RawP95,RawP99,Invocations,InvocationMean,InvocationMax,Allocations,AllocatedBytes,SelfAllocations,SelfAllocatedBytes"
 #define FRAME_ANALYZE_NAME "Frame"
 
+#define OVERHEAD_CALIBRATION_BATCHES 8
+#define OVERHEAD_CALIBRATION_SCOPES 256
+
+#define TRACE_CPU_PID 1
+#define TRACE_GPU_PID 2
+
+//A hitch is attributed to a child scope only if the child accounts for at least this part of its parent's growth
+#define HITCH_SCOPE_GROWTH_SHARE 0.5
+
 class RenderingSystem;
 class Window;
 class ProfilingSession;
-class CPUProfilingSession;
-class GPUProfilingSession;
 
-struct ID3D11Query;
+class IGPUTimestampSource;
 
 class Profiler
 {
@@ -30,20 +43,27 @@ public:
 
     static void Draw();
 
-    static void StartCPUProfiling(const std::string& name);
-    static void EndCPUProfiling(const std::string& name);
+    static void StartCPUProfiling(const ProfilingScope& scope);
+    static void EndCPUProfiling(const ProfilingScope& scope);
 
-    static void StartGPUProfiling(const std::string& name);
-    static void EndGPUProfiling(const std::string& name);
+    static void StartGPUProfiling(const ProfilingScope& scope);
+    static void EndGPUProfiling(const ProfilingScope& scope);
 
-    static void StartProfiling(const std::string& name);
-    static void EndProfiling(const std::string& name);
+    static void StartProfiling(const ProfilingScope& scope);
+    static void EndProfiling(const ProfilingScope& scope);
 
     static void StartFrame();
     static void EndFrame();
-    
+
     static void RequestLogsToFile(std::string fileName) { s_instance->m_logsFileName = fileName; }
+    static void RequestTraceCapture(std::string fileName, const int& framesAmount);
+
+    static void RequestTimeSeriesRecording(std::string fileName);
+    static void StopTimeSeriesRecording();
+    static bool IsRecordingTimeSeries();
 
+    //Last value is shown on the screen and saved with logs, main thread only
+    static void SetCounter(const std::string& name, const double& value);
 
     static void Reset();
 
@@ -52,11 +72,16 @@ private:
 
     const Window* m_window;
 
-    void OnStartCPUProfiling(const std::string& name);
-    void OnEndCPUProfiling(const std::string& name);
+    static void BeginCPUScope(const ProfilingScope& scope, const bool& withGPU);
+    static void EndCPUScope(const ProfilingScope& scope, const bool& withGPU);
 
-    void OnStartGPUProfiling(const std::string& name);
-    void OnEndGPUProfiling(const std::string& name);
+    static ProfilingEventsRing* GetEventsRingForCurrentThread();
+    ProfilingEventsRing* RegisterEventsRing();
+
+    void CalibrateOverhead();
+
+    void OnStartGPUProfiling(const ProfilingScope& scope);
+    void OnEndGPUProfiling(const ProfilingScope& scope);
 
     void OnDraw();
     void OnStartFrame();
@@ -64,24 +89,46 @@ private:
 
     void OnReset();
 
-    void SaveLogsToFile(const std::string& fileName, const UINT64& gpuFreq);
-    void PrepareLogsToPrintOnScreen(const UINT64& gpuFreq);
-    std::string GetProfilersInHierarchy(std::unordered_map<std::string, ProfilingSession*>::iterator begin, std::unordered_map<std::string, ProfilingSession*>::iterator end, const int& length, const UINT64& freq);
-    std::string GetProfilersInCSVFormat(std::unordered_map<std::string, ProfilingSession*>::iterator begin, std::unordered_map<std::string, ProfilingSession*>::iterator end, const int& length, const UINT64& freq);
+    void DrainCPUEvents();
+    void HarvestGPUFrames();
+    void ResolveGPUFrame(GPUProfilingFrame& frame);
+    void ProcessEvent(const ProfilingEvent& event, std::vector<OpenProfilingScope>& openScopes, std::unordered_map<ProfilingPathID, ProfilingSession*>& sessions, std::vector<ProfilingSession*>& roots, const bool& subtractOverhead);
 
-    std::unordered_map<std::string, ProfilingSession*> m_cpuProfilers;
-    LARGE_INTEGER m_CPUfrequency;
+    void StartTraceCapture();
+    void UpdateTraceCapture();
+    bool IsTracingFrame(const int& frameIndex) const;
+    double GetTraceTime(const int64_t& cpuTicks) const;
 
-    std::unordered_map<std::string, ProfilingSession*> m_gpuProfilers[QUERY_LATENCY];
+    void StartTimeSeriesRecording();
+    void UpdateTimeSeriesRecording();
+    void RecordTimeSeriesFrame(const TimeSeriesTrack& track, const int& frameIndex, const std::unordered_map<ProfilingPathID, ProfilingSession*>& sessions, const UINT64& freq);
 
-    std::string m_cachedScreenLogs;
-    int m_cpuOrderCounter;
-    int m_gpuOrderCounter;
+    void UpdateFramePacing(const int64_t& timestamp);
+    const ProfilingSession* FindGrownScope() const;
 
-    const ProfilingSession* m_currentCPUSession;
-    const ProfilingSession* m_currentGPUSession;
+    void CreateDirectoriesForFile(const std::string& path);
+    void SaveLogsToFile(const std::string& fileName);
+    void PrepareLogsToPrintOnScreen();
+    static double TicksToMs(const double& ticks, const UINT64& freq);
+    std::string GetProfilersInHierarchy(const std::vector<ProfilingSession*>& roots, const UINT64& freq);
+    std::string GetProfilersInCSVFormat(const std::vector<ProfilingSession*>& roots, const UINT64& freq);
 
-    ID3D11Query* m_queryJoints[QUERY_LATENCY];
+    std::unordered_map<ProfilingPathID, ProfilingSession*> m_cpuProfilers;
+    std::vector<ProfilingSession*> m_cpuRootProfilers;
+    LARGE_INTEGER m_CPUfrequency;
+
+    std::unordered_map<ProfilingPathID, ProfilingSession*> m_gpuProfilers;
+    std::vector<ProfilingSession*> m_gpuRootProfilers;
+    std::vector<OpenProfilingScope> m_gpuOpenScopes;
+    IGPUTimestampSource* m_gpuTimestampSource;
+    GPUTimestampRing* m_gpuTimestampRing;
+    UINT64 m_gpuFrequency = 1000000000;
+
+    std::vector<ProfilingEventsRing*> m_eventsRings;
+    std::mutex m_eventsRingsMutex;
+    std::thread::id m_mainThreadID;
+
+    std::string m_cachedScreenLogs;
 
     int m_framesCounter = 0;
     float m_tmpTime = 0.0f;
@@ -89,10 +136,32 @@ private:
 
     double m_profilingTime = 0;
 
+    //In CPU ticks, measured once at startup
+    double m_scopeOverhead = 0.0;
+    double m_scopeSelfOverhead = 0.0;
+    double m_gpuQueryOverhead = 0.0;
+
     int m_currentFPS;
     float m_currentFrameDuration;
 
     std::string m_logsFileName = "";
+
+    ChromeTraceWriter m_traceWriter;
+    std::string m_traceFileName = "";
+    int m_traceFramesAmount = 0;
+    int m_traceFirstFrame = 0;
+    int64_t m_traceStartTicks = 0;
+    double m_traceGPUOffset = 0.0;
+    bool m_traceGPUAligned = false;
+    size_t m_tracedThreadsAmount = 0;
     bool m_resetRequested = false;
-};
 
+    TimeSeriesRecorder m_timeSeriesRecorder;
+    std::string m_timeSeriesFileName = "";
+    int m_timeSeriesFirstFrame = 0;
+    int m_timeSeriesLastFrame = -1;
+
+    FramePacing m_framePacing;
+
+    std::vector<std::pair<std::string, double>> m_counters;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "AllocationTracking.h"
+
+#define PROFILING_EVENTS_RING_SIZE 8192
+
+typedef uint32_t ProfilingScopeID;
+
+constexpr ProfilingScopeID HashProfilingScopeName(const char* name)
+{
+    ProfilingScopeID hash = 2166136261u;
+
+    while (*name)
+    {
+        hash ^= static_cast<unsigned char>(*name++);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+//Identifies a scope together with all of its parents
+typedef uint64_t ProfilingPathID;
+
+constexpr ProfilingPathID CombineProfilingPath(const ProfilingPathID& parent, const ProfilingScopeID& scope)
+{
+    return (parent ^ scope) * 1099511628211ull;
+}
+
+#define PROFILING_ROOT_PATH 14695981039346656037ull
+
+struct ProfilingScope
+{
+    ProfilingScopeID ID;
+    const char* Name;
+};
+
+//Name has to outlive the profiler (string literal), only the pointer is recorded
+#define PROFILING_SCOPE(name) ProfilingScope{ std::integral_constant<ProfilingScopeID, HashProfilingScopeName(name)>::value, name }
+
+enum class ProfilingEventType : uint32_t
+{
+    Begin,
+    End
+};
+
+struct ProfilingEvent
+{
+    ProfilingScopeID ID;
+    ProfilingEventType Type;
+    const char* Name;
+    int64_t Timestamp;
+    //CPU scope opened by StartProfiling, so the GPU query cost lands in the parent as well
+    bool WithGPU;
+    //Snapshot of the thread's counters, zero for GPU events
+    AllocationCounters Allocations;
+};
+
+class ProfilingSession;
+
+struct OpenProfilingScope
+{
+    ProfilingEvent Begin;
+    ProfilingSession* Session;
+    //Instrumentation cost of the nested scopes, in ticks
+    double NestedOverhead;
+    AllocationCounters NestedAllocations;
+};
+
+//Single producer (owning thread) / single consumer (Profiler::EndFrame) lock-free queue
+class ProfilingEventsRing
+{
+public:
+    ProfilingEventsRing(const uint32_t& threadIndex) : m_threadIndex(threadIndex) {}
+
+    inline bool Push(const ProfilingEvent& event)
+    {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_tail.load(std::memory_order_acquire) == PROFILING_EVENTS_RING_SIZE)
+        {
+            m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_events[head & (PROFILING_EVENTS_RING_SIZE - 1)] = event;
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    inline bool Pop(ProfilingEvent& event)
+    {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+
+        event = m_events[tail & (PROFILING_EVENTS_RING_SIZE - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    inline void AddProfilingTime(const int64_t& ticks) { m_profilingTime.fetch_add(ticks, std::memory_order_relaxed); }
+    inline int64_t ConsumeProfilingTime() { return m_profilingTime.exchange(0, std::memory_order_relaxed); }
+    inline uint32_t ConsumeDroppedEvents() { return m_droppedEvents.exchange(0, std::memory_order_relaxed); }
+
+    inline uint32_t GetThreadIndex() const { return m_threadIndex; }
+
+    //Consumer side only - scopes opened on this thread which weren't closed yet
+    std::vector<OpenProfilingScope> OpenScopes;
+
+private:
+    static_assert((PROFILING_EVENTS_RING_SIZE & (PROFILING_EVENTS_RING_SIZE - 1)) == 0, "Ring size has to be a power of two!");
+
+    ProfilingEvent m_events[PROFILING_EVENTS_RING_SIZE];
+    std::atomic<uint32_t> m_head{ 0 };
+    std::atomic<uint32_t> m_tail{ 0 };
+    std::atomic<uint32_t> m_droppedEvents{ 0 };
+    std::atomic<int64_t> m_profilingTime{ 0 };
+    const uint32_t m_threadIndex;
+};
@@ -1,98 +1,120 @@
 #include "ProfilingSession.h"
-#include <d3d11.h>
-#include <cassert>
-#include "Core.h"
 
-ProfilingSession::ProfilingSession(const int& maxSamples)
+ProfilingSession::ProfilingSession(const std::string& name, ProfilingSession* const& parent, const ProfilingPathID& pathID, const int& windowSamples)
 {
-    m_maxSamplesAmount = maxSamples;
-    m_currentResult = 0;
-    m_results.reserve(maxSamples);
+    m_name = name;
+    m_parent = parent;
+    m_pathID = pathID;
+    m_windowSamplesAmount = windowSamples;
+
+    if (parent)
+    {
+        m_path = parent->m_path + "/" + name;
+        m_depth = parent->m_depth + 1;
+        parent->m_children.push_back(this);
+    }
+    else
+        m_path = name;
 }
 
 ProfilingSession::~ProfilingSession() {}
 
-double ProfilingSession::GetAverageResult()
+const StreamingStatistics& ProfilingSession::GetRecentStatistics() const
 {
-    double sum = 0.0f;
-    for (const double& result : m_results)
-    {
-        sum += result;
-    }
-
-    return sum / m_results.size();
+    const StreamingStatistics& previous = m_windows[1 - m_currentWindow];
+    return previous.GetCount() > 0 ? previous : m_windows[m_currentWindow];
 }
 
-void ProfilingSession::SaveResult(const double& result)
+void ProfilingSession::OnEndProfiling(const double& result, const double& correctedResult, const AllocationCounters& allocations, const AllocationCounters& selfAllocations)
 {
-    if (m_results.size() < m_maxSamplesAmount)
-    {
-        m_results.push_back(result);
-        return;
-    }
+    ++m_frameInvocations;
+    m_frameResult += result;
+    m_frameCorrectedResult += correctedResult;
 
-    m_results[m_currentResult] = result;
-    m_currentResult = (m_currentResult + 1) % m_maxSamplesAmount;
-}
+    m_frameAllocations.Allocations += allocations.Allocations;
+    m_frameAllocations.Bytes += allocations.Bytes;
+    m_frameSelfAllocations.Allocations += selfAllocations.Allocations;
+    m_frameSelfAllocations.Bytes += selfAllocations.Bytes;
 
-void ProfilingSession::OnStartProfiling(const ProfilingSession* const& parent, const int& order)
-{
-    assert(!m_active);
-    m_active = true;
-    m_parent = parent;
-    m_order = order;
+    m_invocationStatistics.Add(correctedResult);
 }
 
-void ProfilingSession::Reset()
+void ProfilingSession::OnEndFrame()
 {
-    m_results.clear();
+    m_lastFrameInvocations = m_frameInvocations;
+    m_lastFrameResult = m_frameCorrectedResult;
+    m_lastFrameAllocations = m_frameAllocations;
+    m_lastFrameSelfAllocations = m_frameSelfAllocations;
+
+    m_lastFrameGrowth = m_lastFrameResult - m_frameAverage;
+    m_frameAverage += SESSION_FRAME_AVERAGE_WEIGHT * m_lastFrameGrowth;
+
+    //Scopes which didn't run this frame don't contribute zeros to the statistics
+    if (m_frameInvocations == 0)
+        return;
+
+    m_rawStatistics.Add(m_frameResult);
+    m_statistics.Add(m_frameCorrectedResult);
+    m_windows[m_currentWindow].Add(m_frameCorrectedResult);
+
+    if (m_windows[m_currentWindow].GetCount() >= (uint64_t)m_windowSamplesAmount)
+    {
+        m_currentWindow = 1 - m_currentWindow;
+        m_windows[m_currentWindow].Reset();
+    }
+
+    m_totalInvocations += m_frameInvocations;
+    m_totalAllocations += m_frameAllocations.Allocations;
+    m_totalAllocatedBytes += m_frameAllocations.Bytes;
+    m_totalSelfAllocations += m_frameSelfAllocations.Allocations;
+    m_totalSelfAllocatedBytes += m_frameSelfAllocations.Bytes;
+    ++m_framesAmount;
+
+    m_frameInvocations = 0;
+    m_frameResult = 0.0;
+    m_frameCorrectedResult = 0.0;
+    m_frameAllocations = { 0, 0 };
+    m_frameSelfAllocations = { 0, 0 };
 }
 
-void CPUProfilingSession::OnStartProfiling(const ProfilingSession* const& parent, const int& order)
+double ProfilingSession::GetAverageInvocations() const
 {
-    ProfilingSession::OnStartProfiling(parent, order);
-    QueryPerformanceCounter(&StartTick);
+    return m_framesAmount > 0 ? (double)m_totalInvocations / m_framesAmount : 0.0;
 }
 
-void CPUProfilingSession::OnEndProfiling()
+double ProfilingSession::GetAverageAllocations() const
 {
-    ProfilingSession::OnEndProfiling();
-
-    static LARGE_INTEGER now;
-    QueryPerformanceCounter(&now);
-    SaveResult((double)(now.QuadPart - StartTick.QuadPart));
+    return m_framesAmount > 0 ? (double)m_totalAllocations / m_framesAmount : 0.0;
 }
 
-GPUProfilingSession::GPUProfilingSession(const int& maxSamples) : ProfilingSession(maxSamples)
+double ProfilingSession::GetAverageAllocatedBytes() const
 {
-    D3D11_QUERY_DESC desc;
-    desc.MiscFlags = 0;
-    desc.Query = D3D11_QUERY_TIMESTAMP;
-
-    Core::GetD3Device()->CreateQuery(&desc, &m_start);
-    Core::GetD3Device()->CreateQuery(&desc, &m_end);
+    return m_framesAmount > 0 ? (double)m_totalAllocatedBytes / m_framesAmount : 0.0;
 }
 
-void GPUProfilingSession::OnStartProfiling(const ProfilingSession* const& parent, const int& order)
+double ProfilingSession::GetAverageSelfAllocations() const
 {
-    ProfilingSession::OnStartProfiling(parent, order);
-
-    Core::GetD3DeviceContext()->End(m_start);
+    return m_framesAmount > 0 ? (double)m_totalSelfAllocations / m_framesAmount : 0.0;
 }
 
-void GPUProfilingSession::OnEndProfiling()
+double ProfilingSession::GetAverageSelfAllocatedBytes() const
 {
-    ProfilingSession::OnEndProfiling();
-
-    Core::GetD3DeviceContext()->End(m_end);
+    return m_framesAmount > 0 ? (double)m_totalSelfAllocatedBytes / m_framesAmount : 0.0;
 }
 
-void GPUProfilingSession::OnEndFrame()
+void ProfilingSession::Reset()
 {
-    static UINT64 start, end;
-
-    Core::GetD3DeviceContext()->GetData(m_start, &start, sizeof(UINT64), 0);
-    Core::GetD3DeviceContext()->GetData(m_end, &end, sizeof(UINT64), 0);
-
-    SaveResult((double)(end - start));
+    m_statistics.Reset();
+    m_rawStatistics.Reset();
+    m_invocationStatistics.Reset();
+    m_windows[0].Reset();
+    m_windows[1].Reset();
+    m_currentWindow = 0;
+
+    m_totalInvocations = 0;
+    m_framesAmount = 0;
+    m_totalAllocations = 0;
+    m_totalAllocatedBytes = 0;
+    m_totalSelfAllocations = 0;
+    m_totalSelfAllocatedBytes = 0;
 }
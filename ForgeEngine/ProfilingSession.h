@@ -2,67 +2,84 @@
 
 #include <string>
 #include <vector>
-#include <Windows.h>
+#include "StreamingStatistics.h"
+#include "ProfilingEvents.h"
 
-struct ID3D11Query;
+//Weight of the last frame in the moving average used as a baseline for GetLastFrameGrowth
+#define SESSION_FRAME_AVERAGE_WEIGHT 0.05
 
+//Single node of the call tree - the same scope reached through a different path gets its own session
 class ProfilingSession
 {
 public:
-    ProfilingSession(const int& maxSamples);
-    virtual ~ProfilingSession() = 0;
-
-    double GetAverageResult();
-    virtual void OnStartProfiling(const ProfilingSession* const& parent, const int& order);
-    virtual void OnEndProfiling() { m_active = false; }
-
-    inline bool IsActive() { return m_active; }
+    ProfilingSession(const std::string& name, ProfilingSession* const& parent, const ProfilingPathID& pathID, const int& windowSamples);
+    ~ProfilingSession();
+
+    //Per frame sums since the last reset, with instrumentation overhead subtracted
+    inline const StreamingStatistics& GetStatistics() const { return m_statistics; }
+    inline const StreamingStatistics& GetRawStatistics() const { return m_rawStatistics; }
+    //Single invocations since the last reset
+    inline const StreamingStatistics& GetInvocationStatistics() const { return m_invocationStatistics; }
+    //Last complete window of per frame sums
+    const StreamingStatistics& GetRecentStatistics() const;
+
+    void OnEndProfiling(const double& result, const double& correctedResult, const AllocationCounters& allocations, const AllocationCounters& selfAllocations);
+    void OnEndFrame();
+
+    inline const std::string& GetName() const { return m_name; }
+    inline const std::string& GetPath() const { return m_path; }
+    inline ProfilingPathID GetPathID() const { return m_pathID; }
     inline const ProfilingSession* GetParent() const { return m_parent; }
-    inline void SetParent(const ProfilingSession* const& session) { m_parent = session; }
-    inline int GetOrder() { return m_order; }
+    inline const std::vector<ProfilingSession*>& GetChildren() const { return m_children; }
+    inline int GetDepth() const { return m_depth; }
+
+    inline int GetLastFrameInvocations() const { return m_lastFrameInvocations; }
+    inline double GetLastFrameResult() const { return m_lastFrameResult; }
+    //Last frame result above the moving average of previous frames, including frames where the scope didn't run
+    inline double GetLastFrameGrowth() const { return m_lastFrameGrowth; }
+    double GetAverageInvocations() const;
+
+    inline const AllocationCounters& GetLastFrameAllocations() const { return m_lastFrameAllocations; }
+    inline const AllocationCounters& GetLastFrameSelfAllocations() const { return m_lastFrameSelfAllocations; }
+    //Per frame, since the last reset
+    double GetAverageAllocations() const;
+    double GetAverageAllocatedBytes() const;
+    double GetAverageSelfAllocations() const;
+    double GetAverageSelfAllocatedBytes() const;
 
     void Reset();
 
-    virtual void OnStartFrame() {}
-    virtual void OnEndFrame() {}
-
-protected:
-    void SaveResult(const double& result);
-
-private:
-    int m_currentResult = 0;
-    std::vector<double> m_results;
-    bool m_active = false;
-    int m_maxSamplesAmount;
-    const ProfilingSession* m_parent;
-    int m_order;
-};
-
-class CPUProfilingSession : public ProfilingSession
-{
-public:
-    CPUProfilingSession(const int& maxSamples) : ProfilingSession(maxSamples) {}
-    virtual ~CPUProfilingSession() override {}
-
-    virtual void OnStartProfiling(const ProfilingSession* const& parent, const int& order) override;
-    virtual void OnEndProfiling() override;
-
 private:
-    LARGE_INTEGER StartTick;
+    std::string m_name;
+    std::string m_path;
+    ProfilingPathID m_pathID;
+    ProfilingSession* m_parent;
+    std::vector<ProfilingSession*> m_children;
+    int m_depth = 0;
+
+    StreamingStatistics m_statistics;
+    StreamingStatistics m_rawStatistics;
+    StreamingStatistics m_invocationStatistics;
+    StreamingStatistics m_windows[2];
+    int m_currentWindow = 0;
+    int m_windowSamplesAmount;
+
+    int m_frameInvocations = 0;
+    double m_frameResult = 0.0;
+    double m_frameCorrectedResult = 0.0;
+    AllocationCounters m_frameAllocations = { 0, 0 };
+    AllocationCounters m_frameSelfAllocations = { 0, 0 };
+
+    int m_lastFrameInvocations = 0;
+    double m_lastFrameResult = 0.0;
+    double m_lastFrameGrowth = 0.0;
+    double m_frameAverage = 0.0;
+    AllocationCounters m_lastFrameAllocations = { 0, 0 };
+    AllocationCounters m_lastFrameSelfAllocations = { 0, 0 };
+    uint64_t m_totalInvocations = 0;
+    uint64_t m_framesAmount = 0;
+    uint64_t m_totalAllocations = 0;
+    uint64_t m_totalAllocatedBytes = 0;
+    uint64_t m_totalSelfAllocations = 0;
+    uint64_t m_totalSelfAllocatedBytes = 0;
 };
-
-class GPUProfilingSession : public ProfilingSession
-{
-
-public:
-    GPUProfilingSession(const int& maxSamples);
-    virtual ~GPUProfilingSession() override {}
-
-    virtual void OnStartProfiling(const ProfilingSession* const& parent, const int& order) override;
-    virtual void OnEndProfiling() override;
-    virtual void OnEndFrame() override;
-
-private:
-    ID3D11Query* m_start;
-    ID3D11Query* m_end;
-};
\ No newline at end of file
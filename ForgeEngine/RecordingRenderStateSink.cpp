@@ -0,0 +1,75 @@
+#include "RecordingRenderStateSink.h"
+
+void RecordingRenderStateSink::SetVertexShader(const RenderResourceHandle& shader)
+{
+    Record(RenderCommandType::VertexShader, shader, 0);
+}
+
+void RecordingRenderStateSink::SetPixelShader(const RenderResourceHandle& shader)
+{
+    Record(RenderCommandType::PixelShader, shader, 0);
+}
+
+void RecordingRenderStateSink::SetInputLayout(const RenderResourceHandle& layout)
+{
+    Record(RenderCommandType::InputLayout, layout, 0);
+}
+
+void RecordingRenderStateSink::SetTexture(const RenderResourceHandle& texture)
+{
+    Record(RenderCommandType::Texture, texture, 0);
+}
+
+void RecordingRenderStateSink::SetMaterialBuffer(const RenderResourceHandle& buffer)
+{
+    Record(RenderCommandType::MaterialBuffer, buffer, 0);
+}
+
+void RecordingRenderStateSink::SetVertexBuffer(const RenderResourceHandle& buffer, const uint32_t& stride)
+{
+    Record(RenderCommandType::VertexBuffer, buffer, stride);
+}
+
+void RecordingRenderStateSink::SetIndexBuffer(const RenderResourceHandle& buffer, const uint32_t& indexSize)
+{
+    Record(RenderCommandType::IndexBuffer, buffer, indexSize);
+}
+
+void RecordingRenderStateSink::SetInstances(const uint32_t& firstInstance, const uint32_t& instancesAmount)
+{
+    Record(RenderCommandType::Instances, nullptr, firstInstance, instancesAmount);
+}
+
+void RecordingRenderStateSink::DrawIndexed(const uint32_t& indicesAmount)
+{
+    Record(RenderCommandType::DrawIndexed, nullptr, indicesAmount, 1);
+}
+
+void RecordingRenderStateSink::DrawIndexedInstanced(const uint32_t& indicesAmount, const uint32_t& instancesAmount)
+{
+    Record(RenderCommandType::DrawIndexedInstanced, nullptr, indicesAmount, instancesAmount);
+}
+
+size_t RecordingRenderStateSink::GetCommandsAmount(const RenderCommandType& type) const
+{
+    size_t result = 0;
+
+    for (const RecordedRenderCommand& command : m_commands)
+    {
+        if (command.Type == type)
+            ++result;
+    }
+
+    return result;
+}
+
+void RecordingRenderStateSink::Record(const RenderCommandType& type, const RenderResourceHandle& handle, const uint32_t& value, const uint32_t& instancesAmount)
+{
+    RecordedRenderCommand command;
+    command.Type = type;
+    command.Handle = handle;
+    command.Value = value;
+    command.InstancesAmount = instancesAmount;
+
+    m_commands.push_back(command);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include "IRenderStateSink.h"
+
+enum class RenderCommandType
+{
+    VertexShader,
+    PixelShader,
+    InputLayout,
+    Texture,
+    MaterialBuffer,
+    VertexBuffer,
+    IndexBuffer,
+    Instances,
+    DrawIndexed,
+    DrawIndexedInstanced
+};
+
+struct RecordedRenderCommand
+{
+    RenderCommandType Type;
+    RenderResourceHandle Handle;
+    uint32_t Value; //Stride, index size, first instance or indices amount
+    uint32_t InstancesAmount;
+};
+
+//Doesn't touch any device, only records what would be submitted
+class RecordingRenderStateSink : public IRenderStateSink
+{
+public:
+    virtual void SetVertexShader(const RenderResourceHandle& shader) override;
+    virtual void SetPixelShader(const RenderResourceHandle& shader) override;
+    virtual void SetInputLayout(const RenderResourceHandle& layout) override;
+    virtual void SetTexture(const RenderResourceHandle& texture) override;
+    virtual void SetMaterialBuffer(const RenderResourceHandle& buffer) override;
+    virtual void SetVertexBuffer(const RenderResourceHandle& buffer, const uint32_t& stride) override;
+    virtual void SetIndexBuffer(const RenderResourceHandle& buffer, const uint32_t& indexSize) override;
+    virtual void SetInstances(const uint32_t& firstInstance, const uint32_t& instancesAmount) override;
+
+    virtual void DrawIndexed(const uint32_t& indicesAmount) override;
+    virtual void DrawIndexedInstanced(const uint32_t& indicesAmount, const uint32_t& instancesAmount) override;
+
+    size_t GetCommandsAmount(const RenderCommandType& type) const;
+    inline const std::vector<RecordedRenderCommand>& GetCommands() const { return m_commands; }
+    inline void Clear() { m_commands.clear(); }
+
+private:
+    void Record(const RenderCommandType& type, const RenderResourceHandle& handle, const uint32_t& value, const uint32_t& instancesAmount = 0);
+
+    std::vector<RecordedRenderCommand> m_commands;
+};
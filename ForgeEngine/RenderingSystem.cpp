@@ -1,7 +1,3 @@
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-
 #include "RenderingSystem.h"
 #include "Model.h"
 #include "MeshRenderer.h"
@@ -9,98 +5,388 @@
 #include "Transform.h"
 #include "Core.h"
 #include "Material.h"
-#include <DirectXTex/DirectXTex.h>
 #include "ShadersManager.h"
 #include <d3d9types.h>
 #include "Profiler.h"
 #include "Core.h"
+#include "D3D11RenderStateSink.h"
+#include "D3D11TextureBackend.h"
+#include "JobSystem.h"
+#include "ModelImporter.h"
+#include "Window.h"
 
 #include <sstream>
+#include <cstring>
+#include <algorithm>
 
 using namespace DirectX;
 using namespace std;
 
-RenderingSystem::RenderingSystem()
+static_assert(sizeof(XMMATRIX) == sizeof(ObjectMatrix), "Matrices are copied between both layouts");
+
+namespace
+{
+    DXGI_FORMAT GetVertexFormat(const VertexFormat& format)
+    {
+        switch (format)
+        {
+        case VertexFormat::Float2: return DXGI_FORMAT_R32G32_FLOAT;
+        case VertexFormat::Float3: return DXGI_FORMAT_R32G32B32_FLOAT;
+        case VertexFormat::Float4: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case VertexFormat::Half2: return DXGI_FORMAT_R16G16_FLOAT;
+        case VertexFormat::Snorm16x2: return DXGI_FORMAT_R16G16_SNORM;
+        case VertexFormat::Unorm16x4: return DXGI_FORMAT_R16G16B16A16_UNORM;
+        case VertexFormat::Unorm8x4: return DXGI_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+//CPU side of meshes and textures are prepared on the loading thread too, only D3D objects are created on the main thread
+class RenderingSystem::LoadingModel : public ModelLoad
 {
-    D3D11_BUFFER_DESC cbbd;
-    ZeroMemory(&cbbd, sizeof(D3D11_BUFFER_DESC));
+public:
+    LoadingModel(const std::string& path, TextureCache* const& textureCache) : ModelLoad(path), m_textureCache(textureCache) {}
+
+    //Meshes are left here only when the model was never uploaded, materials take references of their own
+    virtual ~LoadingModel() override
+    {
+        for (Mesh* const& mesh : Meshes)
+            delete mesh;
+
+        for (auto const& texture : Textures)
+            m_textureCache->Release(texture.second);
+    }
+
+    std::vector<Mesh*> Meshes;
+    //Acquired once per path, null when the texture can't be loaded
+    std::unordered_map<std::string, TextureHandle> Textures;
+
+protected:
+    virtual void Process(JobSystem* const& jobSystem) override
+    {
+        const ModelCache& cache = GetCache();
 
-    cbbd.Usage = D3D11_USAGE_DEFAULT;
-    cbbd.ByteWidth = sizeof(cbPerObject);
-    cbbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        Meshes.resize(cache.GetMeshesAmount());
+        jobSystem->Run((int)Meshes.size(), [this, &cache](const int& meshIndex)
+        {
+            Meshes[meshIndex] = LoadMeshData(cache, cache.GetMesh(meshIndex));
+        });
+
+        //Textures are created on this thread too, the device is free threaded
+        for (uint32_t i = 0; i < cache.GetMeshesAmount(); ++i)
+        {
+            const ModelCacheMesh& meshData = cache.GetMesh(i);
+            const ModelCacheRange* textures = cache.Get<ModelCacheRange>(meshData.Textures);
 
-    Core::GetD3Device()->CreateBuffer(&cbbd, nullptr, &m_cbPerObjectBuff);
+            for (uint64_t t = 0; t < meshData.Textures.Amount; ++t)
+            {
+                const std::string path = cache.GetString(textures[t]);
+
+                if (Textures.count(path) == 0)
+                    Textures[path] = m_textureCache->Acquire(path);
+            }
+        }
+    }
+
+private:
+    TextureCache* m_textureCache;
+};
+
+RenderingSystem::RenderingSystem()
+{
+    m_renderStateSink = new D3D11RenderStateSink(Core::GetD3Device(), Core::GetD3DeviceContext());
+    m_jobSystem = new JobSystem();
+    m_occlusionCuller = new OcclusionCuller(m_jobSystem);
+    m_textureDecoder = new WICTextureDecoder();
+    m_textureDevice = new D3D11TextureDevice(Core::GetD3Device());
+    m_textureCache = new TextureCache(m_textureDecoder, m_textureDevice);
+
+    DecodedTexture white;
+    white.Width = 1;
+    white.Height = 1;
+    white.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    white.RowPitch = 4;
+    white.Pixels.assign(4, 255);
+    m_fallbackTexture = m_textureDevice->CreateTexture(white);
+
+    m_modelLoader = new ModelLoader(m_vertexPacking);
 }
 
 RenderingSystem::~RenderingSystem()
 {
+    //Loads still in flight are dropped with their meshes and textures
+    delete m_modelLoader;
+    m_waitingModels.clear();
+    m_loadedModels.clear();
+
     for (auto const& entry : m_models)
     {
-        ReleaseModel(entry.second);
+        unordered_set<const Mesh*> releasedMeshes;
+        ReleaseModel(entry.second, releasedMeshes);
     }
 
-    m_cbPerObjectBuff->Release();
+    delete m_textureCache;
+
+    if (m_fallbackTexture != nullptr)
+        m_textureDevice->ReleaseTexture(m_fallbackTexture);
+
+    delete m_textureDevice;
+    delete m_textureDecoder;
+    delete m_occlusionCuller;
+    delete m_jobSystem;
+    delete m_renderStateSink;
+}
+
+void RenderingSystem::PrepareFrame(Camera* const& camera)
+{
+    m_frustumCuller.Clear();
+    m_objectsWorlds.clear();
+
+    //Jitter is below a pixel, so every pass of the frame would get the same results
+    ObjectMatrix viewProjection;
+    XMMATRIX viewProjectionMatrix = camera->GetViewMatrix() * camera->GetProjectionMatrixWithoutOffset();
+    memcpy(&viewProjection, &viewProjectionMatrix, sizeof(ObjectMatrix));
+
+    m_frustumCuller.SetFrustum(viewProjection);
+
+    for (MeshRenderer* const& renderer : m_meshRenderers)
+    {
+        m_objectsWorlds.emplace_back();
+        XMMATRIX world = renderer->GetOwner()->GetTransform()->GetWorldMatrix();
+        memcpy(&m_objectsWorlds.back(), &world, sizeof(ObjectMatrix));
+
+        m_frustumCuller.Add(*renderer->m_bounds, m_objectsWorlds.back());
+    }
+
+    m_frustumCuller.Cull();
+
+    Profiler::StartCPUProfiling(PROFILING_SCOPE("Occlusion culling"));
+    CullOccludedObjects(viewProjection);
+    Profiler::EndCPUProfiling(PROFILING_SCOPE("Occlusion culling"));
+
+    //All passes of the frame draw the same LODs
+    uint32_t objectIndex = 0;
+    for (MeshRenderer* const& renderer : m_meshRenderers)
+    {
+        if (IsDrawn(objectIndex))
+            renderer->LOD = SelectLOD(m_objectsScreenSizes[objectIndex], renderer->LOD, MESH_LODS_AMOUNT);
+
+        ++objectIndex;
+    }
 }
 
 void RenderingSystem::RenderRegisteredMeshRenderers(Camera* const& camera)
 {
+    //Renderers are iterated in the same order as in PrepareFrame, it has to be called again when they change
+    if (m_objectsWorlds.size() != m_meshRenderers.size())
+        PrepareFrame(camera);
+
+    m_drawList.Clear();
+    m_objectsPrevWVPs.clear();
+
+    ObjectMatrix viewProjection;
+    XMMATRIX viewProjectionMatrix = camera->GetViewMatrix() * camera->GetProjectionMatrix();
+    memcpy(&viewProjection, &viewProjectionMatrix, sizeof(ObjectMatrix));
+
     for (MeshRenderer* const& renderer : m_meshRenderers)
     {
-        m_cbPerObj.WVP = XMMatrixTranspose(renderer->GetOwner()->GetTransform()->GetWorldMatrix() * camera->GetViewMatrix() * camera->GetProjectionMatrix());
-        m_cbPerObj.W = XMMatrixTranspose(renderer->GetOwner()->GetTransform()->GetWorldMatrix());
-        m_cbPerObj.PrevWVP = renderer->PrevWVP;
-        renderer->PrevWVP = m_cbPerObj.WVP;
+        m_objectsPrevWVPs.emplace_back();
+        memcpy(&m_objectsPrevWVPs.back(), &renderer->PrevWVP, sizeof(ObjectMatrix));
+    }
+
+    //Culled objects still get their constants calculated, to keep PrevWVP up to date
+    m_objectsConstants.resize(m_objectsWorlds.size());
+    CalculateObjectConstants(m_objectsWorlds.data(), m_objectsPrevWVPs.data(), m_objectsWorlds.size(), viewProjection, m_objectsConstants.data());
+
+    //Renderers are iterated in the same order as when gathering
+    uint32_t objectIndex = 0;
+    uint32_t culledAmount = 0;
+    size_t trianglesAmount = 0;
+    size_t savedTrianglesAmount = 0;
+    for (MeshRenderer* const& renderer : m_meshRenderers)
+    {
+        memcpy(&renderer->PrevWVP, &m_objectsPrevWVPs[objectIndex], sizeof(ObjectMatrix));
 
-        Core::GetD3DeviceContext()->UpdateSubresource(m_cbPerObjectBuff, 0, nullptr, &m_cbPerObj, 0, 0);
-        Core::GetD3DeviceContext()->VSSetConstantBuffers(static_cast<UINT>(VertexCBIndex::PerObject), 1, &m_cbPerObjectBuff);
+        //Nodes without meshes have empty bounds, they aren't counted as culled
+        if (!m_frustumCuller.IsVisible(objectIndex))
+        {
+            if (!renderer->m_meshes->empty())
+                ++culledAmount;
+
+            ++objectIndex;
+            continue;
+        }
+
+        if (!IsDrawn(objectIndex))
+        {
+            ++objectIndex;
+            continue;
+        }
 
         for (const Mesh* const& mesh : *renderer->m_meshes)
         {
-            Core::GetD3DeviceContext()->IASetIndexBuffer(mesh->IndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+            const CachedShaders* cachedShaders = mesh->Material->GetShaders();
+            //Meshes with shorter chains stay at their last LOD
+            const int lod = std::min(renderer->LOD, (int)mesh->LODs.size());
+
+            DrawCommand command;
+            command.VertexShader = cachedShaders->GetVS().Shader;
+            command.PixelShader = cachedShaders->GetPS().Shader;
+            command.InputLayout = mesh->Material->GetInputLayout();
+            command.Texture = mesh->Material->Textures.size() > 0 ? mesh->Material->Textures[0] : nullptr;
+            command.MaterialBuffer = mesh->Material->GetConstantBufferMaterialBuffer();
+            command.VertexBuffer = mesh->VertexBuffer;
+            command.Stride = mesh->Stride;
+            command.IndexBuffer = lod > 0 ? mesh->LODs[lod - 1].IndexBuffer : mesh->IndexBuffer;
+            command.IndexSize = mesh->IndexSize;
+            command.IndicesAmount = lod > 0 ? mesh->LODs[lod - 1].IndicesAmount : mesh->IndicesAmount;
+            command.ObjectIndex = objectIndex;
+
+            m_drawList.Add(command);
+
+            trianglesAmount += command.IndicesAmount / 3;
+            savedTrianglesAmount += (mesh->IndicesAmount - command.IndicesAmount) / 3;
+        }
+
+        ++objectIndex;
+    }
+
+    m_drawList.Sort();
+    m_drawList.BuildBatches(m_renderStateSink->GetMaxInstancesPerDraw());
+
+    //Instances of a batch read consecutive slots, so objects with several meshes are copied for each of them
+    const std::vector<uint32_t>& instancesObjects = m_drawList.GetInstancesObjects();
+    m_instancesConstants.resize(instancesObjects.size());
+
+    for (size_t i = 0; i < instancesObjects.size(); ++i)
+        m_instancesConstants[i] = m_objectsConstants[instancesObjects[i]];
+
+    m_renderStateSink->UploadInstancesConstants(m_instancesConstants.data(), (uint32_t)m_instancesConstants.size());
+    m_drawList.Submit(m_renderStateSink);
+
+    const DrawListCounters& counters = m_drawList.GetCounters();
+
+    //Of the least loaded model
+    float loadingProgress = 1.0f;
+    for (auto const& waiting : m_waitingModels)
+        loadingProgress = std::min(loadingProgress, waiting.second.Load->GetProgress());
+
+    const TextureCacheStatistics textureStatistics = m_textureCache->GetStatistics();
+
+    Profiler::SetCounter("Visible objects", m_frustumCuller.GetVisibleAmount());
+    Profiler::SetCounter("Culled objects", culledAmount);
+    Profiler::SetCounter("Occluders", m_occlusionCuller->GetOccludersAmount());
+    Profiler::SetCounter("Occluder triangles", (double)m_occlusionCuller->GetOccluderTrianglesAmount());
+    Profiler::SetCounter("Occluded objects", m_occlusionCuller->GetOccludedAmount());
+    Profiler::SetCounter("Triangles", (double)trianglesAmount);
+    Profiler::SetCounter("LOD triangles saved", (double)savedTrianglesAmount);
+    Profiler::SetCounter("Geometry KB", m_geometryBytes / 1024.0);
+    Profiler::SetCounter("Loading models", (double)m_waitingModels.size());
+    Profiler::SetCounter("Loading progress %", 100.0 * loadingProgress);
+    Profiler::SetCounter("Textures", (double)textureStatistics.TexturesAmount);
+    Profiler::SetCounter("Texture KB", textureStatistics.ResidentBytes / 1024.0);
+    Profiler::SetCounter("Draws", counters.Draws);
+    Profiler::SetCounter("Instanced draws", counters.InstancedDraws);
+    Profiler::SetCounter("Instances", counters.Instances);
+    Profiler::SetCounter("State changes", counters.StateChanges);
+    Profiler::SetCounter("State changes skipped", counters.SkippedStateChanges);
+    Profiler::SetCounter("Instance bindings", counters.InstanceBindings);
+}
+
+bool RenderingSystem::IsDrawn(const uint32_t& objectIndex) const
+{
+    if (!m_frustumCuller.IsVisible(objectIndex))
+        return false;
 
-            UINT offset = 0;
-            Core::GetD3DeviceContext()->IASetVertexBuffers(0, 1, &mesh->VertexBuffer, &mesh->Stride, &offset);
-            
-            static ID3D11Buffer* materialBuff;
-            materialBuff = mesh->Material->GetConstantBufferMaterialBuffer();
-            Core::GetD3DeviceContext()->VSSetConstantBuffers(static_cast<UINT>(VertexCBIndex::Material), 1, &materialBuff);
+    return m_occlusionIndices[objectIndex] == UINT32_MAX || !m_occlusionCuller->IsOccluded(m_occlusionIndices[objectIndex]);
+}
+
+void RenderingSystem::CullOccludedObjects(const ObjectMatrix& viewProjection)
+{
+    Window* window = Core::GetWindow();
+    m_occlusionCuller->SetResolution(window->GetResolutionWidth() / OCCLUSION_DOWNSCALE, window->GetResolutionHeight() / OCCLUSION_DOWNSCALE);
+    m_occlusionCuller->Begin(viewProjection);
 
-            if (mesh->Material->Textures.size() > 0)
-                Core::GetD3DeviceContext()->PSSetShaderResources(0, 1, &mesh->Material->Textures[0]);
+    m_occluderCandidates.clear();
+    m_objectsScreenSizes.assign(m_objectsWorlds.size(), 0.0f);
+    uint32_t objectIndex = 0;
+    for (MeshRenderer* const& renderer : m_meshRenderers)
+    {
+        if (m_frustumCuller.IsVisible(objectIndex))
+        {
+            //Used for selecting LODs as well
+            const float screenSize = m_occlusionCuller->GetScreenSize(*renderer->m_bounds, m_objectsWorlds[objectIndex]);
+            m_objectsScreenSizes[objectIndex] = screenSize;
 
-            static const CachedShaders* cachedShaders;
-            cachedShaders = mesh->Material->GetShaders();
+            if (screenSize >= OCCLUSION_MIN_OCCLUDER_SIZE)
+                m_occluderCandidates.push_back({ screenSize, objectIndex, renderer->m_meshes });
+        }
 
-            Core::GetD3DeviceContext()->VSSetShader(cachedShaders->GetVS().Shader, 0, 0);
-            Core::GetD3DeviceContext()->PSSetShader(cachedShaders->GetPS().Shader, 0, 0);
+        ++objectIndex;
+    }
 
-            Core::GetD3DeviceContext()->IASetInputLayout(mesh->Material->GetInputLayout());
+    //The largest renderers on the screen are rasterized until the budget runs out
+    std::sort(m_occluderCandidates.begin(), m_occluderCandidates.end(),
+        [](const OccluderCandidate& a, const OccluderCandidate& b) { return a.ScreenSize > b.ScreenSize; });
 
-            Core::GetD3DeviceContext()->DrawIndexed(mesh->IndicesAmount, 0, 0);
+    size_t trianglesAmount = 0;
+    for (const OccluderCandidate& candidate : m_occluderCandidates)
+    {
+        for (const Mesh* const& mesh : *candidate.Meshes)
+        {
+            if (mesh->Indices.empty() || trianglesAmount + mesh->Indices.size() / 3 > OCCLUSION_TRIANGLES_BUDGET)
+                continue;
+
+            m_occlusionCuller->AddOccluder(mesh->Positions.data(), mesh->Positions.size() / 3, 3, mesh->Indices.data(), mesh->Indices.size(), m_objectsWorlds[candidate.ObjectIndex]);
+            trianglesAmount += mesh->Indices.size() / 3;
         }
     }
+
+    m_occlusionCuller->Rasterize();
+
+    m_occlusionIndices.assign(m_objectsWorlds.size(), UINT32_MAX);
+    objectIndex = 0;
+    for (MeshRenderer* const& renderer : m_meshRenderers)
+    {
+        if (m_frustumCuller.IsVisible(objectIndex) && !renderer->m_meshes->empty())
+            m_occlusionIndices[objectIndex] = m_occlusionCuller->Add(*renderer->m_bounds, m_objectsWorlds[objectIndex]);
+
+        ++objectIndex;
+    }
+
+    m_occlusionCuller->Test();
 }
 
 void RenderingSystem::InitializeMeshRendererWithModelPath(MeshRenderer* const& meshRenderer, const std::string& modelPath, const std::string& shaderPath)
 {
     auto alreadyCreated = m_models.find(modelPath);
-    const Model* model = nullptr;
-
 
     if (alreadyCreated != m_models.end())
-        model = alreadyCreated->second;
-    else
     {
-        model = LoadModelFromPath(modelPath, shaderPath);
-        m_models.insert({ modelPath, model });
+        InitializeMeshRendererWithModel(meshRenderer, alreadyCreated->second, shaderPath);
+        return;
     }
 
-    InitializeMeshRendererWithModel(meshRenderer, model, shaderPath);
+    //Not registered for rendering until the model is attached
+    auto waiting = m_waitingModels.find(modelPath);
+    if (waiting == m_waitingModels.end())
+    {
+        WaitingModel model;
+        TextureCache* textureCache = m_textureCache;
+        model.Load = m_modelLoader->Load(modelPath, [textureCache](const std::string& path) { return std::make_shared<LoadingModel>(path, textureCache); });
+        model.ShaderPath = shaderPath;
+        waiting = m_waitingModels.insert({ modelPath, model }).first;
+    }
+
+    waiting->second.Renderers.push_back({ meshRenderer, shaderPath });
 }
 
 void RenderingSystem::InitializeMeshRendererWithModel(MeshRenderer* const& meshRenderer, const Model* const& model, const std::string& shaderPath)
 {
     meshRenderer->m_meshes = &(model->Meshes);
+    meshRenderer->m_bounds = &(model->Bounds);
     m_meshRenderers.insert(meshRenderer);
 
     for (const Model* const& child : model->Children)
@@ -115,196 +401,189 @@ void RenderingSystem::InitializeMeshRendererWithModel(MeshRenderer* const& meshR
     }
 }
 
-const Model* RenderingSystem::LoadModelFromPath(const std::string& modelPath, const std::string& shaderPath)
+void RenderingSystem::RemoveMeshRenderer(MeshRenderer* const& meshRenderer)
 {
-    const Model* model;
+    m_meshRenderers.erase(meshRenderer);
 
-    Assimp::Importer importer;
-    importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, false);
-    unsigned int flags = aiProcess_Triangulate
-        | aiProcess_ConvertToLeftHanded
-        | aiProcess_FixInfacingNormals
-        | aiProcess_FindInvalidData;
-
-    const aiScene* pScene = importer.ReadFile(modelPath, flags);
-    model = LoadModelFromNode(pScene, pScene->mRootNode, shaderPath);
-
-    return model;
+    for (auto& waiting : m_waitingModels)
+    {
+        vector<pair<MeshRenderer*, string>>& renderers = waiting.second.Renderers;
+        renderers.erase(std::remove_if(renderers.begin(), renderers.end(),
+            [&meshRenderer](const pair<MeshRenderer*, string>& renderer) { return renderer.first == meshRenderer; }), renderers.end());
+    }
 }
 
-const Model* RenderingSystem::LoadModelFromNode(const aiScene* const& scene, const aiNode* const& node, const std::string& shaderPath)
+void RenderingSystem::AttachLoadedModels()
 {
-    Model* model = new Model();
-    model->TransformMatrix = GetMatrixFromAssimp(node->mTransformation);
-    model->TransformMatrix = XMMatrixTranspose(model->TransformMatrix);
+    m_modelLoader->TakeFinished(m_loadedModels);
 
-    model->Meshes = LoadMeshesFromNode(scene, node, shaderPath);
-    model->Name = string(node->mName.C_Str());
-
-    for (unsigned int i = 0; i < node->mNumChildren; ++i)
+    for (const shared_ptr<ModelLoad>& loaded : m_loadedModels)
     {
-        if (node->mChildren[i]->mNumMeshes == 0 && node->mChildren[i]->mChildren == 0)
-            continue;
+        if (!loaded->Succeeded())
+            throw std::exception(("Error while loading model " + loaded->GetPath()).c_str());
 
-        const Model* child = LoadModelFromNode(scene, node->mChildren[i], shaderPath);
-        model->Children.push_back(child);
+        //Models stay loaded when all of their renderers are gone, like the ones loaded earlier
+        auto waiting = m_waitingModels.find(loaded->GetPath());
+        const Model* model = UploadModel(*static_cast<LoadingModel*>(loaded.get()), waiting->second.ShaderPath);
+        m_models.insert({ loaded->GetPath(), model });
+
+        vector<pair<MeshRenderer*, string>> renderers;
+        renderers.swap(waiting->second.Renderers);
+        m_waitingModels.erase(waiting);
+
+        for (const pair<MeshRenderer*, string>& renderer : renderers)
+            InitializeMeshRendererWithModel(renderer.first, model, renderer.second);
     }
 
-    return model;
+    m_loadedModels.clear();
 }
 
-vector<const Mesh*> RenderingSystem::LoadMeshesFromNode(const aiScene* const& scene, const aiNode* const& node, const std::string& shaderPath)
+bool RenderingSystem::IsLoadingModels()
 {
-    vector<const Mesh*> meshes;
+    return !m_waitingModels.empty();
+}
 
-    for (unsigned int i = 0; i < node->mNumMeshes; ++i)
-    {
-        Mesh* mesh = new Mesh;
+const Model* RenderingSystem::UploadModel(LoadingModel& load, const std::string& shaderPath)
+{
+    //Buffers are created straight from the mapped cache, which is closed with the load.
+    //Nodes using the same mesh share it
+    const ModelCache& cache = load.GetCache();
 
-        mesh->Material = new Material();
+    for (uint32_t i = 0; i < cache.GetMeshesAmount(); ++i)
+        UploadMesh(load, cache.GetMesh(i), shaderPath, load.Meshes[i]);
 
-        vector<float> vertData;
-        vector<DWORD> indices;
+    const Model* model = LoadModelFromNode(cache, 0, load.Meshes);
+    load.Meshes.clear();
 
-        aiMesh* meshData = scene->mMeshes[node->mMeshes[i]];
+    return model;
+}
 
-        aiMaterial* mat = scene->mMaterials[meshData->mMaterialIndex];
+const Model* RenderingSystem::LoadModelFromNode(const ModelCache& cache, const uint32_t& nodeIndex, const vector<Mesh*>& meshes)
+{
+    const ModelCacheNode& node = cache.GetNode(nodeIndex);
 
-        //Opacity - ignoring transparency for now
-        float opacity;
-        if (AI_SUCCESS == mat->Get(AI_MATKEY_OPACITY, opacity))
-        {
-            if (opacity < 1.0f)
-                continue;
-        }
-        //Finish opacity
+    Model* model = new Model();
+    model->TransformMatrix = XMMATRIX(node.Transform);
 
-        for (int i = 0; i < AI_TEXTURE_TYPE_MAX; ++i)
-        {
-            int amount = mat->GetTextureCount((aiTextureType)i);
+    const uint32_t* meshesIndices = cache.Get<uint32_t>(node.Meshes);
+    for (uint64_t i = 0; i < node.Meshes.Amount; ++i)
+        model->Meshes.push_back(meshes[meshesIndices[i]]);
 
-            for (int a = 0; a < amount; ++a)
-            {
-                aiString path;
-                mat->GetTexture((aiTextureType)i, a, &path);
-                ID3D11ShaderResourceView* srv = GetResourceFromTexturePath(string(path.C_Str()));
-                mesh->Material->Textures.push_back(srv);
-                mesh->Material->ShaderPath = shaderPath;
-            }
+    model->Name = cache.GetString(node.Name);
 
-        }
+    model->Bounds = GetEmptyBounds();
+    for (const Mesh* const& mesh : model->Meshes)
+        model->Bounds = MergeBounds(model->Bounds, mesh->Bounds);
 
-        UINT offset = 0;
+    const uint32_t* children = cache.Get<uint32_t>(node.Children);
+    for (uint64_t i = 0; i < node.Children.Amount; ++i)
+    {
+        const Model* child = LoadModelFromNode(cache, children[i], meshes);
+        model->Children.push_back(child);
+    }
 
-        aiColor3D tmpClr;
-        if (AI_SUCCESS == mat->Get(AI_MATKEY_COLOR_DIFFUSE, tmpClr))
-        {
-            mesh->Material->Diffuse = XMFLOAT3(tmpClr.r, tmpClr.g, tmpClr.b);
-        }
+    return model;
+}
 
-        if (AI_SUCCESS == mat->Get(AI_MATKEY_COLOR_SPECULAR, tmpClr))
-        {
-            mesh->Material->Specular = XMFLOAT3(tmpClr.r, tmpClr.g, tmpClr.b);
-        }
+Mesh* RenderingSystem::LoadMeshData(const ModelCache& cache, const ModelCacheMesh& meshData)
+{
+    Mesh* mesh = new Mesh;
 
-        if (meshData->HasPositions())
-        {
-            mesh->Material->Layout.push_back(
-                { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-            offset += 12;
-        }
+    mesh->Stride = meshData.Stride;
+    mesh->Bounds = meshData.MeshBounds;
 
+    //Kept on the CPU, so copied out of the cache and dequantized
+    const CachedVertexElement* layout = cache.Get<CachedVertexElement>(meshData.Layout);
 
-        if (meshData->HasNormals())
-        {
-            mesh->Material->Layout.push_back(
-                { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT,0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-            offset += 12;
-        }
+    for (uint64_t e = 0; e < meshData.Layout.Amount; ++e)
+    {
+        if (layout[e].Semantic != VertexSemantic::Position)
+            continue;
 
+        mesh->Positions.resize((size_t)meshData.VerticesAmount * 3);
+        UnpackPositions(cache.Get<uint8_t>(meshData.Vertices), meshData.VerticesAmount, meshData.Stride, layout[e], meshData.PositionScale, meshData.PositionOffset, mesh->Positions.data());
+    }
 
-        UINT texIndex = 0;
-        while (meshData->HasTextureCoords(texIndex))
-        {
-            mesh->Material->Layout.push_back(
-                { "TEXCOORD", texIndex, DXGI_FORMAT_R32G32_FLOAT,0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-            offset += 8;
-            ++texIndex;
-        }
+    const uint32_t* triangles = cache.Get<uint32_t>(meshData.Triangles);
+    mesh->Indices.assign(triangles, triangles + meshData.Triangles.Amount);
 
-        UINT clrIndex = 0;
-        while (meshData->HasVertexColors(clrIndex))
-        {
-            mesh->Material->Layout.push_back(
-                { "COLOR", clrIndex, DXGI_FORMAT_R32G32B32A32_FLOAT,0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-            offset += 16;
+    return mesh;
+}
 
-            ++clrIndex;
-        }
+void RenderingSystem::UploadMesh(const LoadingModel& load, const ModelCacheMesh& meshData, const std::string& shaderPath, Mesh* const& mesh)
+{
+    const ModelCache& cache = load.GetCache();
+    mesh->Material = new Material();
 
-        for (unsigned int x = 0; x < meshData->mNumVertices; ++x)
-        {
-            aiVector3D vert = meshData->mVertices[x];
-            if (meshData->HasPositions())
-            {
-                vertData.push_back(vert.x);
-                vertData.push_back(vert.y);
-                vertData.push_back(vert.z);
-            }
+    const ModelCacheRange* textures = cache.Get<ModelCacheRange>(meshData.Textures);
+    for (uint64_t t = 0; t < meshData.Textures.Amount; ++t)
+    {
+        TextureHandle texture = load.Textures.at(cache.GetString(textures[t]));
 
-            if (meshData->HasNormals())
-            {
-                aiVector3D norm = meshData->mNormals[x];
-                vertData.push_back(norm.x);
-                vertData.push_back(norm.y);
-                vertData.push_back(norm.z);
-            }
+        //Not owned by the cache, so it isn't referenced
+        if (texture == nullptr)
+            texture = m_fallbackTexture;
+        else
+            m_textureCache->AddReference(texture);
 
-            texIndex = 0;
-            while (meshData->HasTextureCoords(texIndex))
-            {
-                aiVector3D uvs = meshData->mTextureCoords[texIndex][x];
-                vertData.push_back(uvs.x);
-                vertData.push_back(uvs.y);
+        ID3D11ShaderResourceView* srv = static_cast<ID3D11ShaderResourceView*>(texture);
+        mesh->Material->Textures.push_back(srv);
+        mesh->Material->ShaderPath = shaderPath;
+    }
 
-                ++texIndex;
-            }
+    if (meshData.HasDiffuse)
+        mesh->Material->Diffuse = XMFLOAT3(meshData.Diffuse);
 
-            clrIndex = 0;
-            while (meshData->HasVertexColors(clrIndex))
-            {
-                aiColor4D clr = meshData->mColors[clrIndex][x];
-                vertData.push_back(clr.r);
-                vertData.push_back(clr.g);
-                vertData.push_back(clr.b);
-                vertData.push_back(clr.a);
+    if (meshData.HasSpecular)
+        mesh->Material->Specular = XMFLOAT3(meshData.Specular);
 
-                ++clrIndex;
-            }
-        }
+    mesh->Material->PositionScale = XMFLOAT3(meshData.PositionScale);
+    mesh->Material->PositionOffset = XMFLOAT3(meshData.PositionOffset);
 
-        mesh->Stride = offset;
+    //Semantic names have to outlive the cache, the input layout is recreated with shaders
+    const CachedVertexElement* layout = cache.Get<CachedVertexElement>(meshData.Layout);
 
-        for (unsigned int f = 0; f < meshData->mNumFaces; ++f)
+    for (uint64_t e = 0; e < meshData.Layout.Amount; ++e)
+    {
+        const char* semanticName = nullptr;
+
+        switch (layout[e].Semantic)
         {
-            aiFace face = meshData->mFaces[f];
-            for (unsigned int x = 0; x < face.mNumIndices; ++x)
-            {
-                indices.push_back(face.mIndices[x]);
-            }
+        case VertexSemantic::Position:
+            semanticName = "POSITION";
+            break;
+        case VertexSemantic::Normal:
+            semanticName = "NORMAL";
+            mesh->Material->OctahedralNormals = layout[e].Format == VertexFormat::Snorm16x2;
+            break;
+        case VertexSemantic::TexCoord:
+            semanticName = "TEXCOORD";
+            break;
+        case VertexSemantic::Color:
+            semanticName = "COLOR";
+            break;
         }
 
-        mesh->IndexBuffer = CreateIndexBuffer(indices);
-        mesh->VertexBuffer = CreateVertexBuffer(vertData);
-        mesh->IndicesAmount = (UINT)indices.size();
-
-        meshes.push_back(mesh);
+        mesh->Material->Layout.push_back(
+            { semanticName, layout[e].SemanticIndex, GetVertexFormat(layout[e].Format), 0, layout[e].Offset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
     }
 
-    return meshes;
+    const bool shortIndices = meshData.VerticesAmount <= MAX_SHORT_INDEXED_VERTICES;
+    mesh->IndexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+    mesh->IndexBuffer = CreateIndexBuffer(cache.Get<uint32_t>(meshData.Indices), (size_t)meshData.Indices.Amount, shortIndices);
+    mesh->VertexBuffer = CreateVertexBuffer(cache.Get<uint8_t>(meshData.Vertices), (size_t)meshData.Vertices.Amount);
+    mesh->IndicesAmount = (UINT)meshData.Indices.Amount;
+    m_geometryBytes += (size_t)meshData.Vertices.Amount + (size_t)meshData.Indices.Amount * mesh->IndexSize;
+
+    const ModelCacheRange* lods = cache.Get<ModelCacheRange>(meshData.LODs);
+    for (uint64_t l = 0; l < meshData.LODs.Amount; ++l)
+    {
+        mesh->LODs.push_back({ (UINT)lods[l].Amount, CreateIndexBuffer(cache.Get<uint32_t>(lods[l]), (size_t)lods[l].Amount, shortIndices) });
+        m_geometryBytes += (size_t)lods[l].Amount * mesh->IndexSize;
+    }
 }
 
-ID3D11Buffer* RenderingSystem::CreateVertexBuffer(const std::vector<float>& vertData)
+ID3D11Buffer* RenderingSystem::CreateVertexBuffer(const uint8_t* const& vertData, const size_t& size)
 {
     ID3D11Buffer* result;
 
@@ -312,7 +591,7 @@ ID3D11Buffer* RenderingSystem::CreateVertexBuffer(const std::vector<float>& vert
     ZeroMemory(&vertexBufferDesc, sizeof(vertexBufferDesc));
 
     vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    vertexBufferDesc.ByteWidth = 4 * (UINT)vertData.size();
+    vertexBufferDesc.ByteWidth = (UINT)size;
     vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
     vertexBufferDesc.CPUAccessFlags = 0;
     vertexBufferDesc.MiscFlags = 0;
@@ -320,7 +599,7 @@ ID3D11Buffer* RenderingSystem::CreateVertexBuffer(const std::vector<float>& vert
     D3D11_SUBRESOURCE_DATA vertexBufferData;
 
     ZeroMemory(&vertexBufferData, sizeof(vertexBufferData));
-    vertexBufferData.pSysMem = vertData.data();
+    vertexBufferData.pSysMem = vertData;
     HRESULT hr = Core::GetD3Device()->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &result);
 
     if (hr != S_OK)
@@ -329,18 +608,24 @@ ID3D11Buffer* RenderingSystem::CreateVertexBuffer(const std::vector<float>& vert
     return result;
 }
 
-ID3D11Buffer* RenderingSystem::CreateIndexBuffer(const vector<DWORD>& indices)
+ID3D11Buffer* RenderingSystem::CreateIndexBuffer(const uint32_t* const& indices, const size_t& amount, const bool& shortIndices)
 {
     ID3D11Buffer* result;
 
     D3D11_BUFFER_DESC indexBufferDesc;
     ZeroMemory(&indexBufferDesc, sizeof(indexBufferDesc));
 
+    //The cache keeps 32 bit indices for occlusion culling
+    vector<uint16_t> shortIndicesData;
+    if (shortIndices)
+        shortIndicesData.assign(indices, indices + amount);
+
     D3D11_SUBRESOURCE_DATA iinitData;
-    iinitData.pSysMem = indices.data();
+    ZeroMemory(&iinitData, sizeof(iinitData));
+    iinitData.pSysMem = shortIndices ? (const void*)shortIndicesData.data() : (const void*)indices;
 
     indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    indexBufferDesc.ByteWidth = sizeof(DWORD) * (UINT)indices.size();
+    indexBufferDesc.ByteWidth = (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t)) * (UINT)amount;
     indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
     HRESULT hr = Core::GetD3Device()->CreateBuffer(&indexBufferDesc, &iinitData, &result);
 
@@ -350,45 +635,32 @@ ID3D11Buffer* RenderingSystem::CreateIndexBuffer(const vector<DWORD>& indices)
     return result;
 }
 
-ID3D11ShaderResourceView* RenderingSystem::GetResourceFromTexturePath(std::string path)
-{
-    const Image* images = nullptr;
-
-    DirectX::ScratchImage si;
-    DirectX::TexMetadata meta;
-
-    wstring ws(path.begin(), path.end());
-
-    LoadFromWICFile(ws.c_str(), WIC_FLAGS_NONE, &meta, si);
-    images = si.GetImages();
-
-
-    ID3D11ShaderResourceView* srv;
-    CreateShaderResourceView(Core::GetD3Device(), images, 1, meta, &srv);
-
-    return srv;
-}
-
-DirectX::XMMATRIX RenderingSystem::GetMatrixFromAssimp(const aiMatrix4x4 &matrix)
-{
-    return XMMATRIX(matrix.a1, matrix.a2, matrix.a3, matrix.a4,
-        matrix.b1, matrix.b2, matrix.b3, matrix.b4,
-        matrix.c1, matrix.c2, matrix.c3, matrix.c4,
-        matrix.d1, matrix.d2, matrix.d3, matrix.d4);
-}
-
-void RenderingSystem::ReleaseModel(const Model* const& model)
+void RenderingSystem::ReleaseModel(const Model* const& model, unordered_set<const Mesh*>& releasedMeshes)
 {
     for (const Mesh* const& mesh : model->Meshes)
     {
+        //Shared by several nodes
+        if (!releasedMeshes.insert(mesh).second)
+            continue;
+
         mesh->IndexBuffer->Release();
         mesh->VertexBuffer->Release();
+
+        for (const MeshLOD& lod : mesh->LODs)
+            lod.IndexBuffer->Release();
+
+        for (ID3D11ShaderResourceView* const& texture : mesh->Material->Textures)
+        {
+            if (texture != m_fallbackTexture)
+                m_textureCache->Release(texture);
+        }
+
         delete mesh;
     }
 
     for (const Model* const& child : model->Children)
     {
-        ReleaseModel(child);
+        ReleaseModel(child, releasedMeshes);
     }
 
     delete model;
@@ -1,22 +1,31 @@
 #pragma once
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <string.h>
 #include <DirectXMath.h>
 #include <vector>
-#include <assimp/matrix4x4.h>
 #include "Material.h"
 #include <d3d11.h>
 #include "ConstantBuffers.h"
+#include "DrawList.h"
+#include "ObjectConstants.h"
+#include "FrustumCulling.h"
+#include "OcclusionCulling.h"
+#include "MeshLODs.h"
+#include "ModelCache.h"
+#include "ModelLoader.h"
+#include "TextureCache.h"
+#include "VertexPacking.h"
 
-struct aiScene;
-struct aiNode;
 struct Model;
 struct Mesh;
 class Object;
 class MeshRenderer;
 class Camera;
 class ShadersManager;
+class D3D11RenderStateSink;
+class JobSystem;
 
 class RenderingSystem
 {
@@ -25,32 +34,87 @@ public:
     ~RenderingSystem();
 
 
+    //Frustum and occlusion culling and LOD selection with the camera without jitter, once per frame after the scene update
+    void PrepareFrame(Camera* const& camera);
+    //Called for every pass of the frame, supersampling renders several with jittered cameras
     void RenderRegisteredMeshRenderers(Camera* const& camera);
 
+    //Renderers of models which aren't loaded yet draw nothing until the model is loaded in the background
     void InitializeMeshRendererWithModelPath(MeshRenderer* const& meshRenderer, const std::string& modelPath, const std::string& shaderPath);
     void InitializeMeshRendererWithModel(MeshRenderer* const& meshRenderer, const Model* const& model, const std::string& shaderPath);
+    void RemoveMeshRenderer(MeshRenderer* const& meshRenderer);
+
+    //Uploads models loaded since the last call and initializes renderers waiting for them, once per frame before the scene update
+    void AttachLoadedModels();
+    bool IsLoadingModels();
 
 private:
-    const Model* LoadModelFromPath(const std::string& modelPath, const std::string& shaderPath);
+    class LoadingModel;
+
+    //One load shared by every renderer of the model, materials get the shaders of the first one
+    struct WaitingModel
+    {
+        std::shared_ptr<ModelLoad> Load;
+        std::string ShaderPath;
+        std::vector<std::pair<MeshRenderer*, std::string>> Renderers;
+    };
+
+    struct OccluderCandidate
+    {
+        float ScreenSize;
+        uint32_t ObjectIndex;
+        const std::vector<const Mesh*>* Meshes;
+    };
 
-    const Model* LoadModelFromNode(const aiScene* const& scene, const aiNode* const& node, const std::string& shaderPath);
+    void CullOccludedObjects(const ObjectMatrix& viewProjection);
+    //Neither outside of the frustum nor occluded in the current frame
+    bool IsDrawn(const uint32_t& objectIndex) const;
 
-    std::vector<const Mesh*> LoadMeshesFromNode(const aiScene* const& scene, const aiNode* const& node, const std::string& shaderPath);
+    const Model* UploadModel(LoadingModel& load, const std::string& shaderPath);
 
-    ID3D11Buffer* CreateVertexBuffer(const std::vector<float>& vertData);
-    ID3D11Buffer* CreateIndexBuffer(const std::vector<DWORD>& indices);
+    const Model* LoadModelFromNode(const ModelCache& cache, const uint32_t& nodeIndex, const std::vector<Mesh*>& meshes);
 
-    ID3D11ShaderResourceView* GetResourceFromTexturePath(std::string path);
+    //Touches no D3D objects, so meshes are loaded in parallel
+    static Mesh* LoadMeshData(const ModelCache& cache, const ModelCacheMesh& meshData);
+    void UploadMesh(const LoadingModel& load, const ModelCacheMesh& meshData, const std::string& shaderPath, Mesh* const& mesh);
 
-    DirectX::XMMATRIX GetMatrixFromAssimp(const aiMatrix4x4 &matrix);
+    ID3D11Buffer* CreateVertexBuffer(const uint8_t* const& vertData, const size_t& size);
+    //Narrowed to 16 bits when shortIndices is set
+    ID3D11Buffer* CreateIndexBuffer(const uint32_t* const& indices, const size_t& amount, const bool& shortIndices);
 
-    void ReleaseModel(const Model* const& model);
+    void ReleaseModel(const Model* const& model, std::unordered_set<const Mesh*>& releasedMeshes);
 
     std::unordered_map<std::string,const Model* const> m_models;
+    ModelLoader* m_modelLoader;
+    std::unordered_map<std::string, WaitingModel> m_waitingModels;
+    std::vector<std::shared_ptr<ModelLoad>> m_loadedModels;
 
     std::unordered_set<MeshRenderer*> m_meshRenderers;
 
-    cbPerObject m_cbPerObj;
-    ID3D11Buffer* m_cbPerObjectBuff;
+    std::vector<ObjectMatrix> m_objectsWorlds;
+    std::vector<ObjectMatrix> m_objectsPrevWVPs;
+    std::vector<ObjectConstants> m_objectsConstants;
+    std::vector<ObjectConstants> m_instancesConstants;
+
+    FrustumCuller m_frustumCuller;
+    JobSystem* m_jobSystem;
+    OcclusionCuller* m_occlusionCuller;
+    std::vector<OccluderCandidate> m_occluderCandidates;
+    //Per object index into occlusion culler bounds
+    std::vector<uint32_t> m_occlusionIndices;
+    //Part of the screen height, 0 for renderers outside of the frustum
+    std::vector<float> m_objectsScreenSizes;
+    DrawList m_drawList;
+    D3D11RenderStateSink* m_renderStateSink;
+    //Formats models are imported with, changing them imports models again
+    VertexPacking m_vertexPacking;
+    //Vertex and index buffers of all loaded models
+    size_t m_geometryBytes = 0;
+    ITextureDecoder* m_textureDecoder;
+    ITextureDevice* m_textureDevice;
+    //Shared by materials and loads in flight, each of them holds a reference
+    TextureCache* m_textureCache;
+    //1x1 white, bound instead of textures which failed to load so they don't split draws by a null view
+    TextureHandle m_fallbackTexture;
 };
 
@@ -0,0 +1,745 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include "JobSystem.h"
+#include "VertexPacking.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFTWARE_RASTERIZER_SSE
+#endif
+
+#define CLIP_PLANES 6
+#define CLIP_MAX_VERTICES (3 + CLIP_PLANES)
+
+namespace
+{
+    inline float Saturate(const float& value)
+    {
+        return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    }
+
+    inline float Dot3(const float* const& a, const float* const& b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    inline void Normalize(float* const& v)
+    {
+        const float length = sqrtf(Dot3(v, v));
+
+        if (length > 0.0f)
+        {
+            v[0] /= length;
+            v[1] /= length;
+            v[2] /= length;
+        }
+    }
+
+    //Rows of a transposed matrix are the columns of the original one
+    inline float TransformComponent(const ObjectMatrix& transposed, const int& component, const float* const& position)
+    {
+        const float* row = transposed.M[component];
+        return row[0] * position[0] + row[1] * position[1] + row[2] * position[2] + row[3];
+    }
+
+    const CachedVertexElement* FindVertexElement(const SoftwareMesh& mesh, const VertexSemantic& semantic)
+    {
+        for (size_t e = 0; e < mesh.LayoutAmount; ++e)
+        {
+            if (mesh.Layout[e].Semantic == semantic && mesh.Layout[e].SemanticIndex == 0)
+                return &mesh.Layout[e];
+        }
+
+        return nullptr;
+    }
+
+    inline uint8_t ToUNorm(const float& value)
+    {
+        return (uint8_t)(Saturate(value) * 255.0f + 0.5f);
+    }
+
+    void SampleTexture(const SoftwareTexture* const& texture, const float& u, const float& v, float color[4])
+    {
+        //Pixel centers outside of tiny triangles extrapolate far away
+        if (texture == nullptr || texture->Width <= 0 || texture->Height <= 0 || !(fabsf(u) < 1e6f && fabsf(v) < 1e6f))
+        {
+            color[0] = color[1] = color[2] = color[3] = 0.0f;
+            return;
+        }
+
+        const float x = u * texture->Width - 0.5f;
+        const float y = v * texture->Height - 0.5f;
+        const float floorX = floorf(x);
+        const float floorY = floorf(y);
+        const float fractionX = x - floorX;
+        const float fractionY = y - floorY;
+
+        int x0 = (int)floorX % texture->Width;
+        int y0 = (int)floorY % texture->Height;
+        x0 = x0 < 0 ? x0 + texture->Width : x0;
+        y0 = y0 < 0 ? y0 + texture->Height : y0;
+        const int x1 = x0 + 1 == texture->Width ? 0 : x0 + 1;
+        const int y1 = y0 + 1 == texture->Height ? 0 : y0 + 1;
+
+        const uint8_t* t00 = texture->Texels + ((size_t)y0 * texture->Width + x0) * 4;
+        const uint8_t* t10 = texture->Texels + ((size_t)y0 * texture->Width + x1) * 4;
+        const uint8_t* t01 = texture->Texels + ((size_t)y1 * texture->Width + x0) * 4;
+        const uint8_t* t11 = texture->Texels + ((size_t)y1 * texture->Width + x1) * 4;
+
+        for (int c = 0; c < 4; ++c)
+        {
+            const float top = t00[c] + (t10[c] - t00[c]) * fractionX;
+            const float bottom = t01[c] + (t11[c] - t01[c]) * fractionX;
+            color[c] = (top + (bottom - top) * fractionY) / 255.0f;
+        }
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(JobSystem* const& jobSystem) : m_jobSystem(jobSystem)
+{
+}
+
+void SoftwareRasterizer::SetTarget(const int& width, const int& height, const float (*sampleOffsets)[2], const int& samplesAmount, const SoftwareShading& shading)
+{
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_stride = (m_width + 3) & ~3;
+    m_tilesX = (m_width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+    m_tilesY = (m_height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+    m_shading = shading;
+
+    m_samplesAmount = std::min(std::max(samplesAmount, 1), SOFTWARE_MAX_SAMPLES);
+
+    for (int c = 0; c < 2; ++c)
+    {
+        m_samplesMin[c] = 0.5f;
+        m_samplesMax[c] = -0.5f;
+
+        for (int i = 0; i < m_samplesAmount; ++i)
+        {
+            m_sampleOffsets[i][c] = sampleOffsets != nullptr && samplesAmount > 0 ? sampleOffsets[i][c] : 0.0f;
+            m_samplesMin[c] = std::min(m_samplesMin[c], m_sampleOffsets[i][c]);
+            m_samplesMax[c] = std::max(m_samplesMax[c], m_sampleOffsets[i][c]);
+        }
+    }
+
+    const size_t size = (size_t)m_samplesAmount * m_height * m_stride;
+    m_depth.resize(size);
+    m_color.resize(size);
+    m_velocity.resize(size * 2);
+}
+
+void SoftwareRasterizer::Clear(const uint32_t& color)
+{
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+    std::fill(m_color.begin(), m_color.end(), color);
+    std::fill(m_velocity.begin(), m_velocity.end(), 0.0f);
+}
+
+void SoftwareRasterizer::Draw(const SoftwareDrawCommand* const& commands, const size_t& amount, const SoftwareFrameConstants& frame)
+{
+    m_frame = frame;
+    m_frame.DirectionalLightsAmount = std::min(std::max(frame.DirectionalLightsAmount, 0), SOFTWARE_MAX_LIGHTS);
+
+    if (m_tilesX == 0 || m_tilesY == 0)
+        return;
+
+    ShadeVertices(commands, amount, m_frame);
+    SetupTriangles(commands, amount);
+
+    m_jobSystem->Run(m_tilesX * m_tilesY, [this](const int& tile) { RasterizeTile(tile); });
+}
+
+void SoftwareRasterizer::Resolve(std::vector<uint32_t>& output) const
+{
+    output.resize((size_t)m_width * m_height);
+
+    m_jobSystem->Run(m_height, [this, &output](const int& y)
+    {
+        for (int x = 0; x < m_width; ++x)
+        {
+            uint32_t sums[4] = { 0, 0, 0, 0 };
+
+            for (int s = 0; s < m_samplesAmount; ++s)
+            {
+                const uint32_t color = m_color[GetSampleIndex(x, y, s)];
+
+                for (int c = 0; c < 4; ++c)
+                    sums[c] += (color >> (c * 8)) & 0xFF;
+            }
+
+            uint32_t resolved = 0;
+
+            for (int c = 0; c < 4; ++c)
+                resolved |= ((sums[c] + m_samplesAmount / 2) / m_samplesAmount) << (c * 8);
+
+            output[(size_t)y * m_width + x] = resolved;
+        }
+    });
+}
+
+void SoftwareRasterizer::GetVelocity(const int& x, const int& y, const int& sample, float velocity[2]) const
+{
+    const size_t index = GetSampleIndex(x, y, sample) * 2;
+    velocity[0] = m_velocity[index];
+    velocity[1] = m_velocity[index + 1];
+}
+
+void SoftwareRasterizer::ShadeVertices(const SoftwareDrawCommand* const& commands, const size_t& amount, const SoftwareFrameConstants& frame)
+{
+    m_verticesOffsets.resize(amount + 1);
+    m_verticesOffsets[0] = 0;
+
+    for (size_t i = 0; i < amount; ++i)
+        m_verticesOffsets[i + 1] = m_verticesOffsets[i] + commands[i].Mesh->VerticesAmount;
+
+    const size_t verticesAmount = m_verticesOffsets[amount];
+    m_shadedVertices.resize(verticesAmount);
+
+    const int jobsAmount = (int)((verticesAmount + SOFTWARE_VERTICES_PER_JOB - 1) / SOFTWARE_VERTICES_PER_JOB);
+
+    m_jobSystem->Run(jobsAmount, [this, commands, &frame, verticesAmount](const int& job)
+    {
+        const size_t first = (size_t)job * SOFTWARE_VERTICES_PER_JOB;
+        const size_t last = std::min(first + SOFTWARE_VERTICES_PER_JOB, verticesAmount);
+        size_t command = (size_t)(std::upper_bound(m_verticesOffsets.begin(), m_verticesOffsets.end(), first) - m_verticesOffsets.begin()) - 1;
+
+        //Elements are looked up once per command
+        size_t elementsCommand = SIZE_MAX;
+        const CachedVertexElement* positionElement = nullptr;
+        const CachedVertexElement* normalElement = nullptr;
+        const CachedVertexElement* texCoordElement = nullptr;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            while (i >= m_verticesOffsets[command + 1])
+                ++command;
+
+            const SoftwareMesh& mesh = *commands[command].Mesh;
+
+            if (elementsCommand != command)
+            {
+                elementsCommand = command;
+                positionElement = FindVertexElement(mesh, VertexSemantic::Position);
+                normalElement = FindVertexElement(mesh, VertexSemantic::Normal);
+                texCoordElement = FindVertexElement(mesh, VertexSemantic::TexCoord);
+            }
+
+            if (positionElement == nullptr)
+                continue;
+
+            const ObjectConstants& object = *commands[command].Object;
+            const uint8_t* vertex = mesh.Vertices + (i - m_verticesOffsets[command]) * mesh.Stride;
+            ShadedVertex& output = m_shadedVertices[i];
+
+            float modelPosition[3];
+            float modelNormal[3] = { 0.0f, 0.0f, 0.0f };
+            float texCoord[2] = { 0.0f, 0.0f };
+
+            UnpackPositions(vertex, 1, mesh.Stride, *positionElement, mesh.PositionScale, mesh.PositionOffset, modelPosition);
+
+            if (normalElement != nullptr)
+                UnpackNormals(vertex, 1, mesh.Stride, *normalElement, modelNormal);
+
+            if (texCoordElement != nullptr)
+                UnpackTexCoords(vertex, 1, mesh.Stride, *texCoordElement, texCoord);
+
+            for (int c = 0; c < 4; ++c)
+            {
+                output.Position[c] = TransformComponent(object.WVP, c, modelPosition);
+                output.PrevPosition[c] = TransformComponent(object.PrevWVP, c, modelPosition);
+            }
+
+            float position[3];
+            float normal[3];
+
+            for (int c = 0; c < 3; ++c)
+            {
+                position[c] = TransformComponent(object.W, c, modelPosition);
+                normal[c] = Dot3(object.W.M[c], modelNormal);
+            }
+
+            Normalize(normal);
+
+            output.TexCoord[0] = texCoord[0] * SOFTWARE_TEXCOORD_SCALE;
+            output.TexCoord[1] = texCoord[1] * SOFTWARE_TEXCOORD_SCALE;
+
+            //CalcLighting of Light.fxh
+            float toCamera[3] = { frame.CameraPos[0] - position[0], frame.CameraPos[1] - position[1], frame.CameraPos[2] - position[2] };
+            Normalize(toCamera);
+
+            float diffuse[3] = { frame.Ambient[0], frame.Ambient[1], frame.Ambient[2] };
+            float specular[3] = { 0.0f, 0.0f, 0.0f };
+
+            for (int l = 0; l < frame.DirectionalLightsAmount; ++l)
+            {
+                const float* direction = frame.LightsDirections[l];
+                const float* color = frame.LightsColors[l];
+
+                float normalizedDirection[3] = { direction[0], direction[1], direction[2] };
+                Normalize(normalizedDirection);
+
+                const float lambert = Saturate(-Dot3(normal, direction));
+                const float reflection = -2.0f * Dot3(normalizedDirection, normal);
+                const float reflected[3] = { direction[0] + reflection * normal[0], direction[1] + reflection * normal[1], direction[2] + reflection * normal[2] };
+                const float phong = Saturate(Dot3(toCamera, reflected));
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    diffuse[c] += lambert * color[c];
+                    specular[c] += phong * color[c];
+                }
+            }
+
+            for (int c = 0; c < 3; ++c)
+            {
+                specular[c] *= specular[c];
+                specular[c] *= specular[c];
+
+                output.Diffuse[c] = diffuse[c] * mesh.Diffuse[c];
+                output.Specular[c] = specular[c] * mesh.Specular[c];
+            }
+        }
+    });
+}
+
+void SoftwareRasterizer::SetupTriangles(const SoftwareDrawCommand* const& commands, const size_t& amount)
+{
+    m_trianglesOffsets.resize(amount + 1);
+    m_trianglesOffsets[0] = 0;
+
+    for (size_t i = 0; i < amount; ++i)
+        m_trianglesOffsets[i + 1] = m_trianglesOffsets[i] + commands[i].Mesh->IndicesAmount / 3;
+
+    const size_t trianglesAmount = m_trianglesOffsets[amount];
+    const int jobsAmount = (int)((trianglesAmount + SOFTWARE_TRIANGLES_PER_JOB - 1) / SOFTWARE_TRIANGLES_PER_JOB);
+    const size_t tilesAmount = (size_t)m_tilesX * m_tilesY;
+
+    if (m_setupTriangles.size() < (size_t)jobsAmount)
+    {
+        m_setupTriangles.resize(jobsAmount);
+        m_bins.resize(jobsAmount);
+    }
+
+    for (int job = 0; job < jobsAmount; ++job)
+    {
+        m_setupTriangles[job].clear();
+        m_bins[job].resize(tilesAmount);
+
+        for (std::vector<uint32_t>& bin : m_bins[job])
+            bin.clear();
+    }
+
+    //Bins of jobs from previous, bigger draws would be walked otherwise
+    for (size_t job = jobsAmount; job < m_bins.size(); ++job)
+    {
+        m_setupTriangles[job].clear();
+
+        for (std::vector<uint32_t>& bin : m_bins[job])
+            bin.clear();
+    }
+
+    m_jobSystem->Run(jobsAmount, [this, commands, trianglesAmount](const int& job)
+    {
+        const size_t first = (size_t)job * SOFTWARE_TRIANGLES_PER_JOB;
+        const size_t last = std::min(first + SOFTWARE_TRIANGLES_PER_JOB, trianglesAmount);
+        size_t command = (size_t)(std::upper_bound(m_trianglesOffsets.begin(), m_trianglesOffsets.end(), first) - m_trianglesOffsets.begin()) - 1;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            while (i >= m_trianglesOffsets[command + 1])
+                ++command;
+
+            const SoftwareMesh& mesh = *commands[command].Mesh;
+
+            //Its vertices weren't shaded
+            if (FindVertexElement(mesh, VertexSemantic::Position) == nullptr)
+                continue;
+
+            const uint32_t* indices = mesh.Indices + (i - m_trianglesOffsets[command]) * 3;
+
+            if (indices[0] >= mesh.VerticesAmount || indices[1] >= mesh.VerticesAmount || indices[2] >= mesh.VerticesAmount)
+                continue;
+
+            const ShadedVertex* vertices = &m_shadedVertices[m_verticesOffsets[command]];
+            const ShadedVertex triangle[3] = { vertices[indices[0]], vertices[indices[1]], vertices[indices[2]] };
+
+            ClipTriangle(triangle, mesh.Texture, m_setupTriangles[job], job);
+        }
+    });
+
+    m_trianglesAmount = 0;
+
+    for (int job = 0; job < jobsAmount; ++job)
+        m_trianglesAmount += m_setupTriangles[job].size();
+}
+
+void SoftwareRasterizer::ClipTriangle(const ShadedVertex* const& vertices, const SoftwareTexture* const& texture, std::vector<SetupTriangle>& triangles, const int& job)
+{
+    static_assert(sizeof(ShadedVertex) % sizeof(float) == 0, "Shaded vertex has to be made of floats only");
+    const int floatsAmount = sizeof(ShadedVertex) / sizeof(float);
+
+    const float guardBandX = 1.0f + 2.0f * SOFTWARE_GUARD_BAND / m_width;
+    const float guardBandY = 1.0f + 2.0f * SOFTWARE_GUARD_BAND / m_height;
+
+    //Near, far and the guard band, inside when positive
+    auto getDistance = [guardBandX, guardBandY](const ShadedVertex& vertex, const int& plane)
+    {
+        const float* p = vertex.Position;
+
+        switch (plane)
+        {
+        case 0: return p[2];
+        case 1: return p[3] - p[2];
+        case 2: return p[0] + guardBandX * p[3];
+        case 3: return guardBandX * p[3] - p[0];
+        case 4: return p[1] + guardBandY * p[3];
+        default: return guardBandY * p[3] - p[1];
+        }
+    };
+
+    int outsideAll = (1 << CLIP_PLANES) - 1;
+    int outsideAny = 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        int outside = 0;
+
+        for (int plane = 0; plane < CLIP_PLANES; ++plane)
+            outside |= getDistance(vertices[i], plane) < 0.0f ? 1 << plane : 0;
+
+        outsideAll &= outside;
+        outsideAny |= outside;
+    }
+
+    if (outsideAll != 0)
+        return;
+
+    if (outsideAny == 0)
+    {
+        AddTriangle(vertices[0], vertices[1], vertices[2], texture, triangles, job);
+        return;
+    }
+
+    //Sutherland-Hodgman against the planes crossed by the triangle
+    ShadedVertex polygons[2][CLIP_MAX_VERTICES];
+    int amounts[2] = { 3, 0 };
+    int current = 0;
+
+    std::copy(vertices, vertices + 3, polygons[0]);
+
+    for (int plane = 0; plane < CLIP_PLANES; ++plane)
+    {
+        if ((outsideAny & (1 << plane)) == 0)
+            continue;
+
+        const ShadedVertex* input = polygons[current];
+        ShadedVertex* output = polygons[1 - current];
+        int& outputAmount = amounts[1 - current];
+        outputAmount = 0;
+
+        for (int i = 0; i < amounts[current]; ++i)
+        {
+            const ShadedVertex& a = input[i];
+            const ShadedVertex& b = input[(i + 1) % amounts[current]];
+            const float distanceA = getDistance(a, plane);
+            const float distanceB = getDistance(b, plane);
+
+            if (distanceA >= 0.0f)
+                output[outputAmount++] = a;
+
+            if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+            {
+                const float t = distanceA / (distanceA - distanceB);
+                const float* from = (const float*)&a;
+                const float* to = (const float*)&b;
+                float* result = (float*)&output[outputAmount++];
+
+                for (int f = 0; f < floatsAmount; ++f)
+                    result[f] = from[f] + (to[f] - from[f]) * t;
+            }
+        }
+
+        current = 1 - current;
+
+        if (amounts[current] < 3)
+            return;
+    }
+
+    for (int i = 2; i < amounts[current]; ++i)
+        AddTriangle(polygons[current][0], polygons[current][i - 1], polygons[current][i], texture, triangles, job);
+}
+
+void SoftwareRasterizer::AddTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, const SoftwareTexture* const& texture, std::vector<SetupTriangle>& triangles, const int& job)
+{
+    const ShadedVertex* vertices[3] = { &v0, &v1, &v2 };
+    SetupTriangle triangle;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const float* p = vertices[i]->Position;
+
+        if (p[3] <= 0.0f)
+            return;
+
+        const float invW = 1.0f / p[3];
+        const float x = (p[0] * invW * 0.5f + 0.5f) * m_width;
+        const float y = (0.5f - p[1] * invW * 0.5f) * m_height;
+
+        triangle.X[i] = floorf(x * SOFTWARE_SUBPIXEL_STEPS + 0.5f) / SOFTWARE_SUBPIXEL_STEPS;
+        triangle.Y[i] = floorf(y * SOFTWARE_SUBPIXEL_STEPS + 0.5f) / SOFTWARE_SUBPIXEL_STEPS;
+        triangle.Z[i] = p[2] * invW;
+        triangle.InvW[i] = invW;
+
+        const ShadedVertex& vertex = *vertices[i];
+        const float attributes[SOFTWARE_ATTRIBUTES] = {
+            vertex.PrevPosition[0], vertex.PrevPosition[1], vertex.PrevPosition[3],
+            vertex.TexCoord[0], vertex.TexCoord[1],
+            vertex.Diffuse[0], vertex.Diffuse[1], vertex.Diffuse[2],
+            vertex.Specular[0], vertex.Specular[1], vertex.Specular[2] };
+
+        for (int a = 0; a < SOFTWARE_ATTRIBUTES; ++a)
+            triangle.Attributes[i][a] = attributes[a] * invW;
+    }
+
+    float area = (triangle.X[1] - triangle.X[0]) * (triangle.Y[2] - triangle.Y[0]) - (triangle.Y[1] - triangle.Y[0]) * (triangle.X[2] - triangle.X[0]);
+
+    if (area == 0.0f)
+        return;
+
+    //No culling, counter clockwise triangles are flipped so the edge functions are positive inside
+    if (area < 0.0f)
+    {
+        std::swap(triangle.X[1], triangle.X[2]);
+        std::swap(triangle.Y[1], triangle.Y[2]);
+        std::swap(triangle.Z[1], triangle.Z[2]);
+        std::swap(triangle.InvW[1], triangle.InvW[2]);
+
+        for (int a = 0; a < SOFTWARE_ATTRIBUTES; ++a)
+            std::swap(triangle.Attributes[1][a], triangle.Attributes[2][a]);
+
+        area = -area;
+    }
+
+    triangle.InvArea = 1.0f / area;
+    triangle.Texture = texture;
+
+    const float minX = std::min(triangle.X[0], std::min(triangle.X[1], triangle.X[2]));
+    const float minY = std::min(triangle.Y[0], std::min(triangle.Y[1], triangle.Y[2]));
+    const float maxX = std::max(triangle.X[0], std::max(triangle.X[1], triangle.X[2]));
+    const float maxY = std::max(triangle.Y[0], std::max(triangle.Y[1], triangle.Y[2]));
+
+    //Pixels which have any sample inside of the box
+    triangle.MinX = std::max((int)floorf(minX - 0.5f - m_samplesMax[0]), 0);
+    triangle.MinY = std::max((int)floorf(minY - 0.5f - m_samplesMax[1]), 0);
+    triangle.MaxX = std::min((int)floorf(maxX - 0.5f - m_samplesMin[0]), m_width - 1);
+    triangle.MaxY = std::min((int)floorf(maxY - 0.5f - m_samplesMin[1]), m_height - 1);
+
+    if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+        return;
+
+    const uint32_t index = (uint32_t)triangles.size();
+    triangles.push_back(triangle);
+
+    std::vector<std::vector<uint32_t>>& bins = m_bins[job];
+
+    for (int tileY = triangle.MinY / SOFTWARE_TILE_SIZE; tileY <= triangle.MaxY / SOFTWARE_TILE_SIZE; ++tileY)
+    {
+        for (int tileX = triangle.MinX / SOFTWARE_TILE_SIZE; tileX <= triangle.MaxX / SOFTWARE_TILE_SIZE; ++tileX)
+            bins[(size_t)tileY * m_tilesX + tileX].push_back(index);
+    }
+}
+
+void SoftwareRasterizer::RasterizeTile(const int& tile)
+{
+    const int tileX = tile % m_tilesX;
+    const int tileY = tile / m_tilesX;
+
+    for (size_t job = 0; job < m_bins.size(); ++job)
+    {
+        if (m_bins[job].size() <= (size_t)tile)
+            continue;
+
+        for (const uint32_t& index : m_bins[job][tile])
+            RasterizeTriangle(m_setupTriangles[job][index], tileX, tileY);
+    }
+}
+
+#ifdef SOFTWARE_RASTERIZER_SSE
+
+inline int SoftwareRasterizer::TestSamples(const TileTriangle& triangle, const float& x, const float& y, float* const& depth, const int& lanes)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 xs = _mm_add_ps(_mm_set1_ps(x), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    __m128 z = zero;
+
+    for (int e = 0; e < 3; ++e)
+    {
+        const __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.A[e]), xs), _mm_set1_ps(triangle.B[e] * y + triangle.C[e]));
+
+        //Samples exactly on an edge belong to the triangle only if it's a top or left edge
+        inside = _mm_and_ps(inside, triangle.TopLeft[e] ? _mm_cmpge_ps(edge, zero) : _mm_cmpgt_ps(edge, zero));
+        z = _mm_add_ps(z, _mm_mul_ps(edge, _mm_set1_ps(triangle.ZWeights[e])));
+    }
+
+    if ((_mm_movemask_ps(inside) & lanes) == 0)
+        return 0;
+
+    const __m128 laneMask = _mm_castsi128_ps(_mm_set_epi32((lanes & 8) ? -1 : 0, (lanes & 4) ? -1 : 0, (lanes & 2) ? -1 : 0, (lanes & 1) ? -1 : 0));
+    const __m128 stored = _mm_loadu_ps(depth);
+    const __m128 passed = _mm_and_ps(_mm_and_ps(inside, laneMask), _mm_cmplt_ps(z, stored));
+
+    _mm_storeu_ps(depth, _mm_or_ps(_mm_and_ps(passed, z), _mm_andnot_ps(passed, stored)));
+
+    return _mm_movemask_ps(passed);
+}
+
+#else
+
+inline int SoftwareRasterizer::TestSamples(const TileTriangle& triangle, const float& x, const float& y, float* const& depth, const int& lanes)
+{
+    int passed = 0;
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        if ((lanes & (1 << lane)) == 0)
+            continue;
+
+        bool inside = true;
+        float z = 0.0f;
+
+        for (int e = 0; e < 3; ++e)
+        {
+            const float edge = triangle.A[e] * (x + lane) + (triangle.B[e] * y + triangle.C[e]);
+
+            inside = inside && (triangle.TopLeft[e] ? edge >= 0.0f : edge > 0.0f);
+            z += edge * triangle.ZWeights[e];
+        }
+
+        if (inside && z < depth[lane])
+        {
+            depth[lane] = z;
+            passed |= 1 << lane;
+        }
+    }
+
+    return passed;
+}
+
+#endif
+
+void SoftwareRasterizer::RasterizeTriangle(const SetupTriangle& triangle, const int& tileX, const int& tileY)
+{
+    const int originX = tileX * SOFTWARE_TILE_SIZE;
+    const int originY = tileY * SOFTWARE_TILE_SIZE;
+
+    TileTriangle tileTriangle;
+    tileTriangle.OriginX = (float)originX;
+    tileTriangle.OriginY = (float)originY;
+
+    for (int e = 0; e < 3; ++e)
+    {
+        const int next = (e + 1) % 3;
+        const double dx = (double)triangle.X[next] - triangle.X[e];
+        const double dy = (double)triangle.Y[next] - triangle.Y[e];
+
+        tileTriangle.A[e] = (float)-dy;
+        tileTriangle.B[e] = (float)dx;
+        tileTriangle.C[e] = (float)(-dy * (originX - (double)triangle.X[e]) + dx * (originY - (double)triangle.Y[e]));
+        tileTriangle.TopLeft[e] = dy < 0.0 || (dy == 0.0 && dx > 0.0);
+    }
+
+    //Edge opposite to a vertex weights that vertex
+    tileTriangle.ZWeights[0] = triangle.Z[2] * triangle.InvArea;
+    tileTriangle.ZWeights[1] = triangle.Z[0] * triangle.InvArea;
+    tileTriangle.ZWeights[2] = triangle.Z[1] * triangle.InvArea;
+
+    const int firstX = std::max(triangle.MinX, originX) & ~3;
+    const int lastX = std::min(triangle.MaxX, originX + SOFTWARE_TILE_SIZE - 1);
+    const int firstY = std::max(triangle.MinY, originY);
+    const int lastY = std::min(triangle.MaxY, originY + SOFTWARE_TILE_SIZE - 1);
+
+    int masks[SOFTWARE_MAX_SAMPLES];
+
+    for (int y = firstY; y <= lastY; ++y)
+    {
+        const float localY = (float)(y - originY) + 0.5f;
+
+        for (int x = firstX; x <= lastX; x += 4)
+        {
+            const float localX = (float)(x - originX) + 0.5f;
+            const int lanes = lastX - x >= 3 ? 0xF : (1 << (lastX - x + 1)) - 1;
+            int covered = 0;
+
+            for (int s = 0; s < m_samplesAmount; ++s)
+            {
+                masks[s] = TestSamples(tileTriangle, localX + m_sampleOffsets[s][0], localY + m_sampleOffsets[s][1], &m_depth[GetSampleIndex(x, y, s)], lanes);
+                covered |= masks[s];
+            }
+
+            if (covered == 0)
+                continue;
+
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if ((covered & (1 << lane)) == 0)
+                    continue;
+
+                uint32_t color = 0;
+                float velocity[2];
+
+                if (m_shading == SoftwareShading::PerPixel)
+                    Shade(triangle, tileTriangle, localX + lane, localY, color, velocity);
+
+                for (int s = 0; s < m_samplesAmount; ++s)
+                {
+                    if ((masks[s] & (1 << lane)) == 0)
+                        continue;
+
+                    if (m_shading == SoftwareShading::PerSample)
+                        Shade(triangle, tileTriangle, localX + lane + m_sampleOffsets[s][0], localY + m_sampleOffsets[s][1], color, velocity);
+
+                    const size_t index = GetSampleIndex(x + lane, y, s);
+                    m_color[index] = color;
+                    m_velocity[index * 2] = velocity[0];
+                    m_velocity[index * 2 + 1] = velocity[1];
+                }
+            }
+        }
+    }
+}
+
+
+void SoftwareRasterizer::Shade(const SetupTriangle& triangle, const TileTriangle& tileTriangle, const float& x, const float& y, uint32_t& color, float velocity[2]) const
+{
+    float weights[3];
+
+    for (int e = 0; e < 3; ++e)
+        weights[(e + 2) % 3] = tileTriangle.A[e] * x + tileTriangle.B[e] * y + tileTriangle.C[e];
+
+    const float w = 1.0f / (weights[0] * triangle.InvW[0] + weights[1] * triangle.InvW[1] + weights[2] * triangle.InvW[2]);
+    float attributes[SOFTWARE_ATTRIBUTES];
+
+    for (int a = 0; a < SOFTWARE_ATTRIBUTES; ++a)
+        attributes[a] = (weights[0] * triangle.Attributes[0][a] + weights[1] * triangle.Attributes[1][a] + weights[2] * triangle.Attributes[2][a]) * w;
+
+    float texel[4];
+    SampleTexture(triangle.Texture, attributes[3], attributes[4], texel);
+
+    color = (uint32_t)ToUNorm(texel[0] * attributes[5] + attributes[8])
+        | ((uint32_t)ToUNorm(texel[1] * attributes[6] + attributes[9]) << 8)
+        | ((uint32_t)ToUNorm(texel[2] * attributes[7] + attributes[10]) << 16)
+        | ((uint32_t)ToUNorm(texel[3]) << 24);
+
+    const float prevX = (attributes[0] / attributes[2] * 0.5f + 0.5f) * m_width;
+    const float prevY = (attributes[1] / attributes[2] * -0.5f + 0.5f) * m_height;
+
+    velocity[0] = (tileTriangle.OriginX + x - prevX - m_frame.JitterOffset[0]) / m_width;
+    velocity[1] = (tileTriangle.OriginY + y - prevY - m_frame.JitterOffset[1]) / m_height;
+
+    if (velocity[0] * velocity[0] + velocity[1] * velocity[1] < 0.00001f * 0.00001f)
+        velocity[0] = velocity[1] = 0.0f;
+}
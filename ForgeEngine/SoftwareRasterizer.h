@@ -0,0 +1,192 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ModelCache.h"
+#include "ObjectConstants.h"
+
+#define SOFTWARE_TILE_SIZE 64
+#define SOFTWARE_MAX_SAMPLES 64
+//Has to match cbLights
+#define SOFTWARE_MAX_LIGHTS 10
+//Vertices are snapped to 8 bits of sub pixel precision, the same as D3D does
+#define SOFTWARE_SUBPIXEL_STEPS 256.0f
+//Triangles are clipped in x and y only when they reach this many pixels outside the viewport
+#define SOFTWARE_GUARD_BAND 4096.0f
+#define SOFTWARE_VERTICES_PER_JOB 4096
+#define SOFTWARE_TRIANGLES_PER_JOB 2048
+//Base.fx tiles textures 10 times
+#define SOFTWARE_TEXCOORD_SCALE 10.0f
+//Previous position x, y, w, texcoord, diffuse and specular
+#define SOFTWARE_ATTRIBUTES 11
+
+class JobSystem;
+
+//RGBA8, sampled bilinearly with wrapping like LinearSampler
+struct SoftwareTexture
+{
+    const uint8_t* Texels;
+    int Width;
+    int Height;
+};
+
+//Interleaved vertices as RenderingSystem uploads them, read through their layout so packed formats are decoded like the input assembler does.
+//Meshes without a position are skipped, missing normals and texture coordinates read as zeros
+struct SoftwareMesh
+{
+    const uint8_t* Vertices;
+    size_t VerticesAmount;
+    //In bytes, like Mesh::Stride
+    uint32_t Stride;
+    const CachedVertexElement* Layout;
+    size_t LayoutAmount;
+    //Dequantize Unorm16x4 positions, like Material::PositionScale and PositionOffset
+    float PositionScale[3];
+    float PositionOffset[3];
+
+    const uint32_t* Indices;
+    size_t IndicesAmount;
+
+    //nullptr samples zeros like an unbound SRV
+    const SoftwareTexture* Texture;
+    float Diffuse[3];
+    float Specular[3];
+};
+
+struct SoftwareDrawCommand
+{
+    const SoftwareMesh* Mesh;
+    //As uploaded to cbPerObject, transposed
+    const ObjectConstants* Object;
+};
+
+//cbLights, cbCameraInfo and cbTAA
+struct SoftwareFrameConstants
+{
+    float Ambient[3];
+    int DirectionalLightsAmount;
+    float LightsDirections[SOFTWARE_MAX_LIGHTS][3];
+    float LightsColors[SOFTWARE_MAX_LIGHTS][3];
+    float CameraPos[3];
+    float JitterOffset[2];
+};
+
+enum class SoftwareShading
+{
+    //MSAA - pixel shader runs once at the pixel center and its result is written to all covered samples
+    PerPixel,
+    //SSAA - pixel shader runs at every covered sample
+    PerSample
+};
+
+//Renders what Base.fx does with the engine's rasterizer state (no culling, depth less) into color, depth and velocity samples.
+//Triangles are binned into screen tiles and every tile is rasterized by a single job, so no samples are shared between threads
+class SoftwareRasterizer
+{
+public:
+    SoftwareRasterizer(JobSystem* const& jobSystem);
+
+    //Offsets are in pixels from the pixel center, x right and y down.
+    //AAHelpers patterns are camera offsets spanning two pixels, its (x, y) lands at (-0.5x, 0.5y)
+    void SetTarget(const int& width, const int& height, const float (*sampleOffsets)[2], const int& samplesAmount, const SoftwareShading& shading);
+
+    //color is RGBA8 like R8G8B8A8_UNORM in memory, depth is cleared to 1 and velocity to 0
+    void Clear(const uint32_t& color);
+    void Draw(const SoftwareDrawCommand* const& commands, const size_t& amount, const SoftwareFrameConstants& frame);
+
+    //Box filter over samples, the same as ResolveSubresource
+    void Resolve(std::vector<uint32_t>& output) const;
+
+    inline int GetWidth() const { return m_width; }
+    inline int GetHeight() const { return m_height; }
+    inline int GetSamplesAmount() const { return m_samplesAmount; }
+    inline size_t GetTrianglesAmount() const { return m_trianglesAmount; }
+
+    inline float GetDepth(const int& x, const int& y, const int& sample) const { return m_depth[GetSampleIndex(x, y, sample)]; }
+    inline uint32_t GetColor(const int& x, const int& y, const int& sample) const { return m_color[GetSampleIndex(x, y, sample)]; }
+    void GetVelocity(const int& x, const int& y, const int& sample, float velocity[2]) const;
+
+private:
+    //Clip space positions and everything Base.fx interpolates
+    struct ShadedVertex
+    {
+        float Position[4];
+        float PrevPosition[4];
+        float TexCoord[2];
+        float Diffuse[3];
+        float Specular[3];
+    };
+
+    struct SetupTriangle
+    {
+        //Snapped pixel positions, always clockwise
+        float X[3];
+        float Y[3];
+        float Z[3];
+        float InvW[3];
+        //Divided by w for perspective correct interpolation
+        float Attributes[3][SOFTWARE_ATTRIBUTES];
+        float InvArea;
+        const SoftwareTexture* Texture;
+        int MinX;
+        int MinY;
+        int MaxX;
+        int MaxY;
+    };
+
+    //Edge functions E = A * x + B * y + C relative to the tile origin, positive inside
+    struct TileTriangle
+    {
+        float A[3];
+        float B[3];
+        float C[3];
+        //Depth weights of the edge functions, z = sum(E * ZWeights)
+        float ZWeights[3];
+        bool TopLeft[3];
+        float OriginX;
+        float OriginY;
+    };
+
+    static int TestSamples(const TileTriangle& triangle, const float& x, const float& y, float* const& depth, const int& lanes);
+
+    //Samples are stored in planes, so 4 neighbouring pixels of a sample are tested at once
+    inline size_t GetSampleIndex(const int& x, const int& y, const int& sample) const { return ((size_t)sample * m_height + y) * m_stride + x; }
+
+    void ShadeVertices(const SoftwareDrawCommand* const& commands, const size_t& amount, const SoftwareFrameConstants& frame);
+    void SetupTriangles(const SoftwareDrawCommand* const& commands, const size_t& amount);
+    void ClipTriangle(const ShadedVertex* const& vertices, const SoftwareTexture* const& texture, std::vector<SetupTriangle>& triangles, const int& job);
+    void AddTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, const SoftwareTexture* const& texture, std::vector<SetupTriangle>& triangles, const int& job);
+    void RasterizeTile(const int& tile);
+    void RasterizeTriangle(const SetupTriangle& triangle, const int& tileX, const int& tileY);
+    void Shade(const SetupTriangle& triangle, const TileTriangle& tileTriangle, const float& x, const float& y, uint32_t& color, float velocity[2]) const;
+
+    JobSystem* m_jobSystem;
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_stride = 0;
+    int m_tilesX = 0;
+    int m_tilesY = 0;
+
+    float m_sampleOffsets[SOFTWARE_MAX_SAMPLES][2];
+    float m_samplesMin[2];
+    float m_samplesMax[2];
+    int m_samplesAmount = 0;
+    SoftwareShading m_shading = SoftwareShading::PerSample;
+
+    std::vector<float> m_depth;
+    std::vector<uint32_t> m_color;
+    std::vector<float> m_velocity;
+
+    SoftwareFrameConstants m_frame;
+
+    //Per command offsets into shaded vertices and triangles
+    std::vector<size_t> m_verticesOffsets;
+    std::vector<size_t> m_trianglesOffsets;
+    std::vector<ShadedVertex> m_shadedVertices;
+
+    //Every setup job owns its triangles and bins, tiles walk jobs in order to keep the submission order
+    std::vector<std::vector<SetupTriangle>> m_setupTriangles;
+    std::vector<std::vector<std::vector<uint32_t>>> m_bins;
+    size_t m_trianglesAmount = 0;
+};
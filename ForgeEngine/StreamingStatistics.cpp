@@ -0,0 +1,130 @@
+#include "StreamingStatistics.h"
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+StreamingStatistics::StreamingStatistics() :
+    m_lowestExponent(0)
+{
+    Reset();
+}
+
+void StreamingStatistics::Add(const double& value)
+{
+    const int index = GetBucketIndex(value);
+    const int exponent = index / STATISTICS_SUB_BUCKETS;
+    const int highestExponent = m_lowestExponent + (int)(m_buckets.size() / STATISTICS_SUB_BUCKETS) - 1;
+
+    if (m_buckets.empty())
+    {
+        m_buckets.assign(STATISTICS_SUB_BUCKETS, 0);
+        m_lowestExponent = exponent;
+    }
+    else if (exponent < m_lowestExponent)
+    {
+        m_buckets.insert(m_buckets.begin(), (size_t)(m_lowestExponent - exponent) * STATISTICS_SUB_BUCKETS, 0);
+        m_lowestExponent = exponent;
+    }
+    else if (exponent > highestExponent)
+        m_buckets.resize((size_t)(exponent - m_lowestExponent + 1) * STATISTICS_SUB_BUCKETS, 0);
+
+    ++m_buckets[index - m_lowestExponent * STATISTICS_SUB_BUCKETS];
+    ++m_exponentsCounts[exponent];
+
+    //Welford's online algorithm
+    ++m_count;
+    const double delta = value - m_mean;
+    m_mean += delta / (double)m_count;
+    m_m2 += delta * (value - m_mean);
+
+    if (value < m_min)
+        m_min = value;
+
+    if (value > m_max)
+        m_max = value;
+}
+
+void StreamingStatistics::Reset()
+{
+    //Keeps the allocated range, the same values usually come back after a reset
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    memset(m_exponentsCounts, 0, sizeof(m_exponentsCounts));
+
+    m_count = 0;
+    m_mean = 0.0;
+    m_m2 = 0.0;
+    m_min = HUGE_VAL;
+    m_max = -HUGE_VAL;
+}
+
+double StreamingStatistics::GetVariance() const
+{
+    return m_count > 1 ? m_m2 / (double)(m_count - 1) : 0.0;
+}
+
+double StreamingStatistics::GetStandardDeviation() const
+{
+    return sqrt(GetVariance());
+}
+
+double StreamingStatistics::GetPercentile(const double& percentile) const
+{
+    if (m_count == 0)
+        return 0.0;
+
+    const double clamped = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+    uint64_t rank = (uint64_t)ceil(clamped / 100.0 * (double)m_count);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t accumulated = 0;
+
+    const int exponentsAmount = (int)(m_buckets.size() / STATISTICS_SUB_BUCKETS);
+
+    for (int exponent = m_lowestExponent; exponent < m_lowestExponent + exponentsAmount; ++exponent)
+    {
+        if (accumulated + m_exponentsCounts[exponent] < rank)
+        {
+            accumulated += m_exponentsCounts[exponent];
+            continue;
+        }
+
+        for (int i = exponent * STATISTICS_SUB_BUCKETS; i < (exponent + 1) * STATISTICS_SUB_BUCKETS; ++i)
+        {
+            accumulated += m_buckets[i - m_lowestExponent * STATISTICS_SUB_BUCKETS];
+
+            if (accumulated >= rank)
+            {
+                const double value = GetBucketValue(i);
+                return value < m_min ? m_min : (value > m_max ? m_max : value);
+            }
+        }
+    }
+
+    return m_max;
+}
+
+int StreamingStatistics::GetBucketIndex(const double& value)
+{
+    if (!(value >= 1.0))
+        return 0;
+
+    int exponent;
+    const double mantissa = frexp(value, &exponent); //value = mantissa * 2^exponent, mantissa in <0.5, 1)
+    --exponent;
+
+    if (exponent >= STATISTICS_EXPONENTS)
+        return STATISTICS_EXPONENTS * STATISTICS_SUB_BUCKETS - 1;
+
+    const int subBucket = (int)((mantissa * 2.0 - 1.0) * STATISTICS_SUB_BUCKETS);
+
+    return exponent * STATISTICS_SUB_BUCKETS + subBucket;
+}
+
+double StreamingStatistics::GetBucketValue(const int& index)
+{
+    const int exponent = index / STATISTICS_SUB_BUCKETS;
+    const int subBucket = index % STATISTICS_SUB_BUCKETS;
+
+    return ldexp(1.0 + (subBucket + 0.5) / STATISTICS_SUB_BUCKETS, exponent);
+}
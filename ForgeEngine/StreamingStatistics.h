@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+//Log-linear histogram: every power of two range is split into linear sub buckets,
+//which keeps relative error of percentiles below 1 / STATISTICS_SUB_BUCKETS.
+//Sub buckets are allocated only for the range of exponents that has been hit
+#define STATISTICS_SUB_BUCKETS 64
+#define STATISTICS_EXPONENTS 48
+
+class StreamingStatistics
+{
+public:
+    StreamingStatistics();
+
+    void Add(const double& value);
+    void Reset();
+
+    inline uint64_t GetCount() const { return m_count; }
+    inline double GetMin() const { return m_count > 0 ? m_min : 0.0; }
+    inline double GetMax() const { return m_count > 0 ? m_max : 0.0; }
+    inline double GetMean() const { return m_mean; }
+    double GetVariance() const;
+    double GetStandardDeviation() const;
+
+    //percentile in <0, 100>
+    double GetPercentile(const double& percentile) const;
+
+private:
+    static int GetBucketIndex(const double& value);
+    static double GetBucketValue(const int& index);
+
+    std::vector<uint32_t> m_buckets; //Starts at m_lowestExponent
+    int m_lowestExponent;
+    uint32_t m_exponentsCounts[STATISTICS_EXPONENTS];
+
+    uint64_t m_count;
+    double m_mean;
+    double m_m2;
+    double m_min;
+    double m_max;
+};
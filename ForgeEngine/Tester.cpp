@@ -3,17 +3,25 @@
 #include "IAAPerformer.h"
 #include "Profiler.h"
 #include "Camera.h"
+#include "RenderingSystem.h"
 #include <DirectXCommonClasses/Time.h>
 #include <numeric>
 
 void Tester::UpdateScene()
 {
     const int framesBeforeToCapture = 110;
+    const int framesToTrace = 10;
+    //Traced after the logs are saved, so writing the trace doesn't add to the measured frames
+    const int framesBeforeToSwitch = framesBeforeToCapture + 3 + framesToTrace;
     const float maxDuration = std::numeric_limits<float>::infinity();
     const float minDuration = 1.0f;
 
     MyApp::UpdateScene();
 
+    //Frames are counted once every model is drawn
+    if (Core::GetRenderingSystem()->IsLoadingModels())
+        return;
+
     ++m_framesCounter;
 
     m_time += Time::GetDeltaTime();
@@ -26,7 +34,11 @@ void Tester::UpdateScene()
 
     Core::GetCamera()->SetSavedPosition(m_currentCameraPos);
 
-    if (m_framesCounter == framesBeforeToCapture)
+    if (m_framesCounter == 1)
+    {
+        Profiler::RequestTimeSeriesRecording("S" + std::to_string(m_currentCameraPos) + "\\" + GetCurrentPerformer()->GetName());
+    }
+    else if (m_framesCounter == framesBeforeToCapture)
     {
         if (m_time < minDuration)
         {
@@ -35,12 +47,17 @@ void Tester::UpdateScene()
         }
 
         Profiler::RequestLogsToFile("S" + std::to_string(m_currentCameraPos) + "\\" + GetCurrentPerformer()->GetName());
+        Profiler::StopTimeSeriesRecording();
     }
     else if (m_framesCounter == framesBeforeToCapture + 1)
     {
         RequestScreenshot("S" + std::to_string(m_currentCameraPos) + "\\" + GetCurrentPerformer()->GetName());
     }
     else if (m_framesCounter == framesBeforeToCapture + 2)
+    {
+        Profiler::RequestTraceCapture("S" + std::to_string(m_currentCameraPos) + "\\" + GetCurrentPerformer()->GetName(), framesToTrace);
+    }
+    else if (m_framesCounter == framesBeforeToSwitch)
     {
         if (++m_currentVariant >= GetCurrentPerformer()->GetVariantsAmount())
         {
@@ -62,7 +79,7 @@ void Tester::UpdateScene()
 
         GetCurrentPerformer()->SetVariant(m_currentVariant);
     }
-    else if (m_framesCounter > framesBeforeToCapture + 5)
+    else if (m_framesCounter > framesBeforeToSwitch + 3)
     {
         m_time = 0.0f;
         m_framesCounter = 0;
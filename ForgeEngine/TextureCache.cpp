@@ -0,0 +1,257 @@
+#include "TextureCache.h"
+#include <cctype>
+#include "ModelCache.h"
+
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+namespace
+{
+    inline uint64_t Hash(const void* const& data, const size_t& size, uint64_t hash)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+
+        return hash;
+    }
+
+    //Size is hashed as well, so only equally long files can collide
+    uint64_t GetContentKey(const MappedFile& file)
+    {
+        const uint64_t size = file.GetSize();
+        return Hash(file.GetData(), file.GetSize(), Hash(&size, sizeof(size), FNV_OFFSET));
+    }
+}
+
+TextureCache::TextureCache(ITextureDecoder* const& decoder, ITextureDevice* const& device, const size_t& unusedBudget)
+    : m_decoder(decoder), m_device(device), m_unusedBudget(unusedBudget)
+{
+}
+
+TextureCache::~TextureCache()
+{
+    for (auto const& entry : m_handles)
+    {
+        m_device->ReleaseTexture(entry.first);
+        delete entry.second;
+    }
+}
+
+TextureHandle TextureCache::Acquire(const std::string& path)
+{
+    const std::string normalizedPath = NormalizePath(path);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto known = m_paths.find(normalizedPath);
+        if (known != m_paths.end())
+        {
+            ++m_statistics.PathHits;
+            return Reference(known->second);
+        }
+    }
+
+    //Reading, hashing and decoding don't hold the mutex, so a thread loading textures doesn't stall the others
+    MappedFile file;
+    if (!file.Open(path))
+        return nullptr;
+
+    const uint64_t contentKey = GetContentKey(file);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto same = m_contents.find(contentKey);
+        if (same != m_contents.end())
+        {
+            ++m_statistics.ContentHits;
+            AddPath(same->second, normalizedPath);
+            return Reference(same->second);
+        }
+    }
+
+    DecodedTexture decoded;
+    if (!m_decoder->Decode(file.GetData(), file.GetSize(), decoded))
+        return nullptr;
+
+    TextureHandle handle = m_device->CreateTexture(decoded);
+    if (handle == nullptr)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    //Another thread could have created the same texture in the meantime
+    auto same = m_contents.find(contentKey);
+    if (same != m_contents.end())
+    {
+        m_device->ReleaseTexture(handle);
+        ++m_statistics.ContentHits;
+        AddPath(same->second, normalizedPath);
+        return Reference(same->second);
+    }
+
+    Texture* texture = new Texture();
+    texture->Handle = handle;
+    texture->ContentKey = contentKey;
+    texture->Bytes = decoded.Pixels.size();
+
+    m_contents.insert({ contentKey, texture });
+    m_handles.insert({ handle, texture });
+    ++m_statistics.Decodes;
+    ++m_statistics.TexturesAmount;
+    m_statistics.ResidentBytes += texture->Bytes;
+
+    AddPath(texture, normalizedPath);
+    return Reference(texture);
+}
+
+void TextureCache::AddReference(const TextureHandle& texture)
+{
+    if (texture == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_handles.find(texture);
+    if (entry != m_handles.end())
+        Reference(entry->second);
+}
+
+void TextureCache::Release(const TextureHandle& texture)
+{
+    if (texture == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_handles.find(texture);
+    if (entry == m_handles.end() || entry->second->References == 0)
+        return;
+
+    Texture* released = entry->second;
+    if (--released->References > 0)
+        return;
+
+    released->Unused = m_unused.insert(m_unused.end(), released);
+    released->IsUnused = true;
+    m_statistics.UnusedBytes += released->Bytes;
+
+    EvictOverBudget();
+}
+
+size_t TextureCache::EvictUnused()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const size_t amount = m_unused.size();
+    while (!m_unused.empty())
+    {
+        //Not a reference into the list, Evict erases it
+        Texture* texture = m_unused.front();
+        Evict(texture);
+    }
+
+    return amount;
+}
+
+TextureCacheStatistics TextureCache::GetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+std::string TextureCache::NormalizePath(const std::string& path)
+{
+    const bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+
+    std::vector<std::string> segments;
+    std::string segment;
+
+    //The end of the path closes the last segment
+    for (size_t i = 0; i <= path.size(); ++i)
+    {
+        const char c = i < path.size() ? path[i] : '/';
+
+        if (c != '/' && c != '\\')
+        {
+#ifdef _WIN32
+            segment += (char)tolower((unsigned char)c);
+#else
+            segment += c;
+#endif
+            continue;
+        }
+
+        //Leading ".." of relative paths can't be resolved
+        if (segment == "..")
+        {
+            if (!segments.empty() && segments.back() != "..")
+                segments.pop_back();
+            else if (!absolute)
+                segments.push_back(segment);
+        }
+        else if (!segment.empty() && segment != ".")
+            segments.push_back(segment);
+
+        segment.clear();
+    }
+
+    std::string normalized = absolute ? "/" : "";
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        if (i > 0)
+            normalized += '/';
+
+        normalized += segments[i];
+    }
+
+    return normalized;
+}
+
+void TextureCache::AddPath(Texture* const& texture, const std::string& path)
+{
+    if (m_paths.insert({ path, texture }).second)
+        texture->Paths.push_back(path);
+}
+
+TextureHandle TextureCache::Reference(Texture* const& texture)
+{
+    if (texture->References++ == 0 && texture->IsUnused)
+    {
+        m_unused.erase(texture->Unused);
+        texture->IsUnused = false;
+        m_statistics.UnusedBytes -= texture->Bytes;
+    }
+
+    return texture->Handle;
+}
+
+void TextureCache::EvictOverBudget()
+{
+    while (m_statistics.UnusedBytes > m_unusedBudget && !m_unused.empty())
+    {
+        Texture* texture = m_unused.front();
+        Evict(texture);
+    }
+}
+
+void TextureCache::Evict(Texture* const& texture)
+{
+    for (const std::string& path : texture->Paths)
+        m_paths.erase(path);
+
+    m_contents.erase(texture->ContentKey);
+    m_handles.erase(texture->Handle);
+    m_unused.erase(texture->Unused);
+
+    ++m_statistics.Evictions;
+    --m_statistics.TexturesAmount;
+    m_statistics.ResidentBytes -= texture->Bytes;
+    m_statistics.UnusedBytes -= texture->Bytes;
+
+    m_device->ReleaseTexture(texture->Handle);
+    delete texture;
+}
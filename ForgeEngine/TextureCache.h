@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ITextureBackend.h"
+
+//Unused textures are kept for reuse until they take more than this
+#define TEXTURE_CACHE_UNUSED_BUDGET (64 * 1024 * 1024)
+
+struct TextureCacheStatistics
+{
+    //Acquires of a path already loaded
+    uint64_t PathHits = 0;
+    //Acquires of a new path with the contents of a loaded one
+    uint64_t ContentHits = 0;
+    uint64_t Decodes = 0;
+    uint64_t Evictions = 0;
+    size_t TexturesAmount = 0;
+    //Decoded size of every created texture, used or not
+    size_t ResidentBytes = 0;
+    size_t UnusedBytes = 0;
+};
+
+//Textures shared by normalized path and by contents, so files with the same bytes under different paths are decoded and created once.
+//Every Acquire and AddReference needs a Release, textures without references are evicted the least recently used first once over the budget.
+//Files are read once per path, changes on disk are picked up after eviction. Thread safe, decoding runs on the acquiring thread without blocking others;
+//threads acquiring the same new texture at once may both decode it, the later one is dropped
+class TextureCache
+{
+public:
+    TextureCache(ITextureDecoder* const& decoder, ITextureDevice* const& device, const size_t& unusedBudget = TEXTURE_CACHE_UNUSED_BUDGET);
+    //Releases every texture, references still held become invalid
+    ~TextureCache();
+
+    //Returns nullptr when the file can't be read or decoded
+    TextureHandle Acquire(const std::string& path);
+    //For another holder of an acquired texture, nullptr is ignored
+    void AddReference(const TextureHandle& texture);
+    void Release(const TextureHandle& texture);
+
+    //Releases every texture without references regardless of the budget, returns how many
+    size_t EvictUnused();
+
+    TextureCacheStatistics GetStatistics();
+
+    //Separators, "." and ".." segments and repeated separators resolved, lower case on Windows
+    static std::string NormalizePath(const std::string& path);
+
+private:
+    struct Texture
+    {
+        TextureHandle Handle;
+        uint64_t ContentKey;
+        size_t Bytes;
+        uint32_t References = 0;
+        std::vector<std::string> Paths;
+        //In the unused list, new textures are referenced before they get there
+        bool IsUnused = false;
+        std::list<Texture*>::iterator Unused;
+    };
+
+    //All of them expect the mutex to be locked
+    void AddPath(Texture* const& texture, const std::string& path);
+    TextureHandle Reference(Texture* const& texture);
+    void EvictOverBudget();
+    void Evict(Texture* const& texture);
+
+    ITextureDecoder* m_decoder;
+    ITextureDevice* m_device;
+    size_t m_unusedBudget;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Texture*> m_paths;
+    std::unordered_map<uint64_t, Texture*> m_contents;
+    std::unordered_map<TextureHandle, Texture*> m_handles;
+    //Least recently used first
+    std::list<Texture*> m_unused;
+    TextureCacheStatistics m_statistics;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+
+//Profiler time series file layout (little endian):
+//  TimeSeriesFileHeader
+//  TimeSeriesChunkHeader, int32 FrameIndices[FramesAmount], uint32 ScopeIndices[ColumnsAmount], float Values[ColumnsAmount][FramesAmount]
+//  ...
+//  ScopesAmount x (TimeSeriesScopeEntry, char Path[PathLength])
+//Values are per frame sums in milliseconds, NaN when the scope didn't run in that frame
+
+#define TIME_SERIES_MAGIC 0x52535446 //"FTSR"
+#define TIME_SERIES_CHUNK_MAGIC 0x4B4E4843 //"CHNK"
+#define TIME_SERIES_VERSION 1
+
+enum class TimeSeriesTrack : uint32_t
+{
+    CPU,
+    GPU
+};
+
+#pragma pack(push, 1)
+struct TimeSeriesFileHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t ScopeTableOffset;
+    uint32_t ScopesAmount;
+    uint32_t ChunksAmount;
+};
+
+struct TimeSeriesChunkHeader
+{
+    uint32_t Magic;
+    TimeSeriesTrack Track;
+    uint32_t FramesAmount;
+    uint32_t ColumnsAmount;
+};
+
+struct TimeSeriesScopeEntry
+{
+    uint64_t PathID;
+    TimeSeriesTrack Track;
+    uint32_t PathLength;
+};
+#pragma pack(pop)
@@ -0,0 +1,149 @@
+#include "TimeSeriesRecorder.h"
+#include <cmath>
+
+TimeSeriesRecorder::~TimeSeriesRecorder()
+{
+    Close();
+}
+
+bool TimeSeriesRecorder::Open(const std::string& path)
+{
+    Close();
+
+    m_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!m_file.is_open())
+        return false;
+
+    //Rewritten with the real offsets on close
+    TimeSeriesFileHeader header = {};
+    m_file.write((const char*)&header, sizeof(header));
+
+    return true;
+}
+
+void TimeSeriesRecorder::Close()
+{
+    if (!m_file.is_open())
+        return;
+
+    FlushChunk(TimeSeriesTrack::CPU);
+    FlushChunk(TimeSeriesTrack::GPU);
+
+    TimeSeriesFileHeader header;
+    header.Magic = TIME_SERIES_MAGIC;
+    header.Version = TIME_SERIES_VERSION;
+    header.ScopeTableOffset = (uint64_t)m_file.tellp();
+    header.ScopesAmount = (uint32_t)m_scopes.size();
+    header.ChunksAmount = m_chunksAmount;
+
+    for (const Scope& scope : m_scopes)
+    {
+        TimeSeriesScopeEntry entry;
+        entry.PathID = scope.PathID;
+        entry.Track = scope.Track;
+        entry.PathLength = (uint32_t)scope.Path.size();
+
+        m_file.write((const char*)&entry, sizeof(entry));
+        m_file.write(scope.Path.data(), scope.Path.size());
+    }
+
+    m_file.seekp(0);
+    m_file.write((const char*)&header, sizeof(header));
+    m_file.close();
+
+    m_scopes.clear();
+    m_scopeIndices[0].clear();
+    m_scopeIndices[1].clear();
+    m_chunksAmount = 0;
+}
+
+void TimeSeriesRecorder::BeginFrame(const TimeSeriesTrack& track, const int& frameIndex)
+{
+    if (!m_file.is_open())
+        return;
+
+    Chunk& chunk = m_chunks[(int)track];
+
+    if (chunk.FrameIndices.size() == TIME_SERIES_CHUNK_FRAMES)
+        FlushChunk(track);
+
+    chunk.FrameIndices.push_back(frameIndex);
+
+    for (std::vector<float>& column : chunk.Columns)
+        column.push_back(NAN);
+}
+
+void TimeSeriesRecorder::Record(const TimeSeriesTrack& track, const uint64_t& pathID, const std::string& path, const float& valueMs)
+{
+    if (!m_file.is_open())
+        return;
+
+    Chunk& chunk = m_chunks[(int)track];
+
+    if (chunk.FrameIndices.empty())
+        return;
+
+    const uint32_t scopeIndex = GetScopeIndex(track, pathID, path);
+
+    auto found = chunk.ColumnIndices.find(scopeIndex);
+    uint32_t columnIndex;
+
+    if (found == chunk.ColumnIndices.end())
+    {
+        columnIndex = (uint32_t)chunk.Columns.size();
+        chunk.ColumnIndices.emplace(scopeIndex, columnIndex);
+        chunk.ScopeIndices.push_back(scopeIndex);
+
+        chunk.Columns.emplace_back();
+        chunk.Columns.back().reserve(TIME_SERIES_CHUNK_FRAMES);
+        chunk.Columns.back().resize(chunk.FrameIndices.size(), NAN);
+    }
+    else
+        columnIndex = found->second;
+
+    chunk.Columns[columnIndex].back() = valueMs;
+}
+
+void TimeSeriesRecorder::FlushChunk(const TimeSeriesTrack& track)
+{
+    Chunk& chunk = m_chunks[(int)track];
+
+    if (chunk.FrameIndices.empty())
+        return;
+
+    TimeSeriesChunkHeader header;
+    header.Magic = TIME_SERIES_CHUNK_MAGIC;
+    header.Track = track;
+    header.FramesAmount = (uint32_t)chunk.FrameIndices.size();
+    header.ColumnsAmount = (uint32_t)chunk.Columns.size();
+
+    m_file.write((const char*)&header, sizeof(header));
+    m_file.write((const char*)chunk.FrameIndices.data(), chunk.FrameIndices.size() * sizeof(int32_t));
+    m_file.write((const char*)chunk.ScopeIndices.data(), chunk.ScopeIndices.size() * sizeof(uint32_t));
+
+    for (const std::vector<float>& column : chunk.Columns)
+        m_file.write((const char*)column.data(), column.size() * sizeof(float));
+
+    ++m_chunksAmount;
+
+    chunk.FrameIndices.clear();
+    chunk.ScopeIndices.clear();
+    chunk.Columns.clear();
+    chunk.ColumnIndices.clear();
+}
+
+uint32_t TimeSeriesRecorder::GetScopeIndex(const TimeSeriesTrack& track, const uint64_t& pathID, const std::string& path)
+{
+    std::unordered_map<uint64_t, uint32_t>& indices = m_scopeIndices[(int)track];
+    auto found = indices.find(pathID);
+
+    if (found != indices.end())
+        return found->second;
+
+    const uint32_t index = (uint32_t)m_scopes.size();
+    m_scopes.push_back({ pathID, track, path });
+    indices.emplace(pathID, index);
+
+    return index;
+}
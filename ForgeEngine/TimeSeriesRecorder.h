@@ -0,0 +1,48 @@
+#pragma once
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TimeSeriesFormat.h"
+
+#define TIME_SERIES_CHUNK_FRAMES 256
+
+//Buffers frames of every scope column by column and appends them as chunks
+class TimeSeriesRecorder
+{
+public:
+    ~TimeSeriesRecorder();
+
+    bool Open(const std::string& path);
+    void Close();
+    inline bool IsOpen() const { return m_file.is_open(); }
+
+    //Frames of a track have to come in increasing order, tracks are independent
+    void BeginFrame(const TimeSeriesTrack& track, const int& frameIndex);
+    void Record(const TimeSeriesTrack& track, const uint64_t& pathID, const std::string& path, const float& valueMs);
+
+private:
+    struct Chunk
+    {
+        std::vector<int32_t> FrameIndices;
+        std::vector<uint32_t> ScopeIndices;
+        std::vector<std::vector<float>> Columns;
+        std::unordered_map<uint32_t, uint32_t> ColumnIndices;
+    };
+
+    struct Scope
+    {
+        uint64_t PathID;
+        TimeSeriesTrack Track;
+        std::string Path;
+    };
+
+    void FlushChunk(const TimeSeriesTrack& track);
+    uint32_t GetScopeIndex(const TimeSeriesTrack& track, const uint64_t& pathID, const std::string& path);
+
+    std::ofstream m_file;
+    Chunk m_chunks[2];
+    std::vector<Scope> m_scopes;
+    std::unordered_map<uint64_t, uint32_t> m_scopeIndices[2];
+    uint32_t m_chunksAmount = 0;
+};
@@ -0,0 +1,206 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "ModelCache.h"
+#include "VertexPacking.h"
+
+//Rounded half away from zero by truncating, which compiles to a single conversion instead of a call
+inline int16_t ToSnorm16(const float& value)
+{
+    const float scaled = std::min(std::max(value, -1.0f), 1.0f) * 32767.0f;
+    return (int16_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+inline uint16_t ToUnorm16(const float& value)
+{
+    return (uint16_t)(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f + 0.5f);
+}
+
+inline uint8_t ToUnorm8(const float& value)
+{
+    return (uint8_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+//Converts one attribute from floats, scale and offset are only read by quantized positions
+template<VertexFormat Format>
+struct VertexFormatPacker;
+
+template<>
+struct VertexFormatPacker<VertexFormat::Float2>
+{
+    static const uint32_t Size = 8;
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const&, const float* const&)
+    {
+        memcpy(destination, source, sizeof(float) * 2);
+    }
+};
+
+template<>
+struct VertexFormatPacker<VertexFormat::Float3>
+{
+    static const uint32_t Size = 12;
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const&, const float* const&)
+    {
+        memcpy(destination, source, sizeof(float) * 3);
+    }
+};
+
+template<>
+struct VertexFormatPacker<VertexFormat::Float4>
+{
+    static const uint32_t Size = 16;
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const&, const float* const&)
+    {
+        memcpy(destination, source, sizeof(float) * 4);
+    }
+};
+
+template<>
+struct VertexFormatPacker<VertexFormat::Half2>
+{
+    static const uint32_t Size = 4;
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const&, const float* const&)
+    {
+        const uint16_t halves[2] = { FloatToHalf(source[0]), FloatToHalf(source[1]) };
+        memcpy(destination, halves, sizeof(halves));
+    }
+};
+
+template<>
+struct VertexFormatPacker<VertexFormat::Snorm16x2>
+{
+    static const uint32_t Size = 4;
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const&, const float* const&)
+    {
+        float encoded[2];
+        EncodeOctahedral(source, encoded);
+        const int16_t snorms[2] = { ToSnorm16(encoded[0]), ToSnorm16(encoded[1]) };
+        memcpy(destination, snorms, sizeof(snorms));
+    }
+};
+
+template<>
+struct VertexFormatPacker<VertexFormat::Unorm16x4>
+{
+    static const uint32_t Size = 8;
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const& scale, const float* const& offset)
+    {
+        const uint16_t unorms[4] = { ToUnorm16((source[0] - offset[0]) / scale[0]), ToUnorm16((source[1] - offset[1]) / scale[1]),
+            ToUnorm16((source[2] - offset[2]) / scale[2]), 65535 };
+        memcpy(destination, unorms, sizeof(unorms));
+    }
+};
+
+template<>
+struct VertexFormatPacker<VertexFormat::Unorm8x4>
+{
+    static const uint32_t Size = 4;
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const&, const float* const&)
+    {
+        for (int c = 0; c < 4; ++c)
+            destination[c] = ToUnorm8(source[c]);
+    }
+};
+
+//Floats every semantic is imported with
+template<VertexSemantic Semantic>
+struct VertexSemanticComponents;
+
+template<> struct VertexSemanticComponents<VertexSemantic::Position> { static const uint32_t Amount = 3; };
+template<> struct VertexSemanticComponents<VertexSemantic::Normal> { static const uint32_t Amount = 3; };
+template<> struct VertexSemanticComponents<VertexSemantic::TexCoord> { static const uint32_t Amount = 2; };
+template<> struct VertexSemanticComponents<VertexSemantic::Color> { static const uint32_t Amount = 4; };
+
+template<VertexSemantic AttributeSemantic, VertexFormat AttributeFormat>
+struct VertexAttribute
+{
+    static const VertexSemantic Semantic = AttributeSemantic;
+    static const VertexFormat Format = AttributeFormat;
+    static const uint32_t Components = VertexSemanticComponents<AttributeSemantic>::Amount;
+    static const uint32_t Size = VertexFormatPacker<AttributeFormat>::Size;
+};
+
+//Walks the attributes with their float and packed offsets known at compile time, the empty list ends the walk
+template<uint32_t SourceOffset, uint32_t DestinationOffset, typename... Attributes>
+struct VertexAttributesPacker
+{
+    static const uint32_t SourceStride = SourceOffset;
+    static const uint32_t DestinationStride = DestinationOffset;
+
+    static inline void Pack(const float* const&, uint8_t* const&, const float* const&, const float* const&) {}
+    static inline void AddElements(std::vector<CachedVertexElement>&) {}
+    static inline bool Matches(const CachedVertexElement* const&) { return true; }
+};
+
+template<uint32_t SourceOffset, uint32_t DestinationOffset, typename Attribute, typename... Rest>
+struct VertexAttributesPacker<SourceOffset, DestinationOffset, Attribute, Rest...>
+{
+    typedef VertexAttributesPacker<SourceOffset + Attribute::Components, DestinationOffset + Attribute::Size, Rest...> Next;
+
+    static const uint32_t SourceStride = Next::SourceStride;
+    static const uint32_t DestinationStride = Next::DestinationStride;
+
+    static inline void Pack(const float* const& source, uint8_t* const& destination, const float* const& scale, const float* const& offset)
+    {
+        VertexFormatPacker<Attribute::Format>::Pack(source + SourceOffset, destination + DestinationOffset, scale, offset);
+        Next::Pack(source, destination, scale, offset);
+    }
+
+    static inline void AddElements(std::vector<CachedVertexElement>& elements)
+    {
+        elements.push_back({ Attribute::Semantic, 0, DestinationOffset, Attribute::Format });
+        Next::AddElements(elements);
+    }
+
+    //Against the float layout ImportMesh builds
+    static inline bool Matches(const CachedVertexElement* const& elements)
+    {
+        return elements[0].Semantic == Attribute::Semantic && elements[0].SemanticIndex == 0 && elements[0].Offset == SourceOffset * sizeof(float)
+            && Next::Matches(elements + 1);
+    }
+};
+
+//Vertex format as a list of attributes, its packed layout and a converter without per vertex branches are generated from it
+template<typename... Attributes>
+struct VertexLayout
+{
+    typedef VertexAttributesPacker<0, 0, Attributes...> Packer;
+
+    static const uint32_t FloatsStride = Packer::SourceStride;
+    static const uint32_t Stride = Packer::DestinationStride;
+
+    static bool Matches(const std::vector<CachedVertexElement>& layout, const size_t& floatsStride)
+    {
+        return layout.size() == sizeof...(Attributes) && floatsStride == FloatsStride && Packer::Matches(layout.data());
+    }
+
+    static void GetElements(std::vector<CachedVertexElement>& elements)
+    {
+        elements.clear();
+        Packer::AddElements(elements);
+    }
+
+    static void Pack(const float* const& vertices, const size_t& verticesAmount, uint8_t* const& packed, const float* const& positionScale, const float* const& positionOffset)
+    {
+        for (size_t v = 0; v < verticesAmount; ++v)
+            Packer::Pack(vertices + v * FloatsStride, packed + v * Stride, positionScale, positionOffset);
+    }
+};
+
+//Position, normal, first texture coordinates and first colors - the layouts most imported meshes have
+template<VertexFormat PositionFormat, VertexFormat NormalFormat, VertexFormat TexCoordFormat, VertexFormat ColorFormat>
+struct CommonVertexLayouts
+{
+    typedef VertexAttribute<VertexSemantic::Position, PositionFormat> Position;
+    typedef VertexAttribute<VertexSemantic::Normal, NormalFormat> Normal;
+    typedef VertexAttribute<VertexSemantic::TexCoord, TexCoordFormat> TexCoord;
+    typedef VertexAttribute<VertexSemantic::Color, ColorFormat> Color;
+
+    typedef VertexLayout<Position> P;
+    typedef VertexLayout<Position, Normal> PN;
+    typedef VertexLayout<Position, Normal, TexCoord> PNT;
+    typedef VertexLayout<Position, Normal, TexCoord, Color> PNTC;
+};
@@ -0,0 +1,371 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include "VertexLayouts.h"
+
+namespace
+{
+    inline float SignNotZero(const float& value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    typedef CommonVertexLayouts<VertexFormat::Float3, VertexFormat::Float3, VertexFormat::Float2, VertexFormat::Float4> FloatLayouts;
+    typedef CommonVertexLayouts<VertexFormat::Float3, VertexFormat::Snorm16x2, VertexFormat::Half2, VertexFormat::Unorm8x4> PackedLayouts;
+    typedef CommonVertexLayouts<VertexFormat::Unorm16x4, VertexFormat::Snorm16x2, VertexFormat::Half2, VertexFormat::Unorm8x4> QuantizedLayouts;
+
+    struct CompiledVertexLayout
+    {
+        uint32_t PackingFlags;
+        uint32_t Stride;
+        bool(*Matches)(const std::vector<CachedVertexElement>&, const size_t&);
+        void(*GetElements)(std::vector<CachedVertexElement>&);
+        void(*Pack)(const float* const&, const size_t&, uint8_t* const&, const float* const&, const float* const&);
+    };
+
+    template<typename Layout>
+    CompiledVertexLayout CompileVertexLayout(const uint32_t& packingFlags)
+    {
+        return { packingFlags, Layout::Stride, &Layout::Matches, &Layout::GetElements, &Layout::Pack };
+    }
+
+    VertexPacking GetPacking(const bool& quantizePositions, const bool& packAttributes)
+    {
+        VertexPacking packing;
+        packing.QuantizePositions = quantizePositions;
+        packing.OctahedralNormals = packAttributes;
+        packing.HalfTexCoords = packAttributes;
+        packing.Unorm8Colors = packAttributes;
+
+        return packing;
+    }
+
+    //Common layouts with float, default and fully packed formats, other combinations are packed element by element
+    const CompiledVertexLayout* FindCompiledVertexLayout(const std::vector<CachedVertexElement>& layout, const size_t& stride, const VertexPacking& packing)
+    {
+        static const uint32_t floatFlags = GetPacking(false, false).GetFlags();
+        static const uint32_t packedFlags = GetPacking(false, true).GetFlags();
+        static const uint32_t quantizedFlags = GetPacking(true, true).GetFlags();
+
+        static const CompiledVertexLayout layouts[] =
+        {
+            CompileVertexLayout<FloatLayouts::P>(floatFlags),
+            CompileVertexLayout<FloatLayouts::PN>(floatFlags),
+            CompileVertexLayout<FloatLayouts::PNT>(floatFlags),
+            CompileVertexLayout<FloatLayouts::PNTC>(floatFlags),
+            CompileVertexLayout<PackedLayouts::P>(packedFlags),
+            CompileVertexLayout<PackedLayouts::PN>(packedFlags),
+            CompileVertexLayout<PackedLayouts::PNT>(packedFlags),
+            CompileVertexLayout<PackedLayouts::PNTC>(packedFlags),
+            CompileVertexLayout<QuantizedLayouts::P>(quantizedFlags),
+            CompileVertexLayout<QuantizedLayouts::PN>(quantizedFlags),
+            CompileVertexLayout<QuantizedLayouts::PNT>(quantizedFlags),
+            CompileVertexLayout<QuantizedLayouts::PNTC>(quantizedFlags)
+        };
+
+        const uint32_t flags = packing.GetFlags();
+
+        for (const CompiledVertexLayout& compiled : layouts)
+        {
+            if (compiled.PackingFlags == flags && compiled.Matches(layout, stride))
+                return &compiled;
+        }
+
+        return nullptr;
+    }
+
+    VertexFormat GetPackedFormat(const VertexSemantic& semantic, const VertexPacking& packing)
+    {
+        switch (semantic)
+        {
+        case VertexSemantic::Position:
+            return packing.QuantizePositions ? VertexFormat::Unorm16x4 : VertexFormat::Float3;
+        case VertexSemantic::Normal:
+            return packing.OctahedralNormals ? VertexFormat::Snorm16x2 : VertexFormat::Float3;
+        case VertexSemantic::TexCoord:
+            return packing.HalfTexCoords ? VertexFormat::Half2 : VertexFormat::Float2;
+        case VertexSemantic::Color:
+            return packing.Unorm8Colors ? VertexFormat::Unorm8x4 : VertexFormat::Float4;
+        }
+
+        return VertexFormat::Float4;
+    }
+
+    //Quantized to the range of the positions themselves, identity otherwise
+    void CalculatePositionQuantization(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const std::vector<CachedVertexElement>& layout,
+        const VertexPacking& packing, float* const& positionScale, float* const& positionOffset)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            positionScale[axis] = 1.0f;
+            positionOffset[axis] = 0.0f;
+        }
+
+        for (const CachedVertexElement& element : layout)
+        {
+            if (element.Semantic != VertexSemantic::Position || !packing.QuantizePositions || verticesAmount == 0)
+                continue;
+
+            float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+            for (size_t v = 0; v < verticesAmount; ++v)
+            {
+                const float* position = vertices + v * stride + element.Offset / sizeof(float);
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    min[axis] = std::min(min[axis], position[axis]);
+                    max[axis] = std::max(max[axis], position[axis]);
+                }
+            }
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                positionOffset[axis] = min[axis];
+                positionScale[axis] = max[axis] > min[axis] ? max[axis] - min[axis] : 1.0f;
+            }
+        }
+    }
+}
+
+uint32_t VertexPacking::GetFlags() const
+{
+    return (QuantizePositions ? 1u : 0u) | (OctahedralNormals ? 2u : 0u) | (HalfTexCoords ? 4u : 0u) | (Unorm8Colors ? 8u : 0u);
+}
+
+uint16_t FloatToHalf(const float& value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    const int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    //NaN stays NaN, infinity and overflow become infinity
+    if (((bits >> 23) & 0xFF) == 0xFF)
+        return sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0);
+
+    if (exponent >= 31)
+        return sign | 0x7C00;
+
+    //Denormals, or zero below the smallest one
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return sign;
+
+        mantissa |= 0x800000;
+        const int shift = 14 - exponent;
+        const uint32_t rounded = (mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift;
+        return sign | (uint16_t)rounded;
+    }
+
+    //Round to nearest even, a carry out of the mantissa correctly bumps the exponent
+    const uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    const uint32_t rounded = half + ((mantissa & 0x1FFF) > 0x1000 || ((mantissa & 0x1FFF) == 0x1000 && (half & 1)) ? 1 : 0);
+    return sign | (uint16_t)rounded;
+}
+
+float HalfToFloat(const uint16_t& value)
+{
+    const uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        const float result = mantissa * (1.0f / 16777216.0f);
+        return sign ? -result : result;
+    }
+
+    if (exponent == 31)
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void EncodeOctahedral(const float* const& normal, float* const& encoded)
+{
+    const float length = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+    const float x = length > 0.0f ? normal[0] / length : 0.0f;
+    const float y = length > 0.0f ? normal[1] / length : 0.0f;
+
+    //The lower hemisphere is folded over the diagonals
+    if (normal[2] < 0.0f)
+    {
+        encoded[0] = (1.0f - fabsf(y)) * SignNotZero(x);
+        encoded[1] = (1.0f - fabsf(x)) * SignNotZero(y);
+    }
+    else
+    {
+        encoded[0] = x;
+        encoded[1] = y;
+    }
+}
+
+void DecodeOctahedral(const float* const& encoded, float* const& normal)
+{
+    float x = encoded[0];
+    float y = encoded[1];
+    const float z = 1.0f - fabsf(x) - fabsf(y);
+    const float fold = std::max(-z, 0.0f);
+
+    x += x >= 0.0f ? -fold : fold;
+    y += y >= 0.0f ? -fold : fold;
+
+    const float length = sqrtf(x * x + y * y + z * z);
+    normal[0] = x / length;
+    normal[1] = y / length;
+    normal[2] = z / length;
+}
+
+uint32_t PackVertices(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const std::vector<CachedVertexElement>& layout,
+    const VertexPacking& packing, std::vector<uint8_t>& packed, std::vector<CachedVertexElement>& packedLayout, float* const& positionScale, float* const& positionOffset)
+{
+    const CompiledVertexLayout* compiled = FindCompiledVertexLayout(layout, stride, packing);
+    if (compiled == nullptr)
+        return PackVerticesGeneric(vertices, verticesAmount, stride, layout, packing, packed, packedLayout, positionScale, positionOffset);
+
+    CalculatePositionQuantization(vertices, verticesAmount, stride, layout, packing, positionScale, positionOffset);
+    compiled->GetElements(packedLayout);
+
+    packed.resize(verticesAmount * compiled->Stride);
+    compiled->Pack(vertices, verticesAmount, packed.data(), positionScale, positionOffset);
+
+    return compiled->Stride;
+}
+
+uint32_t PackVerticesGeneric(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const std::vector<CachedVertexElement>& layout,
+    const VertexPacking& packing, std::vector<uint8_t>& packed, std::vector<CachedVertexElement>& packedLayout, float* const& positionScale, float* const& positionOffset)
+{
+    CalculatePositionQuantization(vertices, verticesAmount, stride, layout, packing, positionScale, positionOffset);
+
+    packedLayout.clear();
+    uint32_t packedStride = 0;
+
+    for (const CachedVertexElement& element : layout)
+    {
+        CachedVertexElement packedElement = element;
+        packedElement.Offset = packedStride;
+        packedElement.Format = GetPackedFormat(element.Semantic, packing);
+
+        packedLayout.push_back(packedElement);
+        packedStride += GetVertexFormatSize(packedElement.Format);
+    }
+
+    packed.assign(verticesAmount * packedStride, 0);
+
+    for (size_t e = 0; e < layout.size(); ++e)
+    {
+        const CachedVertexElement& packedElement = packedLayout[e];
+
+        for (size_t v = 0; v < verticesAmount; ++v)
+        {
+            const float* source = vertices + v * stride + layout[e].Offset / sizeof(float);
+            uint8_t* destination = packed.data() + v * packedStride + packedElement.Offset;
+
+            switch (packedElement.Format)
+            {
+            case VertexFormat::Float2:
+                VertexFormatPacker<VertexFormat::Float2>::Pack(source, destination, positionScale, positionOffset);
+                break;
+            case VertexFormat::Float3:
+                VertexFormatPacker<VertexFormat::Float3>::Pack(source, destination, positionScale, positionOffset);
+                break;
+            case VertexFormat::Float4:
+                VertexFormatPacker<VertexFormat::Float4>::Pack(source, destination, positionScale, positionOffset);
+                break;
+            case VertexFormat::Half2:
+                VertexFormatPacker<VertexFormat::Half2>::Pack(source, destination, positionScale, positionOffset);
+                break;
+            case VertexFormat::Snorm16x2:
+                VertexFormatPacker<VertexFormat::Snorm16x2>::Pack(source, destination, positionScale, positionOffset);
+                break;
+            case VertexFormat::Unorm16x4:
+                VertexFormatPacker<VertexFormat::Unorm16x4>::Pack(source, destination, positionScale, positionOffset);
+                break;
+            case VertexFormat::Unorm8x4:
+                VertexFormatPacker<VertexFormat::Unorm8x4>::Pack(source, destination, positionScale, positionOffset);
+                break;
+            }
+        }
+    }
+
+    return packedStride;
+}
+
+bool HasCompiledVertexLayout(const std::vector<CachedVertexElement>& layout, const size_t& stride, const VertexPacking& packing)
+{
+    return FindCompiledVertexLayout(layout, stride, packing) != nullptr;
+}
+
+void UnpackPositions(const uint8_t* const& vertices, const size_t& verticesAmount, const uint32_t& stride, const CachedVertexElement& element,
+    const float* const& positionScale, const float* const& positionOffset, float* const& positions)
+{
+    for (size_t v = 0; v < verticesAmount; ++v)
+    {
+        const uint8_t* source = vertices + v * stride + element.Offset;
+        float* destination = positions + v * 3;
+
+        if (element.Format == VertexFormat::Unorm16x4)
+        {
+            uint16_t unorms[3];
+            memcpy(unorms, source, sizeof(unorms));
+
+            for (int axis = 0; axis < 3; ++axis)
+                destination[axis] = unorms[axis] / 65535.0f * positionScale[axis] + positionOffset[axis];
+        }
+        else
+            memcpy(destination, source, sizeof(float) * 3);
+    }
+}
+
+void UnpackNormals(const uint8_t* const& vertices, const size_t& verticesAmount, const uint32_t& stride, const CachedVertexElement& element, float* const& normals)
+{
+    for (size_t v = 0; v < verticesAmount; ++v)
+    {
+        const uint8_t* source = vertices + v * stride + element.Offset;
+        float* destination = normals + v * 3;
+
+        if (element.Format == VertexFormat::Snorm16x2)
+        {
+            int16_t snorms[2];
+            memcpy(snorms, source, sizeof(snorms));
+
+            //-32768 and -32767 both map to -1 in D3D
+            const float encoded[2] = { std::max(snorms[0] / 32767.0f, -1.0f), std::max(snorms[1] / 32767.0f, -1.0f) };
+            DecodeOctahedral(encoded, destination);
+        }
+        else
+            memcpy(destination, source, sizeof(float) * 3);
+    }
+}
+
+void UnpackTexCoords(const uint8_t* const& vertices, const size_t& verticesAmount, const uint32_t& stride, const CachedVertexElement& element, float* const& texCoords)
+{
+    for (size_t v = 0; v < verticesAmount; ++v)
+    {
+        const uint8_t* source = vertices + v * stride + element.Offset;
+        float* destination = texCoords + v * 2;
+
+        if (element.Format == VertexFormat::Half2)
+        {
+            uint16_t halves[2];
+            memcpy(halves, source, sizeof(halves));
+
+            destination[0] = HalfToFloat(halves[0]);
+            destination[1] = HalfToFloat(halves[1]);
+        }
+        else
+            memcpy(destination, source, sizeof(float) * 2);
+    }
+}
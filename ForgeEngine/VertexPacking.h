@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ModelCache.h"
+
+//Index buffers of meshes with at most this many vertices are 16 bit
+#define MAX_SHORT_INDEXED_VERTICES 65536
+
+//Formats imported meshes are stored and uploaded in, part of the model cache key
+struct VertexPacking
+{
+    //Unorm16 inside the mesh bounds. Off by default - meshes with different bounds round shared edges differently and can crack
+    bool QuantizePositions = false;
+    //Snorm16 octahedral encoding instead of float3
+    bool OctahedralNormals = true;
+    bool HalfTexCoords = true;
+    bool Unorm8Colors = true;
+
+    uint32_t GetFlags() const;
+};
+
+uint16_t FloatToHalf(const float& value);
+float HalfToFloat(const uint16_t& value);
+
+//normal has to be normalized, the result is in [-1, 1]
+void EncodeOctahedral(const float* const& normal, float* const& encoded);
+void DecodeOctahedral(const float* const& encoded, float* const& normal);
+
+//Converts float vertices, read every stride floats with the given layout, into the formats packing selects.
+//Quantized positions get scale and offset, the rest identity. Returns the packed stride in bytes.
+//Common layouts are packed by converters generated from VertexLayouts, the rest element by element
+uint32_t PackVertices(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const std::vector<CachedVertexElement>& layout,
+    const VertexPacking& packing, std::vector<uint8_t>& packed, std::vector<CachedVertexElement>& packedLayout, float* const& positionScale, float* const& positionOffset);
+
+//Picks the format of every element and vertex at run time, produces the same data as PackVertices
+uint32_t PackVerticesGeneric(const float* const& vertices, const size_t& verticesAmount, const size_t& stride, const std::vector<CachedVertexElement>& layout,
+    const VertexPacking& packing, std::vector<uint8_t>& packed, std::vector<CachedVertexElement>& packedLayout, float* const& positionScale, float* const& positionOffset);
+
+bool HasCompiledVertexLayout(const std::vector<CachedVertexElement>& layout, const size_t& stride, const VertexPacking& packing);
+
+//Model space float3 positions of packed vertices, for CPU side processing
+void UnpackPositions(const uint8_t* const& vertices, const size_t& verticesAmount, const uint32_t& stride, const CachedVertexElement& element,
+    const float* const& positionScale, const float* const& positionOffset, float* const& positions);
+
+//Model space float3 normals of packed vertices, octahedral ones are decoded
+void UnpackNormals(const uint8_t* const& vertices, const size_t& verticesAmount, const uint32_t& stride, const CachedVertexElement& element, float* const& normals);
+
+//float2 texture coordinates of packed vertices
+void UnpackTexCoords(const uint8_t* const& vertices, const size_t& verticesAmount, const uint32_t& stride, const CachedVertexElement& element, float* const& texCoords);
@@ -30,12 +30,34 @@ bool TryToGetParams(LPSTR cmds, int outParams[4])
     return counter >= 4;
 }
 
+bool TryToExtractFlag(std::string& cmds, const std::string& flag)
+{
+    size_t i = cmds.find(flag);
+
+    if (i == std::string::npos)
+        return false;
+
+    cmds.erase(i, flag.size());
+
+    while (!cmds.empty() && cmds.back() == ' ')
+        cmds.pop_back();
+
+    while (!cmds.empty() && cmds.front() == ' ')
+        cmds.erase(0, 1);
+
+    return true;
+}
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd)
 {
     Core* core = new Core();
     const char* tmp = __FUNCSIG__;
+
+    std::string cmds = lpCmdLine;
+    const bool headless = TryToExtractFlag(cmds, "--headless");
+
     int params[4];
-    if (!TryToGetParams(lpCmdLine, params))
+    if (!TryToGetParams(&cmds[0], params))
     {
         params[0] = 1920;
         params[1] = 1080;
@@ -43,7 +65,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         params[3] = 1080;
     }
 
-    core->Run(hInstance, nShowCmd, params[0], params[1], params[2], params[3], "Results");
+    core->Run(hInstance, headless ? SW_HIDE : nShowCmd, params[0], params[1], params[2], params[3], "Results", headless);
     delete core;
 
     return 0;
@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../ForgeEngine/DrawList.h"
+#include "../ForgeEngine/FrustumCulling.h"
+#include "../ForgeEngine/JobSystem.h"
+#include "../ForgeEngine/ObjectConstants.h"
+#include "../ForgeEngine/OcclusionCulling.h"
+#include "../ForgeEngine/RecordingRenderStateSink.h"
+#include "../ForgeEngine/SoftwareRasterizer.h"
+#include "../ForgeEngine/VertexPacking.h"
+
+#define SPHERE_RINGS 32
+#define SPHERE_SEGMENTS 64
+#define CHECKER_SIZE 64
+//Visible cubes are drawn with this many materials and meshes, every second material uses the other shader
+#define DRAW_LIST_MATERIALS 16
+#define DRAW_LIST_MESHES 64
+
+static ObjectMatrix GetIdentity()
+{
+    ObjectMatrix result;
+    memset(&result, 0, sizeof(result));
+
+    for (int i = 0; i < 4; ++i)
+        result.M[i][i] = 1.0f;
+
+    return result;
+}
+
+//Left handed perspective looking along +Z, the same as XMMatrixPerspectiveFovLH
+static ObjectMatrix GetViewProjection()
+{
+    const float nearZ = 0.1f;
+    const float farZ = 1000.0f;
+    const float scale = 1.0f / tanf(0.5f * 1.0472f);
+
+    ObjectMatrix result;
+    memset(&result, 0, sizeof(result));
+    result.M[0][0] = scale / (16.0f / 9.0f);
+    result.M[1][1] = scale;
+    result.M[2][2] = farZ / (farZ - nearZ);
+    result.M[2][3] = 1.0f;
+    result.M[3][2] = -nearZ * farZ / (farZ - nearZ);
+
+    return result;
+}
+
+//Float position, normal and texcoord as imported, packed before drawing like RenderingSystem uploads it
+static void CreateSphere(std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+    const float pi = 3.14159265f;
+
+    for (int ring = 0; ring <= SPHERE_RINGS; ++ring)
+    {
+        const float theta = pi * ring / SPHERE_RINGS;
+
+        for (int segment = 0; segment <= SPHERE_SEGMENTS; ++segment)
+        {
+            const float phi = 2.0f * pi * segment / SPHERE_SEGMENTS;
+            const float normal[3] = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+
+            vertices.insert(vertices.end(), { normal[0], normal[1], normal[2], normal[0], normal[1], normal[2] });
+            vertices.push_back((float)segment / SPHERE_SEGMENTS);
+            vertices.push_back((float)ring / SPHERE_RINGS);
+        }
+    }
+
+    for (int ring = 0; ring < SPHERE_RINGS; ++ring)
+    {
+        for (int segment = 0; segment < SPHERE_SEGMENTS; ++segment)
+        {
+            const uint32_t first = ring * (SPHERE_SEGMENTS + 1) + segment;
+            const uint32_t second = first + SPHERE_SEGMENTS + 1;
+
+            indices.insert(indices.end(), { first, second, first + 1, second, second + 1, first + 1 });
+        }
+    }
+}
+
+static std::vector<uint8_t> CreateChecker()
+{
+    std::vector<uint8_t> texels(CHECKER_SIZE * CHECKER_SIZE * 4);
+
+    for (int y = 0; y < CHECKER_SIZE; ++y)
+    {
+        for (int x = 0; x < CHECKER_SIZE; ++x)
+        {
+            const uint8_t value = ((x / 8 + y / 8) % 2) == 0 ? 255 : 64;
+            uint8_t* texel = &texels[(y * CHECKER_SIZE + x) * 4];
+
+            texel[0] = value;
+            texel[1] = value;
+            texel[2] = value;
+            texel[3] = 255;
+        }
+    }
+
+    return texels;
+}
+
+static bool WritePPM(const char* path, const std::vector<uint32_t>& pixels, const int& width, const int& height)
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+        return false;
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    for (const uint32_t& pixel : pixels)
+    {
+        const char rgb[3] = { (char)(pixel & 0xFF), (char)((pixel >> 8) & 0xFF), (char)((pixel >> 16) & 0xFF) };
+        file.write(rgb, 3);
+    }
+
+    return true;
+}
+
+//Device objects are never dereferenced by the recording sink, so small integers stand in for them
+static RenderResourceHandle GetHandle(const uintptr_t& id)
+{
+    return (RenderResourceHandle)id;
+}
+
+//The draw RenderingSystem would add for the object, with shader, texture and material buffer of its material and buffers of its mesh
+static DrawCommand GetDrawCommand(const uint32_t& objectIndex)
+{
+    const uint32_t material = objectIndex % DRAW_LIST_MATERIALS;
+    const uint32_t mesh = objectIndex % DRAW_LIST_MESHES;
+    const uint32_t shader = material % 2;
+
+    DrawCommand command;
+    command.VertexShader = GetHandle(1 + shader);
+    command.PixelShader = GetHandle(1 + shader);
+    command.InputLayout = GetHandle(1 + shader);
+    command.Texture = GetHandle(100 + material / 2);
+    command.MaterialBuffer = GetHandle(200 + material);
+    command.VertexBuffer = GetHandle(1000 + mesh);
+    command.Stride = 20;
+    command.IndexBuffer = GetHandle(2000 + mesh);
+    command.IndexSize = 2;
+    command.IndicesAmount = 36;
+    command.ObjectIndex = objectIndex;
+
+    return command;
+}
+
+template<typename Function>
+static double MeasureNanoseconds(const int& iterations, Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i)
+        function();
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    int objectsAmount = 100000;
+    int iterations = 100;
+    int width = 1280;
+    int height = 720;
+    int samplesAmount = 4;
+    int frames = 10;
+    SoftwareShading shading = SoftwareShading::PerPixel;
+    const char* imagePath = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--objects") == 0)
+            objectsAmount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--iterations") == 0)
+            iterations = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--resolution") == 0)
+        {
+            const char* separator = strchr(argv[i + 1], 'x');
+            width = atoi(argv[i + 1]);
+            height = separator != nullptr ? atoi(separator + 1) : 0;
+        }
+        else if (strcmp(argv[i], "--samples") == 0)
+            samplesAmount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--shading") == 0)
+            shading = strcmp(argv[i + 1], "sample") == 0 ? SoftwareShading::PerSample : SoftwareShading::PerPixel;
+        else if (strcmp(argv[i], "--frames") == 0)
+            frames = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--image") == 0)
+            imagePath = argv[i + 1];
+    }
+
+    const int gridSize = (int)sqrtf((float)samplesAmount);
+
+    if (objectsAmount <= 0 || iterations <= 0 || width <= 0 || height <= 0 || frames <= 0 || gridSize * gridSize != samplesAmount || samplesAmount > SOFTWARE_MAX_SAMPLES)
+    {
+        fprintf(stderr, "Usage: KernelBenchmarks [--objects N] [--iterations N] [--resolution WxH] [--samples 1|4|16|64] [--shading pixel|sample] [--frames N] [--image file.ppm]\n");
+        return 2;
+    }
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+
+    const float cube[] = { -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+    const Bounds bounds = CalculateBounds(cube, 2, 3);
+    const ObjectMatrix viewProjection = GetViewProjection();
+
+    std::vector<ObjectMatrix> worlds(objectsAmount, GetIdentity());
+    std::vector<ObjectMatrix> prevWVPs(objectsAmount, GetIdentity());
+    std::vector<ObjectConstants> constants(objectsAmount);
+
+    for (ObjectMatrix& world : worlds)
+    {
+        world.M[3][0] = position(random);
+        world.M[3][1] = position(random);
+        world.M[3][2] = position(random);
+    }
+
+    FrustumCuller culler;
+    culler.SetFrustum(viewProjection);
+
+    const double addTime = MeasureNanoseconds(iterations, [&]()
+    {
+        culler.Clear();
+
+        for (const ObjectMatrix& world : worlds)
+            culler.Add(bounds, world);
+    });
+
+    const double cullTime = MeasureNanoseconds(iterations, [&]() { culler.Cull(); });
+
+    const double constantsTime = MeasureNanoseconds(iterations, [&]()
+    {
+        CalculateObjectConstants(worlds.data(), prevWVPs.data(), worlds.size(), viewProjection, constants.data());
+    });
+
+    const double samples = (double)objectsAmount * iterations;
+
+    printf("Objects: %d, iterations: %d, visible: %u\n", objectsAmount, iterations, culler.GetVisibleAmount());
+    printf("Bounds transform: %.2f ns/object\n", addTime / samples);
+    printf("Frustum culling: %.2f ns/object\n", cullTime / samples);
+    printf("Object constants: %.2f ns/object\n", constantsTime / samples);
+
+    //The frame's draw list of the visible cubes goes through the same sorting, batching and filtering as on the device
+    DrawList drawList;
+    RecordingRenderStateSink sink;
+
+    for (const uint32_t& maxInstances : { (uint32_t)OBJECT_CONSTANTS_MAX_INSTANCES, 1u })
+    {
+        const double drawListTime = MeasureNanoseconds(iterations, [&]()
+        {
+            drawList.Clear();
+            sink.Clear();
+
+            for (uint32_t i = 0; i < (uint32_t)objectsAmount; ++i)
+            {
+                if (culler.IsVisible(i))
+                    drawList.Add(GetDrawCommand(i));
+            }
+
+            drawList.Sort();
+            drawList.BuildBatches(maxInstances);
+            drawList.Submit(&sink);
+        });
+
+        const DrawListCounters& counters = drawList.GetCounters();
+
+        printf("Draw list, %u instances per draw: %zu commands, %u draws, %u instanced, %u state changes, %u skipped, %zu recorded calls, %.2f ns/command\n",
+            maxInstances, drawList.GetSize(), counters.Draws, counters.InstancedDraws, counters.StateChanges, counters.SkippedStateChanges,
+            sink.GetCommands().size(), drawListTime / ((double)std::max(drawList.GetSize(), (size_t)1) * iterations));
+    }
+
+    //Spheres in a few layers in front of the camera
+    std::vector<float> sphereVertices;
+    std::vector<uint32_t> sphereIndices;
+    CreateSphere(sphereVertices, sphereIndices);
+
+    const std::vector<uint8_t> checker = CreateChecker();
+    const SoftwareTexture texture = { checker.data(), CHECKER_SIZE, CHECKER_SIZE };
+
+    const std::vector<CachedVertexElement> sphereLayout = {
+        { VertexSemantic::Position, 0, 0, VertexFormat::Float3 },
+        { VertexSemantic::Normal, 0, 3 * sizeof(float), VertexFormat::Float3 },
+        { VertexSemantic::TexCoord, 0, 6 * sizeof(float), VertexFormat::Float2 } };
+
+    std::vector<uint8_t> packedSphere;
+    std::vector<CachedVertexElement> packedSphereLayout;
+
+    SoftwareMesh sphere;
+    sphere.VerticesAmount = sphereVertices.size() / 8;
+    sphere.Stride = PackVertices(sphereVertices.data(), sphere.VerticesAmount, 8, sphereLayout, VertexPacking(), packedSphere, packedSphereLayout,
+        sphere.PositionScale, sphere.PositionOffset);
+    sphere.Vertices = packedSphere.data();
+    sphere.Layout = packedSphereLayout.data();
+    sphere.LayoutAmount = packedSphereLayout.size();
+    sphere.Indices = sphereIndices.data();
+    sphere.IndicesAmount = sphereIndices.size();
+    sphere.Texture = &texture;
+    sphere.Diffuse[0] = sphere.Diffuse[1] = sphere.Diffuse[2] = 1.0f;
+    sphere.Specular[0] = sphere.Specular[1] = sphere.Specular[2] = 0.5f;
+
+    std::vector<ObjectMatrix> sphereWorlds;
+
+    for (int layer = 0; layer < 3; ++layer)
+    {
+        for (int y = -2; y <= 2; ++y)
+        {
+            for (int x = -4; x <= 4; ++x)
+            {
+                ObjectMatrix world = GetIdentity();
+                world.M[3][0] = x * 2.5f + layer * 1.25f;
+                world.M[3][1] = y * 2.5f + layer * 1.25f;
+                world.M[3][2] = 12.0f + layer * 4.0f;
+                sphereWorlds.push_back(world);
+            }
+        }
+    }
+
+    //Previous frame had every sphere a bit to the left, so velocity is not empty
+    std::vector<ObjectMatrix> sphereMovedWorlds = sphereWorlds;
+    for (ObjectMatrix& world : sphereMovedWorlds)
+        world.M[3][0] -= 0.1f;
+
+    std::vector<ObjectMatrix> spherePrevWVPs(sphereWorlds.size());
+    std::vector<ObjectConstants> sphereConstants(sphereWorlds.size());
+    CalculateObjectConstants(sphereMovedWorlds.data(), spherePrevWVPs.data(), sphereWorlds.size(), viewProjection, sphereConstants.data());
+    CalculateObjectConstants(sphereWorlds.data(), spherePrevWVPs.data(), sphereWorlds.size(), viewProjection, sphereConstants.data());
+
+    std::vector<SoftwareDrawCommand> commands;
+    for (const ObjectConstants& constants : sphereConstants)
+        commands.push_back({ &sphere, &constants });
+
+    SoftwareFrameConstants frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.Ambient[0] = frame.Ambient[1] = frame.Ambient[2] = 0.2f;
+    frame.DirectionalLightsAmount = 1;
+    frame.LightsDirections[0][0] = 0.5f;
+    frame.LightsDirections[0][1] = -1.0f;
+    frame.LightsDirections[0][2] = 1.0f;
+    frame.LightsColors[0][0] = frame.LightsColors[0][1] = frame.LightsColors[0][2] = 0.8f;
+
+    //Regular grid, 2x2 is the same as Get2x2Grid of AAHelpers
+    float offsets[SOFTWARE_MAX_SAMPLES][2];
+    for (int i = 0; i < samplesAmount; ++i)
+    {
+        offsets[i][0] = ((i % gridSize) + 0.5f) / gridSize - 0.5f;
+        offsets[i][1] = ((i / gridSize) + 0.5f) / gridSize - 0.5f;
+    }
+
+    printf("Software rasterizer: %dx%d, %d samples, %s shading, %d objects\n", width, height, samplesAmount, shading == SoftwareShading::PerPixel ? "per pixel" : "per sample", (int)commands.size());
+
+    const int hardwareThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+    std::vector<uint32_t> image;
+
+    for (int threads = 1; ; threads = std::min(threads * 2, hardwareThreads))
+    {
+        JobSystem jobSystem(threads);
+        SoftwareRasterizer rasterizer(&jobSystem);
+        rasterizer.SetTarget(width, height, offsets, samplesAmount, shading);
+
+        const double frameTime = MeasureNanoseconds(frames, [&]()
+        {
+            rasterizer.Clear(0xFF402010);
+            rasterizer.Draw(commands.data(), commands.size(), frame);
+            rasterizer.Resolve(image);
+        }) / frames;
+
+        const double pixelsPerSecond = (double)width * height / (frameTime * 1e-9);
+
+        printf("Threads: %d, triangles: %zu, frame: %.2f ms, %.2f Mpixels/s, %.2f Mpixels/s per thread\n",
+            threads, rasterizer.GetTrianglesAmount(), frameTime * 1e-6, pixelsPerSecond * 1e-6, pixelsPerSecond * 1e-6 / threads);
+
+        if (threads == hardwareThreads)
+            break;
+    }
+
+    //The first layer of spheres hides the cubes behind it
+    const size_t occludersAmount = sphereWorlds.size() / 3;
+    JobSystem occlusionJobSystem(hardwareThreads);
+    OcclusionCuller occlusionCuller(&occlusionJobSystem);
+    occlusionCuller.SetResolution(width / OCCLUSION_DOWNSCALE, height / OCCLUSION_DOWNSCALE);
+
+    const double rasterizeTime = MeasureNanoseconds(iterations, [&]()
+    {
+        occlusionCuller.Begin(viewProjection);
+
+        for (size_t i = 0; i < occludersAmount; ++i)
+            occlusionCuller.AddOccluder(sphereVertices.data(), sphereVertices.size() / 8, 8, sphereIndices.data(), sphereIndices.size(), sphereWorlds[i]);
+
+        occlusionCuller.Rasterize();
+    });
+
+    for (const ObjectMatrix& world : worlds)
+        occlusionCuller.Add(bounds, world);
+
+    const double testTime = MeasureNanoseconds(iterations, [&]() { occlusionCuller.Test(); });
+
+    printf("Occlusion culling: %dx%d, %d threads, %u occluders, %zu triangles\n", occlusionCuller.GetWidth(), occlusionCuller.GetHeight(), hardwareThreads,
+        occlusionCuller.GetOccludersAmount(), occlusionCuller.GetOccluderTrianglesAmount());
+    printf("Occluders rasterization: %.3f ms, bounds test: %.2f ns/object, occluded: %u\n", rasterizeTime * 1e-6 / iterations, testTime / samples, occlusionCuller.GetOccludedAmount());
+
+    if (imagePath != nullptr && !WritePPM(imagePath, image, width, height))
+    {
+        fprintf(stderr, "Can't write %s\n", imagePath);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,568 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include "../ForgeEngine/JobSystem.h"
+#include "../ForgeEngine/MeshLODs.h"
+#include "../ForgeEngine/MeshOptimizer.h"
+#include "../ForgeEngine/ModelCache.h"
+#include "../ForgeEngine/ModelImporter.h"
+#include "../ForgeEngine/ModelLoader.h"
+#include "../ForgeEngine/FakeTextureBackend.h"
+#include "../ForgeEngine/TextureCache.h"
+#include "../ForgeEngine/VertexPacking.h"
+
+//Renderers are moved away from the camera in this many steps, up to the last distance in bounding radiuses
+#define DISTANCE_STEPS 64
+#define MAX_DISTANCE 64.0f
+//Vertical field of view of the camera Core renders with
+#define FIELD_OF_VIEW (0.25f * 3.14f)
+//Renderers of one model MyApp instantiates
+#define SHARED_LOADS 16
+
+//Summarized for every model after all of them are benchmarked
+struct ModelResults
+{
+    const char* Path;
+    double SerialImportTime;
+    double ImportTime;
+    //Compiled layouts produced the same vertices as PackVerticesGeneric, the benchmark fails otherwise
+    bool PackingMatches;
+};
+
+struct BenchmarkMesh
+{
+    std::vector<float> Vertices;
+    std::vector<CachedVertexElement> Layout;
+    size_t Stride;
+    std::vector<uint32_t> Triangles;
+    std::vector<std::vector<uint32_t>> LODs;
+};
+
+//The layout RenderingSystem uploads - position, normal, texture coordinates and colors
+static void LoadMesh(const aiMesh* const& meshData, BenchmarkMesh& mesh)
+{
+    for (unsigned int x = 0; x < meshData->mNumVertices; ++x)
+    {
+        mesh.Vertices.insert(mesh.Vertices.end(), { meshData->mVertices[x].x, meshData->mVertices[x].y, meshData->mVertices[x].z });
+
+        if (meshData->HasNormals())
+            mesh.Vertices.insert(mesh.Vertices.end(), { meshData->mNormals[x].x, meshData->mNormals[x].y, meshData->mNormals[x].z });
+
+        for (unsigned int t = 0; meshData->HasTextureCoords(t); ++t)
+            mesh.Vertices.insert(mesh.Vertices.end(), { meshData->mTextureCoords[t][x].x, meshData->mTextureCoords[t][x].y });
+
+        for (unsigned int c = 0; meshData->HasVertexColors(c); ++c)
+            mesh.Vertices.insert(mesh.Vertices.end(), { meshData->mColors[c][x].r, meshData->mColors[c][x].g, meshData->mColors[c][x].b, meshData->mColors[c][x].a });
+    }
+
+    mesh.Stride = meshData->mNumVertices > 0 ? mesh.Vertices.size() / meshData->mNumVertices : 0;
+
+    uint32_t offset = 0;
+    mesh.Layout.push_back({ VertexSemantic::Position, 0, offset, VertexFormat::Float3 });
+    offset += 12;
+
+    if (meshData->HasNormals())
+    {
+        mesh.Layout.push_back({ VertexSemantic::Normal, 0, offset, VertexFormat::Float3 });
+        offset += 12;
+    }
+
+    for (unsigned int t = 0; meshData->HasTextureCoords(t); ++t, offset += 8)
+        mesh.Layout.push_back({ VertexSemantic::TexCoord, t, offset, VertexFormat::Float2 });
+
+    for (unsigned int c = 0; meshData->HasVertexColors(c); ++c, offset += 16)
+        mesh.Layout.push_back({ VertexSemantic::Color, c, offset, VertexFormat::Float4 });
+
+    for (unsigned int f = 0; f < meshData->mNumFaces; ++f)
+    {
+        if (meshData->mFaces[f].mNumIndices == 3)
+            mesh.Triangles.insert(mesh.Triangles.end(), meshData->mFaces[f].mIndices, meshData->mFaces[f].mIndices + 3);
+    }
+}
+
+static double GenerateAll(std::vector<BenchmarkMesh>& meshes, JobSystem* const& jobSystem)
+{
+    auto generate = [&meshes](const int& meshIndex)
+    {
+        BenchmarkMesh& mesh = meshes[meshIndex];
+        GenerateLODs(mesh.Vertices.data(), mesh.Stride > 0 ? mesh.Vertices.size() / mesh.Stride : 0, mesh.Stride, mesh.Triangles.data(), mesh.Triangles.size(), mesh.LODs);
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (jobSystem != nullptr)
+        jobSystem->Run((int)meshes.size(), generate);
+    else
+    {
+        for (int i = 0; i < (int)meshes.size(); ++i)
+            generate(i);
+    }
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Keeps the compiler from dropping reads of the cache
+static volatile double s_sink;
+
+//Everything the engine reads from a cache, summed so the pages are really touched
+static double ReadCache(const ModelCache& cache)
+{
+    double sum = 0.0;
+
+    for (uint32_t m = 0; m < cache.GetMeshesAmount(); ++m)
+    {
+        const ModelCacheMesh& mesh = cache.GetMesh(m);
+        const uint8_t* vertices = cache.Get<uint8_t>(mesh.Vertices);
+        const uint32_t* indices = cache.Get<uint32_t>(mesh.Indices);
+
+        for (uint64_t i = 0; i < mesh.Vertices.Amount; ++i)
+            sum += vertices[i];
+        for (uint64_t i = 0; i < mesh.Indices.Amount; ++i)
+            sum += indices[i];
+    }
+
+    return sum;
+}
+
+//The per vertex loop LoadMesh keeps, against packing its floats element by element and with the compiled layouts
+static void BenchmarkVertexLayouts(const aiScene* const& scene, const VertexPacking& packing, const std::vector<BenchmarkMesh>& meshes, const int& iterations,
+    ModelResults& results)
+{
+    double loopTime = DBL_MAX;
+    double genericTime = DBL_MAX;
+    double compiledTime = DBL_MAX;
+    size_t compiledAmount = 0;
+    size_t differentAmount = 0;
+
+    std::vector<uint8_t> packed;
+    std::vector<uint8_t> compiledPacked;
+    std::vector<CachedVertexElement> layout;
+    std::vector<CachedVertexElement> compiledLayout;
+    float scale[3];
+    float offset[3];
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
+        {
+            if (!scene->mMeshes[m]->HasPositions())
+                continue;
+
+            BenchmarkMesh mesh;
+            LoadMesh(scene->mMeshes[m], mesh);
+            s_sink = mesh.Vertices.empty() ? 0.0 : mesh.Vertices.back();
+        }
+        loopTime = std::min(loopTime, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        double generic = 0.0;
+        double compiled = 0.0;
+        compiledAmount = 0;
+        differentAmount = 0;
+
+        for (const BenchmarkMesh& mesh : meshes)
+        {
+            const size_t verticesAmount = mesh.Stride > 0 ? mesh.Vertices.size() / mesh.Stride : 0;
+
+            start = std::chrono::steady_clock::now();
+            const uint32_t stride = PackVerticesGeneric(mesh.Vertices.data(), verticesAmount, mesh.Stride, mesh.Layout, packing, packed, layout, scale, offset);
+            generic += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            const uint32_t compiledStride = PackVertices(mesh.Vertices.data(), verticesAmount, mesh.Stride, mesh.Layout, packing, compiledPacked, compiledLayout, scale, offset);
+            compiled += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            bool equal = stride == compiledStride && packed == compiledPacked && layout.size() == compiledLayout.size();
+
+            for (size_t e = 0; equal && e < layout.size(); ++e)
+            {
+                equal = layout[e].Semantic == compiledLayout[e].Semantic && layout[e].SemanticIndex == compiledLayout[e].SemanticIndex
+                    && layout[e].Offset == compiledLayout[e].Offset && layout[e].Format == compiledLayout[e].Format;
+            }
+
+            differentAmount += equal ? 0 : 1;
+            compiledAmount += HasCompiledVertexLayout(mesh.Layout, mesh.Stride, packing) ? 1 : 0;
+        }
+
+        genericTime = std::min(genericTime, generic);
+        compiledTime = std::min(compiledTime, compiled);
+    }
+
+    printf("Vertex conversion: per vertex loop %.2f ms, packing element by element %.2f ms, compiled layouts %.2f ms (%zu of %zu meshes)%s\n",
+        loopTime, genericTime, compiledTime, compiledAmount, meshes.size(), differentAmount == 0 ? "" : ", OUTPUTS DIFFER");
+
+    results.PackingMatches = differentAmount == 0;
+
+    if (!results.PackingMatches)
+        fprintf(stderr, "Compiled layouts and PackVerticesGeneric packed %zu of %zu meshes differently\n", differentAmount, meshes.size());
+}
+
+//Vertex cache efficiency and geometry memory of every mesh the import writes, and welding and reordering on their own
+static void BenchmarkVertexCache(const char* const& path, const VertexPacking& packing, JobSystem* const& jobSystem, const std::vector<BenchmarkMesh>& meshes, const int& iterations)
+{
+    ModelCacheBuilder builder;
+    std::vector<MeshImportStatistics> statistics;
+    if (!ImportModel(path, packing, jobSystem, builder, &statistics))
+        return;
+
+    size_t vertexBytes = 0;
+    size_t packedVertexBytes = 0;
+    size_t indexBytes = 0;
+    size_t packedIndexBytes = 0;
+
+    for (const MeshImportStatistics& mesh : statistics)
+    {
+        printf("Mesh %s: %u triangles, %u vertices welded to %u, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", mesh.Name.c_str(), mesh.TrianglesAmount,
+            mesh.VerticesAmount, mesh.WeldedVerticesAmount, mesh.Before.ACMR, mesh.After.ACMR, mesh.Before.ATVR, mesh.After.ATVR);
+
+        vertexBytes += mesh.VertexBytes;
+        packedVertexBytes += mesh.PackedVertexBytes;
+        indexBytes += mesh.IndexBytes;
+        packedIndexBytes += mesh.PackedIndexBytes;
+    }
+
+    printf("Geometry: vertices %.1f KB -> %.1f KB, indices %.1f KB -> %.1f KB, %.1f%% saved\n", vertexBytes / 1024.0, packedVertexBytes / 1024.0,
+        indexBytes / 1024.0, packedIndexBytes / 1024.0, 100.0 - 100.0 * (packedVertexBytes + packedIndexBytes) / std::max(vertexBytes + indexBytes, (size_t)1));
+
+    double optimizationTime = DBL_MAX;
+    size_t trianglesAmount = 0;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        double time = 0.0;
+        trianglesAmount = 0;
+
+        for (const BenchmarkMesh& mesh : meshes)
+        {
+            if (mesh.Stride == 0)
+                continue;
+
+            std::vector<float> vertices = mesh.Vertices;
+            std::vector<uint32_t> indices = mesh.Triangles;
+            std::vector<uint32_t> optimized(indices.size());
+
+            const auto start = std::chrono::steady_clock::now();
+            const size_t verticesAmount = WeldVertices(vertices, mesh.Stride, indices);
+            OptimizeVertexCache(indices.data(), indices.size(), verticesAmount, optimized.data());
+            OptimizeVertexFetch(vertices, mesh.Stride, optimized);
+            time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            trianglesAmount += indices.size() / 3;
+        }
+
+        optimizationTime = std::min(optimizationTime, time);
+    }
+
+    printf("Vertex cache optimization: %.2f ms (%.2f Mtriangles/s)\n", optimizationTime, trianglesAmount * 1e-3 / std::max(optimizationTime, 1e-6));
+}
+
+//Assimp import with all processing against mapping the cache it writes
+static void BenchmarkCache(const char* const& path, const VertexPacking& packing, JobSystem* const& jobSystem, const int& iterations, ModelResults& results)
+{
+    uint64_t key;
+    if (!GetModelCacheKey(path, GetModelImportFlags(), packing.GetFlags(), key))
+        return;
+
+    //Meshes are converted and simplified in jobs, so the import is timed on one thread as well
+    JobSystem serialJobSystem(1);
+    double serialImportTime = DBL_MAX;
+    double importTime = DBL_MAX;
+    double cacheTime = DBL_MAX;
+    std::vector<uint8_t> data;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (JobSystem* const& importJobSystem : { &serialJobSystem, jobSystem })
+        {
+            const auto start = std::chrono::steady_clock::now();
+            ModelCacheBuilder builder;
+            ImportModel(path, packing, importJobSystem, builder);
+            builder.Serialize(key, data);
+
+            const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            double& bestTime = importJobSystem == jobSystem ? importTime : serialImportTime;
+            bestTime = std::min(bestTime, time);
+        }
+    }
+
+    const std::string cachePath = std::string(path) + MODEL_CACHE_EXTENSION;
+    if (!WriteModelCache(cachePath, data))
+    {
+        fprintf(stderr, "Can't write %s\n", cachePath.c_str());
+        return;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        //Hashing the source is part of every load
+        const auto start = std::chrono::steady_clock::now();
+        ModelCache cache;
+        uint64_t loadKey;
+
+        if (!GetModelCacheKey(path, GetModelImportFlags(), packing.GetFlags(), loadKey) || !cache.Open(cachePath, loadKey))
+        {
+            fprintf(stderr, "Can't open %s\n", cachePath.c_str());
+            return;
+        }
+
+        sum += ReadCache(cache);
+        cacheTime = std::min(cacheTime, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    s_sink = sum;
+    results.SerialImportTime = serialImportTime;
+    results.ImportTime = importTime;
+
+    printf("Import: 1 thread %.2f ms, %d threads %.2f ms, %.2fx speedup\n", serialImportTime, jobSystem->GetThreadsAmount(), importTime, serialImportTime / importTime);
+    printf("Load: import %.2f ms, cache %.3f ms (%zu KB), %.1fx faster\n", importTime, cacheTime, data.size() / 1024, importTime / cacheTime);
+}
+
+//Time the calling thread spends starting background loads against waiting for them, renderers of the same model share one load
+static void BenchmarkLoader(const char* const& path, const VertexPacking& packing)
+{
+    ModelLoader loader(packing);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<ModelLoad> load = loader.Load(path);
+    int sharedAmount = 1;
+
+    for (int i = 1; i < SHARED_LOADS; ++i)
+        sharedAmount += loader.Load(path) == load ? 1 : 0;
+
+    const double requestTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    //Polled like the engine does once a frame
+    std::vector<std::shared_ptr<ModelLoad>> finished;
+    while (finished.empty())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        loader.TakeFinished(finished);
+    }
+
+    const double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Background load: %d requests took %.3f ms on the calling thread, %d of them shared, %s after %.2f ms\n",
+        SHARED_LOADS, requestTime, sharedAmount, finished[0]->Succeeded() ? "loaded" : "failed", loadTime);
+}
+
+//Texture slots of every mesh acquired like RenderingSystem does, with a fake decoder and device so it runs anywhere
+static void BenchmarkTextures(const char* const& path, const VertexPacking& packing, JobSystem* const& jobSystem)
+{
+    ModelCache cache;
+    if (!LoadModelCache(path, packing, jobSystem, cache))
+        return;
+
+    //Texture paths are relative to the working directory of the engine, the model's one is tried as well
+    const std::string modelPath = path;
+    const size_t separator = modelPath.find_last_of("/\\");
+    const std::string directory = separator != std::string::npos ? modelPath.substr(0, separator + 1) : "";
+
+    FakeTextureDecoder decoder;
+    FakeTextureDevice device;
+    TextureCache textureCache(&decoder, &device);
+    std::vector<TextureHandle> textures;
+    size_t missingAmount = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t m = 0; m < cache.GetMeshesAmount(); ++m)
+    {
+        const ModelCacheMesh& mesh = cache.GetMesh(m);
+        const ModelCacheRange* paths = cache.Get<ModelCacheRange>(mesh.Textures);
+
+        for (uint64_t t = 0; t < mesh.Textures.Amount; ++t)
+        {
+            const std::string texturePath = cache.GetString(paths[t]);
+            TextureHandle texture = textureCache.Acquire(texturePath);
+
+            if (texture == nullptr)
+                texture = textureCache.Acquire(directory + texturePath);
+
+            missingAmount += texture == nullptr ? 1 : 0;
+            textures.push_back(texture);
+        }
+    }
+
+    const double acquireTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const TextureCacheStatistics statistics = textureCache.GetStatistics();
+
+    for (const TextureHandle& texture : textures)
+        textureCache.Release(texture);
+
+    const size_t evictedAmount = textureCache.EvictUnused();
+    printf("Textures: %zu slots (%zu missing), %llu decoded, %llu shared by path and %llu by contents, %zu KB resident, acquired in %.2f ms\n",
+        textures.size(), missingAmount, (unsigned long long)statistics.Decodes, (unsigned long long)statistics.PathHits,
+        (unsigned long long)statistics.ContentHits, statistics.ResidentBytes / 1024, acquireTime);
+    printf("Texture release: %zu evicted, %zu left on the device\n\n", evictedAmount, device.GetLiveTexturesAmount());
+}
+
+static bool BenchmarkModel(const char* const& path, const VertexPacking& packing, JobSystem* const& jobSystem, const int& iterations, ModelResults& results)
+{
+    Assimp::Importer importer;
+    importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, false);
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_ConvertToLeftHanded | aiProcess_FixInfacingNormals | aiProcess_FindInvalidData);
+
+    if (scene == nullptr)
+    {
+        fprintf(stderr, "Can't load %s: %s\n", path, importer.GetErrorString());
+        return false;
+    }
+
+    std::vector<BenchmarkMesh> meshes;
+    size_t trianglesAmount = 0;
+
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i)
+    {
+        if (!scene->mMeshes[i]->HasPositions())
+            continue;
+
+        meshes.emplace_back();
+        LoadMesh(scene->mMeshes[i], meshes.back());
+        trianglesAmount += meshes.back().Triangles.size() / 3;
+    }
+
+    double singleThreadTime = DBL_MAX;
+    double multiThreadTime = DBL_MAX;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        singleThreadTime = std::min(singleThreadTime, GenerateAll(meshes, nullptr));
+        multiThreadTime = std::min(multiThreadTime, GenerateAll(meshes, jobSystem));
+    }
+
+    printf("%s: %zu meshes, %zu triangles\n", path, meshes.size(), trianglesAmount);
+
+    //Meshes with shorter chains stay at their last LOD
+    std::vector<size_t> lodsTriangles(MESH_LODS_AMOUNT + 1, 0);
+
+    for (const BenchmarkMesh& mesh : meshes)
+    {
+        for (int lod = 0; lod <= MESH_LODS_AMOUNT; ++lod)
+        {
+            const int available = std::min(lod, (int)mesh.LODs.size());
+            lodsTriangles[lod] += (available > 0 ? mesh.LODs[available - 1].size() : mesh.Triangles.size()) / 3;
+        }
+    }
+
+    for (int lod = 1; lod <= MESH_LODS_AMOUNT; ++lod)
+    {
+        printf("LOD %d: %zu triangles, %.1f%% of the full detail, %.1f%% saved\n", lod, lodsTriangles[lod],
+            100.0 * lodsTriangles[lod] / std::max(trianglesAmount, (size_t)1), 100.0 - 100.0 * lodsTriangles[lod] / std::max(trianglesAmount, (size_t)1));
+    }
+
+    printf("Simplification: 1 thread %.2f ms (%.2f Mtriangles/s), %d threads %.2f ms (%.2f Mtriangles/s)\n",
+        singleThreadTime, trianglesAmount * 1e-3 / singleThreadTime, jobSystem->GetThreadsAmount(), multiThreadTime, trianglesAmount * 1e-3 / multiThreadTime);
+
+    //A renderer moving away from the camera and back, with the size RenderingSystem gets from the bounding sphere
+    const float screenScale = 1.0f / tanf(0.5f * FIELD_OF_VIEW);
+    size_t drawnTriangles = 0;
+    int switches = 0;
+    int currentLOD = 0;
+
+    for (int step = 0; step < DISTANCE_STEPS * 2; ++step)
+    {
+        const int distanceStep = step < DISTANCE_STEPS ? step : DISTANCE_STEPS * 2 - 1 - step;
+        const float distance = 1.0f + (MAX_DISTANCE - 1.0f) * distanceStep / (DISTANCE_STEPS - 1);
+        const int lod = SelectLOD(std::min(screenScale / distance, 1.0f), currentLOD, MESH_LODS_AMOUNT);
+
+        switches += lod != currentLOD ? 1 : 0;
+        currentLOD = lod;
+        drawnTriangles += lodsTriangles[lod];
+    }
+
+    printf("Distance sweep: %d LOD switches, %.1f%% of triangles saved\n", switches,
+        100.0 - 100.0 * drawnTriangles / std::max(trianglesAmount * DISTANCE_STEPS * 2, (size_t)1));
+
+    BenchmarkVertexLayouts(scene, packing, meshes, iterations, results);
+    BenchmarkVertexCache(path, packing, jobSystem, meshes, iterations);
+    BenchmarkCache(path, packing, jobSystem, iterations, results);
+    BenchmarkLoader(path, packing);
+    BenchmarkTextures(path, packing, jobSystem);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 5;
+    std::vector<const char*> paths;
+    VertexPacking packing;
+    bool validPacking = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--packing") == 0 && i + 1 < argc)
+        {
+            //none keeps float vertices, all quantizes positions as well
+            const char* mode = argv[++i];
+            const bool all = strcmp(mode, "all") == 0;
+            validPacking = all || strcmp(mode, "none") == 0 || strcmp(mode, "default") == 0;
+
+            if (strcmp(mode, "default") != 0)
+            {
+                packing.QuantizePositions = all;
+                packing.OctahedralNormals = all;
+                packing.HalfTexCoords = all;
+                packing.Unorm8Colors = all;
+            }
+        }
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (iterations <= 0 || !validPacking)
+    {
+        fprintf(stderr, "Usage: MeshBenchmarks [--iterations N] [--packing none|default|all] [model files]\n");
+        return 2;
+    }
+
+    if (paths.empty())
+        paths = { "ForgeEngine/car.fbx", "ForgeEngine/model.fbx" };
+
+    JobSystem jobSystem;
+    std::vector<ModelResults> results;
+
+    for (const char* const& path : paths)
+    {
+        ModelResults modelResults = { path, 0.0, 0.0, true };
+
+        if (BenchmarkModel(path, packing, &jobSystem, iterations, modelResults))
+            results.push_back(modelResults);
+    }
+
+    if (results.empty())
+        return 1;
+
+    //Import speedups of all models together, the numbers to compare between machines
+    printf("\nImport on %d threads:\n", jobSystem.GetThreadsAmount());
+
+    for (const ModelResults& modelResults : results)
+    {
+        printf("  %s: 1 thread %.2f ms, %d threads %.2f ms, %.2fx speedup\n", modelResults.Path, modelResults.SerialImportTime, jobSystem.GetThreadsAmount(),
+            modelResults.ImportTime, modelResults.SerialImportTime / modelResults.ImportTime);
+    }
+
+    if (jobSystem.GetThreadsAmount() == 1)
+        fprintf(stderr, "Only one hardware thread, parallel import can't be faster here\n");
+
+    for (const ModelResults& modelResults : results)
+    {
+        if (!modelResults.PackingMatches)
+        {
+            fprintf(stderr, "%s: compiled vertex packing doesn't match PackVerticesGeneric\n", modelResults.Path);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "BenchmarkResults.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+bool BenchmarkResults::Load(const std::string& rootPath)
+{
+    m_rootPath = rootPath;
+    m_runs.clear();
+
+    std::error_code error;
+    if (!fs::is_directory(rootPath, error))
+    {
+        std::cerr << "Results directory doesn't exist: " << rootPath << "\n";
+        return false;
+    }
+
+    for (fs::recursive_directory_iterator it(rootPath, error), end; it != end; it.increment(error))
+    {
+        if (error)
+            break;
+
+        if (!it->is_regular_file() || it->path().extension() != ".csv")
+            continue;
+
+        fs::path relative = it->path().lexically_relative(rootPath);
+        relative.replace_extension();
+
+        BenchmarkRun run;
+        run.Key = relative.generic_string();
+
+        if (LoadRun(it->path().string(), run))
+            m_runs[run.Key] = run;
+        else
+            std::cerr << "Skipping unreadable results file: " << it->path().string() << "\n";
+    }
+
+    return !error;
+}
+
+bool BenchmarkResults::LoadRun(const std::string& path, BenchmarkRun& run)
+{
+    std::ifstream file(path);
+
+    if (!file.is_open())
+        return false;
+
+    std::vector<ScopeResult>* scopes = &run.CPUScopes;
+    bool inTable = false;
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line.empty())
+            continue;
+
+        if (line == "GPU PROFILING:")
+        {
+            scopes = &run.GPUScopes;
+            inTable = false;
+            continue;
+        }
+
+        const std::vector<std::string> fields = Split(line);
+
+        if (fields[0] == "Name")
+        {
+            inTable = true;
+            continue;
+        }
+
+        if (!inTable)
+        {
+            if (fields[0] == "FPS" && fields.size() > 1)
+                run.FPS = atof(fields[1].c_str());
+
+            continue;
+        }
+
+        //Name,Mean,StdDev,Min,Max,P50,P95,P99,Samples
+        if (fields.size() < 9)
+            continue;
+
+        ScopeResult scope;
+        scope.Name = fields[0];
+        scope.Mean = atof(fields[1].c_str());
+        scope.StdDev = atof(fields[2].c_str());
+        scope.Min = atof(fields[3].c_str());
+        scope.Max = atof(fields[4].c_str());
+        scope.P50 = atof(fields[5].c_str());
+        scope.P95 = atof(fields[6].c_str());
+        scope.P99 = atof(fields[7].c_str());
+        scope.Samples = strtoull(fields[8].c_str(), nullptr, 10);
+
+        scopes->push_back(scope);
+    }
+
+    return true;
+}
+
+std::vector<std::string> BenchmarkResults::Split(const std::string& line)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+
+    while (true)
+    {
+        const size_t comma = line.find(',', start);
+        fields.push_back(line.substr(start, comma - start));
+
+        if (comma == std::string::npos)
+            return fields;
+
+        start = comma + 1;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct ScopeResult
+{
+    std::string Name;
+    double Mean = 0.0;
+    double StdDev = 0.0;
+    double Min = 0.0;
+    double Max = 0.0;
+    double P50 = 0.0;
+    double P95 = 0.0;
+    double P99 = 0.0;
+    uint64_t Samples = 0;
+};
+
+//One Tester CSV, e.g. S0/MSAAx4 Standard Resolve.csv
+struct BenchmarkRun
+{
+    std::string Key;
+    double FPS = 0.0;
+    std::vector<ScopeResult> CPUScopes;
+    std::vector<ScopeResult> GPUScopes;
+};
+
+class BenchmarkResults
+{
+public:
+    bool Load(const std::string& rootPath);
+
+    inline const std::string& GetRootPath() const { return m_rootPath; }
+    inline const std::map<std::string, BenchmarkRun>& GetRuns() const { return m_runs; }
+
+private:
+    bool LoadRun(const std::string& path, BenchmarkRun& run);
+    static std::vector<std::string> Split(const std::string& line);
+
+    std::string m_rootPath;
+    std::map<std::string, BenchmarkRun> m_runs;
+};
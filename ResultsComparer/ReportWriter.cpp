@@ -0,0 +1,125 @@
+#include "ReportWriter.h"
+#include <cstdio>
+
+ReportWriter::ReportWriter(const std::string& basePath, const std::string& candidatePath, const ResultsComparison& comparison)
+    : m_comparison(comparison)
+{
+    m_basePath = basePath;
+    m_candidatePath = candidatePath;
+}
+
+void ReportWriter::WriteMarkdown(std::ostream& out) const
+{
+    out << "# Benchmark comparison\n\n";
+    out << "Base: `" << m_basePath << "`  \n";
+    out << "Candidate: `" << m_candidatePath << "`  \n";
+    out << "Confidence: " << FormatNumber(100.0 * m_comparison.GetConfidence(), 1) << "%, threshold: " << FormatNumber(m_comparison.GetThresholdPercent(), 1) << "%\n\n";
+
+    out << "**" << m_comparison.GetVerdictsAmount(ComparisonVerdict::Regression) << "** regressions, ";
+    out << "**" << m_comparison.GetVerdictsAmount(ComparisonVerdict::Improvement) << "** improvements, ";
+    out << m_comparison.GetVerdictsAmount(ComparisonVerdict::Unchanged) << " unchanged\n\n";
+
+    out << "| Run | Track | Scope | Base (ms) | Candidate (ms) | Delta (ms) | Delta | CI (ms) | Verdict |\n";
+    out << "|---|---|---|---:|---:|---:|---:|---|---|\n";
+
+    for (const ScopeComparison& c : m_comparison.GetComparisons())
+    {
+        out << "| " << c.Run << " | " << c.Track << " | " << c.Scope;
+        out << " | " << FormatNumber(c.BaseMean, 3) << " | " << FormatNumber(c.CandidateMean, 3);
+        out << " | " << FormatNumber(c.Delta, 3) << " | " << FormatNumber(c.DeltaPercent, 1) << "%";
+        out << " | [" << FormatNumber(c.Low, 3) << ", " << FormatNumber(c.High, 3) << "]";
+        out << " | " << GetVerdictName(c.Verdict) << " |\n";
+    }
+
+    for (const std::string& run : m_comparison.GetMissingInCandidate())
+        out << "\nMissing in candidate: " << run << "\n";
+
+    for (const std::string& run : m_comparison.GetMissingInBase())
+        out << "\nMissing in base: " << run << "\n";
+}
+
+void ReportWriter::WriteHTML(std::ostream& out) const
+{
+    out << "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>Benchmark comparison</title>\n";
+    out << "<style>body{font-family:sans-serif}table{border-collapse:collapse}td,th{border:1px solid #ccc;padding:2px 8px}td.n{text-align:right}";
+    out << "tr.Regression{background:#f8d0d0}tr.Improvement{background:#d0f0d0}</style>\n</head>\n<body>\n";
+
+    out << "<h1>Benchmark comparison</h1>\n";
+    out << "<p>Base: <code>" << EscapeHTML(m_basePath) << "</code><br>Candidate: <code>" << EscapeHTML(m_candidatePath) << "</code><br>";
+    out << "Confidence: " << FormatNumber(100.0 * m_comparison.GetConfidence(), 1) << "%, threshold: " << FormatNumber(m_comparison.GetThresholdPercent(), 1) << "%</p>\n";
+
+    out << "<p><b>" << m_comparison.GetVerdictsAmount(ComparisonVerdict::Regression) << "</b> regressions, ";
+    out << "<b>" << m_comparison.GetVerdictsAmount(ComparisonVerdict::Improvement) << "</b> improvements, ";
+    out << m_comparison.GetVerdictsAmount(ComparisonVerdict::Unchanged) << " unchanged</p>\n";
+
+    out << "<table>\n<tr><th>Run</th><th>Track</th><th>Scope</th><th>Base (ms)</th><th>Candidate (ms)</th><th>Delta (ms)</th><th>Delta</th><th>CI (ms)</th><th>Verdict</th></tr>\n";
+
+    for (const ScopeComparison& c : m_comparison.GetComparisons())
+    {
+        out << "<tr class=\"" << GetVerdictName(c.Verdict) << "\">";
+        out << "<td>" << EscapeHTML(c.Run) << "</td><td>" << c.Track << "</td><td>" << EscapeHTML(c.Scope) << "</td>";
+        out << "<td class=\"n\">" << FormatNumber(c.BaseMean, 3) << "</td><td class=\"n\">" << FormatNumber(c.CandidateMean, 3) << "</td>";
+        out << "<td class=\"n\">" << FormatNumber(c.Delta, 3) << "</td><td class=\"n\">" << FormatNumber(c.DeltaPercent, 1) << "%</td>";
+        out << "<td>[" << FormatNumber(c.Low, 3) << ", " << FormatNumber(c.High, 3) << "]</td>";
+        out << "<td>" << GetVerdictName(c.Verdict) << "</td></tr>\n";
+    }
+
+    out << "</table>\n";
+
+    for (const std::string& run : m_comparison.GetMissingInCandidate())
+        out << "<p>Missing in candidate: " << EscapeHTML(run) << "</p>\n";
+
+    for (const std::string& run : m_comparison.GetMissingInBase())
+        out << "<p>Missing in base: " << EscapeHTML(run) << "</p>\n";
+
+    out << "</body>\n</html>\n";
+}
+
+const char* ReportWriter::GetVerdictName(const ComparisonVerdict& verdict)
+{
+    switch (verdict)
+    {
+    case ComparisonVerdict::Improvement:
+        return "Improvement";
+    case ComparisonVerdict::Regression:
+        return "Regression";
+    default:
+        return "Unchanged";
+    }
+}
+
+std::string ReportWriter::FormatNumber(const double& value, const int& precision)
+{
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "%.*f", precision, value);
+    return tmp;
+}
+
+std::string ReportWriter::EscapeHTML(const std::string& str)
+{
+    std::string result;
+    result.reserve(str.size());
+
+    for (const char& c : str)
+    {
+        switch (c)
+        {
+        case '<':
+            result += "&lt;";
+            break;
+        case '>':
+            result += "&gt;";
+            break;
+        case '&':
+            result += "&amp;";
+            break;
+        case '"':
+            result += "&quot;";
+            break;
+        default:
+            result += c;
+        }
+    }
+
+    return result;
+}
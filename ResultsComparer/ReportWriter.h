@@ -0,0 +1,22 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include "ResultsComparison.h"
+
+class ReportWriter
+{
+public:
+    ReportWriter(const std::string& basePath, const std::string& candidatePath, const ResultsComparison& comparison);
+
+    void WriteMarkdown(std::ostream& out) const;
+    void WriteHTML(std::ostream& out) const;
+
+private:
+    static const char* GetVerdictName(const ComparisonVerdict& verdict);
+    static std::string FormatNumber(const double& value, const int& precision);
+    static std::string EscapeHTML(const std::string& str);
+
+    std::string m_basePath;
+    std::string m_candidatePath;
+    const ResultsComparison& m_comparison;
+};
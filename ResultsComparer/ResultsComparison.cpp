@@ -0,0 +1,129 @@
+#include "ResultsComparison.h"
+#include <cmath>
+#include <unordered_map>
+
+ResultsComparison::ResultsComparison(const double& confidence, const double& thresholdPercent)
+{
+    m_confidence = confidence;
+    m_thresholdPercent = thresholdPercent;
+}
+
+void ResultsComparison::Compare(const BenchmarkResults& base, const BenchmarkResults& candidate)
+{
+    m_comparisons.clear();
+    m_missingInBase.clear();
+    m_missingInCandidate.clear();
+
+    for (const auto& baseRun : base.GetRuns())
+    {
+        auto found = candidate.GetRuns().find(baseRun.first);
+
+        if (found == candidate.GetRuns().end())
+        {
+            m_missingInCandidate.push_back(baseRun.first);
+            continue;
+        }
+
+        CompareScopes(baseRun.first, "CPU", baseRun.second.CPUScopes, found->second.CPUScopes);
+        CompareScopes(baseRun.first, "GPU", baseRun.second.GPUScopes, found->second.GPUScopes);
+    }
+
+    for (const auto& candidateRun : candidate.GetRuns())
+    {
+        if (base.GetRuns().find(candidateRun.first) == base.GetRuns().end())
+            m_missingInBase.push_back(candidateRun.first);
+    }
+}
+
+int ResultsComparison::GetVerdictsAmount(const ComparisonVerdict& verdict) const
+{
+    int amount = 0;
+
+    for (const ScopeComparison& comparison : m_comparisons)
+    {
+        if (comparison.Verdict == verdict)
+            ++amount;
+    }
+
+    return amount;
+}
+
+void ResultsComparison::CompareScopes(const std::string& run, const std::string& track, const std::vector<ScopeResult>& base, const std::vector<ScopeResult>& candidate)
+{
+    std::unordered_map<std::string, const ScopeResult*> candidateScopes;
+
+    for (const ScopeResult& scope : candidate)
+        candidateScopes.emplace(scope.Name, &scope);
+
+    for (const ScopeResult& scope : base)
+    {
+        auto found = candidateScopes.find(scope.Name);
+
+        if (found == candidateScopes.end())
+            continue;
+
+        ScopeComparison comparison = CompareScope(scope, *found->second);
+        comparison.Run = run;
+        comparison.Track = track;
+        comparison.Scope = scope.Name;
+
+        m_comparisons.push_back(comparison);
+    }
+}
+
+ScopeComparison ResultsComparison::CompareScope(const ScopeResult& base, const ScopeResult& candidate) const
+{
+    ScopeComparison comparison;
+    comparison.BaseMean = base.Mean;
+    comparison.CandidateMean = candidate.Mean;
+    comparison.Delta = candidate.Mean - base.Mean;
+    comparison.DeltaPercent = base.Mean > 0.0 ? 100.0 * comparison.Delta / base.Mean : 0.0;
+    comparison.Low = comparison.Delta;
+    comparison.High = comparison.Delta;
+
+    if (base.Samples < 2 || candidate.Samples < 2)
+        return comparison;
+
+    const double baseVariance = base.StdDev * base.StdDev / (double)base.Samples;
+    const double candidateVariance = candidate.StdDev * candidate.StdDev / (double)candidate.Samples;
+    const double standardError = sqrt(baseVariance + candidateVariance);
+
+    if (standardError > 0.0)
+    {
+        //Welch-Satterthwaite
+        const double degreesOfFreedom = (baseVariance + candidateVariance) * (baseVariance + candidateVariance) /
+            (baseVariance * baseVariance / (double)(base.Samples - 1) + candidateVariance * candidateVariance / (double)(candidate.Samples - 1));
+
+        const double margin = GetStudentQuantile(0.5 + 0.5 * m_confidence, degreesOfFreedom) * standardError;
+        comparison.Low = comparison.Delta - margin;
+        comparison.High = comparison.Delta + margin;
+    }
+
+    if (comparison.Low > 0.0 && comparison.DeltaPercent > m_thresholdPercent)
+        comparison.Verdict = ComparisonVerdict::Regression;
+    else if (comparison.High < 0.0 && -comparison.DeltaPercent > m_thresholdPercent)
+        comparison.Verdict = ComparisonVerdict::Improvement;
+
+    return comparison;
+}
+
+double ResultsComparison::GetNormalQuantile(const double& p)
+{
+    //Abramowitz and Stegun 26.2.23, absolute error below 4.5e-4
+    const double q = p < 0.5 ? p : 1.0 - p;
+    const double t = sqrt(-2.0 * log(q));
+    const double z = t - (2.515517 + 0.802853 * t + 0.010328 * t * t) / (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+
+    return p < 0.5 ? -z : z;
+}
+
+double ResultsComparison::GetStudentQuantile(const double& p, const double& degreesOfFreedom)
+{
+    //Cornish-Fisher expansion around the normal quantile
+    const double z = GetNormalQuantile(p);
+    const double z3 = z * z * z;
+    const double z5 = z3 * z * z;
+    const double df = degreesOfFreedom;
+
+    return z + (z3 + z) / (4.0 * df) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "BenchmarkResults.h"
+
+enum class ComparisonVerdict
+{
+    Unchanged,
+    Improvement,
+    Regression
+};
+
+struct ScopeComparison
+{
+    std::string Run;
+    std::string Track;
+    std::string Scope;
+
+    double BaseMean = 0.0;
+    double CandidateMean = 0.0;
+    double Delta = 0.0;
+    double DeltaPercent = 0.0;
+
+    //Confidence interval of Delta
+    double Low = 0.0;
+    double High = 0.0;
+
+    ComparisonVerdict Verdict = ComparisonVerdict::Unchanged;
+};
+
+//Tester CSVs contain summary statistics only, so deltas are tested with Welch's t-test
+class ResultsComparison
+{
+public:
+    ResultsComparison(const double& confidence, const double& thresholdPercent);
+
+    void Compare(const BenchmarkResults& base, const BenchmarkResults& candidate);
+
+    inline const std::vector<ScopeComparison>& GetComparisons() const { return m_comparisons; }
+    inline const std::vector<std::string>& GetMissingInBase() const { return m_missingInBase; }
+    inline const std::vector<std::string>& GetMissingInCandidate() const { return m_missingInCandidate; }
+    inline double GetConfidence() const { return m_confidence; }
+    inline double GetThresholdPercent() const { return m_thresholdPercent; }
+
+    int GetVerdictsAmount(const ComparisonVerdict& verdict) const;
+
+private:
+    void CompareScopes(const std::string& run, const std::string& track, const std::vector<ScopeResult>& base, const std::vector<ScopeResult>& candidate);
+    ScopeComparison CompareScope(const ScopeResult& base, const ScopeResult& candidate) const;
+
+    static double GetNormalQuantile(const double& p);
+    static double GetStudentQuantile(const double& p, const double& degreesOfFreedom);
+
+    double m_confidence;
+    double m_thresholdPercent;
+
+    std::vector<ScopeComparison> m_comparisons;
+    std::vector<std::string> m_missingInBase;
+    std::vector<std::string> m_missingInCandidate;
+};
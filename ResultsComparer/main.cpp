@@ -0,0 +1,74 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "BenchmarkResults.h"
+#include "ResultsComparison.h"
+#include "ReportWriter.h"
+
+#define DEFAULT_CONFIDENCE 0.95
+#define DEFAULT_THRESHOLD_PERCENT 2.0
+
+//Exit codes: 0 - no regressions, 1 - regressions found, 2 - invalid usage or input
+int main(int argc, char** argv)
+{
+    std::string basePath;
+    std::string candidatePath;
+    std::string markdownPath;
+    std::string htmlPath;
+    double confidence = DEFAULT_CONFIDENCE;
+    double threshold = DEFAULT_THRESHOLD_PERCENT;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+
+        if (strcmp(argv[i], "--markdown") == 0 && hasValue)
+            markdownPath = argv[++i];
+        else if (strcmp(argv[i], "--html") == 0 && hasValue)
+            htmlPath = argv[++i];
+        else if (strcmp(argv[i], "--confidence") == 0 && hasValue)
+            confidence = atof(argv[++i]);
+        else if (strcmp(argv[i], "--threshold") == 0 && hasValue)
+            threshold = atof(argv[++i]);
+        else if (basePath.empty())
+            basePath = argv[i];
+        else if (candidatePath.empty())
+            candidatePath = argv[i];
+        else
+            basePath = "";
+    }
+
+    if (basePath.empty() || candidatePath.empty() || confidence <= 0.0 || confidence >= 1.0)
+    {
+        std::cerr << "Usage: ResultsComparer <base results dir> <candidate results dir> [--markdown file] [--html file] [--confidence 0.95] [--threshold 2.0]\n";
+        return 2;
+    }
+
+    BenchmarkResults base, candidate;
+
+    if (!base.Load(basePath) || !candidate.Load(candidatePath))
+        return 2;
+
+    ResultsComparison comparison(confidence, threshold);
+    comparison.Compare(base, candidate);
+
+    ReportWriter writer(basePath, candidatePath, comparison);
+
+    if (markdownPath.empty() && htmlPath.empty())
+        writer.WriteMarkdown(std::cout);
+
+    if (!markdownPath.empty())
+    {
+        std::ofstream file(markdownPath);
+        writer.WriteMarkdown(file);
+    }
+
+    if (!htmlPath.empty())
+    {
+        std::ofstream file(htmlPath);
+        writer.WriteHTML(file);
+    }
+
+    return comparison.GetVerdictsAmount(ComparisonVerdict::Regression) > 0 ? 1 : 0;
+}
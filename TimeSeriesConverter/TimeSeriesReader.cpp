@@ -0,0 +1,228 @@
+#include "TimeSeriesReader.h"
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+TimeSeriesReader::TimeSeriesReader() {}
+
+TimeSeriesReader::~TimeSeriesReader()
+{
+    Close();
+}
+
+bool TimeSeriesReader::Open(const std::string& path)
+{
+    Close();
+
+    if (!Map(path))
+        return false;
+
+    if (!Parse())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void TimeSeriesReader::Close()
+{
+    Unmap();
+
+    m_scopes.clear();
+    m_chunks.clear();
+    m_frameIndices[0].clear();
+    m_frameIndices[1].clear();
+}
+
+void TimeSeriesReader::ReadColumn(const uint32_t& scopeIndex, std::vector<float>& values) const
+{
+    const TimeSeriesTrack track = m_scopes[scopeIndex].Track;
+    values.assign(m_frameIndices[(int)track].size(), NAN);
+
+    for (const ChunkView& chunk : m_chunks)
+    {
+        if (chunk.Track != track)
+            continue;
+
+        for (uint32_t i = 0; i < chunk.ColumnsAmount; ++i)
+        {
+            if (chunk.ScopeIndices[i] != scopeIndex)
+                continue;
+
+            memcpy(&values[chunk.FirstFrame], chunk.Values + (size_t)i * chunk.FramesAmount, chunk.FramesAmount * sizeof(float));
+            break;
+        }
+    }
+}
+
+bool TimeSeriesReader::Map(const std::string& path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+
+    HANDLE mapping = size.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+
+    if (mapping == NULL)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    m_size = (size_t)size.QuadPart;
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+
+    if (file < 0)
+        return false;
+
+    struct stat info;
+
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        close(file);
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    m_data = (const uint8_t*)data;
+    m_size = (size_t)info.st_size;
+#endif
+
+    return m_data != nullptr;
+}
+
+void TimeSeriesReader::Unmap()
+{
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_mappingHandle)
+        CloseHandle(m_mappingHandle);
+
+    if (m_fileHandle)
+        CloseHandle(m_fileHandle);
+
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+#else
+    if (m_data)
+        munmap((void*)m_data, m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool TimeSeriesReader::Parse()
+{
+    TimeSeriesFileHeader header;
+
+    if (m_size < sizeof(header))
+        return false;
+
+    memcpy(&header, m_data, sizeof(header));
+
+    if (header.Magic != TIME_SERIES_MAGIC || header.Version != TIME_SERIES_VERSION || header.ScopeTableOffset > m_size)
+        return false;
+
+    size_t offset = sizeof(header);
+
+    for (uint32_t i = 0; i < header.ChunksAmount; ++i)
+    {
+        TimeSeriesChunkHeader chunkHeader;
+
+        if (offset + sizeof(chunkHeader) > header.ScopeTableOffset)
+            return false;
+
+        memcpy(&chunkHeader, m_data + offset, sizeof(chunkHeader));
+        offset += sizeof(chunkHeader);
+
+        const size_t framesSize = (size_t)chunkHeader.FramesAmount * sizeof(int32_t);
+        const size_t scopesSize = (size_t)chunkHeader.ColumnsAmount * sizeof(uint32_t);
+        const size_t valuesSize = (size_t)chunkHeader.ColumnsAmount * chunkHeader.FramesAmount * sizeof(float);
+
+        if (chunkHeader.Magic != TIME_SERIES_CHUNK_MAGIC || (uint32_t)chunkHeader.Track > (uint32_t)TimeSeriesTrack::GPU || offset + framesSize + scopesSize + valuesSize > header.ScopeTableOffset)
+            return false;
+
+        std::vector<int32_t>& frames = m_frameIndices[(int)chunkHeader.Track];
+
+        ChunkView chunk;
+        chunk.Track = chunkHeader.Track;
+        chunk.FramesAmount = chunkHeader.FramesAmount;
+        chunk.ColumnsAmount = chunkHeader.ColumnsAmount;
+        chunk.FirstFrame = frames.size();
+
+        //Every section is a multiple of 4 bytes, so columns stay aligned in the mapping
+        frames.insert(frames.end(), (const int32_t*)(m_data + offset), (const int32_t*)(m_data + offset) + chunkHeader.FramesAmount);
+        offset += framesSize;
+
+        chunk.ScopeIndices = (const uint32_t*)(m_data + offset);
+        offset += scopesSize;
+
+        chunk.Values = (const float*)(m_data + offset);
+        offset += valuesSize;
+
+        for (uint32_t j = 0; j < chunk.ColumnsAmount; ++j)
+        {
+            if (chunk.ScopeIndices[j] >= header.ScopesAmount)
+                return false;
+        }
+
+        m_chunks.push_back(chunk);
+    }
+
+    offset = (size_t)header.ScopeTableOffset;
+
+    for (uint32_t i = 0; i < header.ScopesAmount; ++i)
+    {
+        TimeSeriesScopeEntry entry;
+
+        if (offset + sizeof(entry) > m_size)
+            return false;
+
+        memcpy(&entry, m_data + offset, sizeof(entry));
+        offset += sizeof(entry);
+
+        if (offset + entry.PathLength > m_size)
+            return false;
+
+        m_scopes.push_back({ entry.PathID, entry.Track, std::string((const char*)m_data + offset, entry.PathLength) });
+        offset += entry.PathLength;
+    }
+
+    for (const ChunkView& chunk : m_chunks)
+    {
+        for (uint32_t j = 0; j < chunk.ColumnsAmount; ++j)
+        {
+            if (m_scopes[chunk.ScopeIndices[j]].Track != chunk.Track)
+                return false;
+        }
+    }
+
+    return true;
+}
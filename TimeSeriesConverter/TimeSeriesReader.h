@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../ForgeEngine/TimeSeriesFormat.h"
+
+struct TimeSeriesScope
+{
+    uint64_t PathID;
+    TimeSeriesTrack Track;
+    std::string Path;
+};
+
+//Memory maps a file written by TimeSeriesRecorder
+class TimeSeriesReader
+{
+public:
+    TimeSeriesReader();
+    ~TimeSeriesReader();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    inline const std::vector<TimeSeriesScope>& GetScopes() const { return m_scopes; }
+
+    //All frames of a track, in recording order
+    inline const std::vector<int32_t>& GetFrameIndices(const TimeSeriesTrack& track) const { return m_frameIndices[(int)track]; }
+
+    //One value per frame of the scope's track, NaN when the scope didn't run
+    void ReadColumn(const uint32_t& scopeIndex, std::vector<float>& values) const;
+
+private:
+    struct ChunkView
+    {
+        TimeSeriesTrack Track;
+        uint32_t FramesAmount;
+        uint32_t ColumnsAmount;
+        const uint32_t* ScopeIndices;
+        const float* Values;
+        size_t FirstFrame;
+    };
+
+    bool Map(const std::string& path);
+    void Unmap();
+    bool Parse();
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+
+    std::vector<TimeSeriesScope> m_scopes;
+    std::vector<ChunkView> m_chunks;
+    std::vector<int32_t> m_frameIndices[2];
+};
@@ -0,0 +1,140 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "TimeSeriesReader.h"
+
+static const char* GetTrackName(const TimeSeriesTrack& track)
+{
+    return track == TimeSeriesTrack::CPU ? "CPU" : "GPU";
+}
+
+static std::string EscapeJSON(const std::string& str)
+{
+    std::string result;
+
+    for (const char& c : str)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+
+        result += c;
+    }
+
+    return result;
+}
+
+//Long format, one row per recorded sample
+static void WriteCSV(const TimeSeriesReader& reader, std::ostream& out)
+{
+    std::vector<float> values;
+    char tmp[32];
+
+    out << "Track,Frame,Scope,Value\n";
+
+    for (uint32_t i = 0; i < (uint32_t)reader.GetScopes().size(); ++i)
+    {
+        const TimeSeriesScope& scope = reader.GetScopes()[i];
+        const std::vector<int32_t>& frames = reader.GetFrameIndices(scope.Track);
+
+        reader.ReadColumn(i, values);
+
+        for (size_t j = 0; j < values.size(); ++j)
+        {
+            if (std::isnan(values[j]))
+                continue;
+
+            snprintf(tmp, sizeof(tmp), "%.4f", values[j]);
+            out << GetTrackName(scope.Track) << "," << frames[j] << "," << scope.Path << "," << tmp << "\n";
+        }
+    }
+}
+
+//Columnar, missing samples are null
+static void WriteJSON(const TimeSeriesReader& reader, std::ostream& out)
+{
+    std::vector<float> values;
+    char tmp[32];
+
+    out << "{\n\"tracks\":{";
+
+    for (int track = 0; track < 2; ++track)
+    {
+        const std::vector<int32_t>& frames = reader.GetFrameIndices((TimeSeriesTrack)track);
+
+        out << (track == 0 ? "\n" : ",\n") << "\"" << GetTrackName((TimeSeriesTrack)track) << "\":[";
+
+        for (size_t j = 0; j < frames.size(); ++j)
+            out << (j == 0 ? "" : ",") << frames[j];
+
+        out << "]";
+    }
+
+    out << "\n},\n\"scopes\":[";
+
+    for (uint32_t i = 0; i < (uint32_t)reader.GetScopes().size(); ++i)
+    {
+        const TimeSeriesScope& scope = reader.GetScopes()[i];
+
+        reader.ReadColumn(i, values);
+
+        out << (i == 0 ? "\n" : ",\n") << "{\"path\":\"" << EscapeJSON(scope.Path) << "\",\"track\":\"" << GetTrackName(scope.Track) << "\",\"values\":[";
+
+        for (size_t j = 0; j < values.size(); ++j)
+        {
+            out << (j == 0 ? "" : ",");
+
+            if (std::isnan(values[j]))
+            {
+                out << "null";
+                continue;
+            }
+
+            snprintf(tmp, sizeof(tmp), "%.4f", values[j]);
+            out << tmp;
+        }
+
+        out << "]}";
+    }
+
+    out << "\n]\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || (argc != 2 && argc != 4) || (argc == 4 && strcmp(argv[2], "--csv") != 0 && strcmp(argv[2], "--json") != 0))
+    {
+        std::cerr << "Usage: TimeSeriesConverter <file.fts> [--csv file | --json file]\n";
+        return 2;
+    }
+
+    TimeSeriesReader reader;
+
+    if (!reader.Open(argv[1]))
+    {
+        std::cerr << "Couldn't read time series file: " << argv[1] << "\n";
+        return 1;
+    }
+
+    if (argc == 2)
+    {
+        WriteCSV(reader, std::cout);
+        return 0;
+    }
+
+    std::ofstream file(argv[3], std::ios::out | std::ios::binary);
+
+    if (!file.is_open())
+    {
+        std::cerr << "Couldn't open output file: " << argv[3] << "\n";
+        return 1;
+    }
+
+    if (strcmp(argv[2], "--csv") == 0)
+        WriteCSV(reader, file);
+    else
+        WriteJSON(reader, file);
+
+    return 0;
+}